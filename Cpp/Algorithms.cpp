@@ -0,0 +1,48 @@
+#include "header/Algorithms.h"
+#include "header/CSSCHH.h"
+#include "header/DUET.h"
+#include "header/DualSketch.h"
+#include "header/GlobalHH.h"
+#include "header/TwoDMisraGries.h"
+#include <algorithm>
+#include <cctype>
+
+
+namespace {
+
+template <typename Sketch>
+Algorithm make_algorithm() {
+    return {Sketch::name(), &run_sketch<Sketch>, &stream_sketch<Sketch>, &run_pipeline<Sketch>};
+}
+
+std::string normalize(const std::string& name) {
+    std::string key;
+    for (char c: name) {
+        if (std::isalnum(static_cast<unsigned char>(c))) key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+} // namespace
+
+
+const std::vector<Algorithm>& all_algorithms() {
+    static const std::vector<Algorithm> algorithms = {
+            make_algorithm<DualSketch>(),
+            make_algorithm<DUET>(),
+            make_algorithm<GlobalHH>(),
+            make_algorithm<TwoDMisraGries>(),
+            make_algorithm<CSSCHH>(),
+    };
+    return algorithms;
+}
+
+
+const Algorithm* find_algorithm(const std::string& name) {
+    std::string key = normalize(name);
+    if (key == "mg") key = "2dmg";
+    for (const auto& algorithm: all_algorithms()) {
+        if (normalize(algorithm.name) == key) return &algorithm;
+    }
+    return nullptr;
+}
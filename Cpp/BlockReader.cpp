@@ -0,0 +1,428 @@
+#include "header/BlockReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#define __NR_io_uring_enter 426
+#define __NR_io_uring_register 427
+#endif
+
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+} // namespace
+
+
+// The submission and completion rings of one io_uring instance
+struct BlockReader::Uring {
+    int fd = -1;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    size_t sq_ring_bytes = 0;
+    size_t cq_ring_bytes = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_bytes = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    bool fixed_buffers = false;
+    bool fixed_files = false;
+    unsigned unsubmitted = 0;
+
+    bool setup(unsigned entries) {
+        io_uring_params params{};
+        fd = io_uring_setup(entries, &params);
+        if (fd < 0) return false;
+
+        sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_ring_bytes = cq_ring_bytes = std::max(sq_ring_bytes, cq_ring_bytes);
+
+        sq_ring = mmap(nullptr, sq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) return false;
+        if (single_mmap) {
+            cq_ring = sq_ring;
+        } else {
+            cq_ring = mmap(nullptr, cq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED) return false;
+        }
+        sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_bytes, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) return false;
+
+        auto* sq = static_cast<char*>(sq_ring);
+        auto* cq = static_cast<char*>(cq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    ~Uring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_bytes);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_bytes);
+        if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_bytes);
+        if (fd >= 0) close(fd);
+    }
+
+    // A zeroed submission entry; it is passed to the kernel by the next enter()
+    io_uring_sqe* next_sqe() {
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        unsubmitted++;
+        return sqe;
+    }
+
+    int enter(unsigned min_complete) {
+        int ret = io_uring_enter(fd, unsubmitted, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (ret >= 0) unsubmitted -= std::min<unsigned>(unsubmitted, static_cast<unsigned>(ret));
+        return ret;
+    }
+};
+
+
+BlockReader::BlockReader(BlockReaderConfig config) : config(config) {
+    this->config.queue_depth = std::max(1u, config.queue_depth);
+    this->config.buffers = std::max(this->config.queue_depth + 1, config.buffers);
+    slot_bytes = this->config.headroom + this->config.block_bytes;
+}
+
+
+BlockReader::~BlockReader() {
+    close_files();
+}
+
+
+void BlockReader::close_files() {
+    // the kernel may still write into the buffers until every read has completed
+    if (uring != nullptr) {
+        if (uring->unsubmitted > 0) uring->enter(0);
+        size_t outstanding = std::count_if(in_flight.begin(), in_flight.end(),
+                                           [](const Pending& p) { return !p.complete; });
+        while (outstanding > 0) {
+            if (uring->enter(1) < 0 && errno != EINTR) break;
+            unsigned head = *uring->cq_head;
+            unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+            outstanding -= std::min<size_t>(outstanding, tail - head);
+            __atomic_store_n(uring->cq_head, tail, __ATOMIC_RELEASE);
+        }
+    }
+    in_flight.clear();
+    delete uring;
+    uring = nullptr;
+    for (int fd: fds) {
+        if (fd >= 0) close(fd);
+    }
+    fds.clear();
+    sizes.clear();
+}
+
+
+void BlockReader::open(const std::vector<std::string>& file_paths) {
+    close_files();
+    in_flight.clear();
+    read_error = 0;
+    next_file = 0;
+    next_offset = 0;
+
+    for (const auto& path: file_paths) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (fd >= 0 && fstat(fd, &st) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        fds.push_back(fd);
+        sizes.push_back(fd >= 0 ? static_cast<uint64_t>(st.st_size) : 0);
+    }
+
+    // small inputs do not need the whole pool: one buffer per block plus one to spare
+    uint64_t blocks = 0;
+    for (uint64_t size: sizes) blocks += (size + config.block_bytes - 1) / config.block_bytes;
+    buffer_count = static_cast<uint32_t>(std::min<uint64_t>(config.buffers, std::max<uint64_t>(2, blocks + 1)));
+    if (memory.size() < static_cast<size_t>(buffer_count) * slot_bytes) {
+        memory = AlignedBuffer<char, 4096>(static_cast<size_t>(buffer_count) * slot_bytes);
+    }
+    free_buffers.clear();
+    for (uint32_t b = buffer_count; b > 0; --b) free_buffers.push_back(b - 1);
+
+    if (!config.use_io_uring) return;
+
+    uring = new Uring();
+    unsigned entries = 1;
+    while (entries < config.queue_depth) entries <<= 1;
+    if (!uring->setup(entries)) {
+        delete uring;
+        uring = nullptr;
+        return;
+    }
+
+    // registered buffers and files save the kernel a lookup and page pinning per read;
+    // both are optional (e.g. RLIMIT_MEMLOCK may be too small for the buffers)
+    std::vector<iovec> iovecs(buffer_count);
+    for (uint32_t b = 0; b < buffer_count; ++b) {
+        iovecs[b].iov_base = memory.data() + static_cast<size_t>(b) * slot_bytes;
+        iovecs[b].iov_len = slot_bytes;
+    }
+    uring->fixed_buffers = io_uring_register(uring->fd, IORING_REGISTER_BUFFERS, iovecs.data(), buffer_count) == 0;
+    if (!fds.empty()) {
+        uring->fixed_files = io_uring_register(uring->fd, IORING_REGISTER_FILES, fds.data(),
+                                               static_cast<unsigned>(fds.size())) == 0;
+    }
+}
+
+
+bool BlockReader::take_free_buffer(uint32_t& buffer, bool wait) {
+    std::unique_lock<std::mutex> lock(free_mutex);
+    if (wait) buffer_freed.wait(lock, [this]() { return !free_buffers.empty(); });
+    if (free_buffers.empty()) return false;
+    buffer = free_buffers.back();
+    free_buffers.pop_back();
+    return true;
+}
+
+
+void BlockReader::release(const Block& block) {
+    {
+        std::lock_guard<std::mutex> lock(free_mutex);
+        free_buffers.push_back(block.buffer);
+    }
+    buffer_freed.notify_one();
+}
+
+
+bool BlockReader::schedule_next(uint32_t& file, uint64_t& offset, size_t& length) {
+    while (next_file < fds.size() && fds[next_file] < 0) next_file++;
+    if (next_file >= fds.size()) return false;
+
+    file = next_file;
+    offset = next_offset;
+    length = static_cast<size_t>(std::min<uint64_t>(config.block_bytes, sizes[file] - offset));
+    next_offset += config.block_bytes;
+    if (next_offset >= sizes[file]) {
+        next_file++;
+        next_offset = 0;
+    }
+    return true;
+}
+
+
+void BlockReader::submit(Pending& read) {
+    io_uring_sqe* sqe = uring->next_sqe();
+    char* target = block_data(read.buffer) + read.done;
+    sqe->opcode = uring->fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    if (uring->fixed_files) {
+        sqe->fd = static_cast<int>(read.file);
+        sqe->flags = IOSQE_FIXED_FILE;
+    } else {
+        sqe->fd = fds[read.file];
+    }
+    sqe->addr = reinterpret_cast<uint64_t>(target);
+    sqe->len = static_cast<uint32_t>(read.length - read.done);
+    sqe->off = read.offset + read.done;
+    sqe->buf_index = static_cast<uint16_t>(read.buffer);
+    sqe->user_data = read.buffer;
+}
+
+
+void BlockReader::submit_reads() {
+    uint32_t buffer;
+    while (in_flight.size() < config.queue_depth && take_free_buffer(buffer, false)) {
+        Pending read{buffer, 0, 0, 0, 0, false, 0};
+        if (!schedule_next(read.file, read.offset, read.length)) {
+            std::lock_guard<std::mutex> lock(free_mutex);
+            free_buffers.push_back(buffer);
+            break;
+        }
+        read.complete = read.length == 0;
+        in_flight.push_back(read);
+        if (!read.complete) submit(in_flight.back());
+    }
+    if (uring->unsubmitted > 0) uring->enter(0);
+}
+
+
+// Reaps completions until the oldest read in flight is complete
+bool BlockReader::wait_front() {
+    while (!in_flight.front().complete) {
+        unsigned head = *uring->cq_head;
+        unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (uring->enter(1) < 0 && errno != EINTR) {
+                read_error = errno;
+                return false;
+            }
+            continue;
+        }
+
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = uring->cqes[head & *uring->cq_mask];
+            auto it = std::find_if(in_flight.begin(), in_flight.end(),
+                                   [&](const Pending& p) { return p.buffer == cqe.user_data && !p.complete; });
+            if (it == in_flight.end()) continue;
+
+            if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                submit(*it);
+            } else if (cqe.res < 0) {
+                it->error = -cqe.res;
+                it->complete = true;
+            } else {
+                it->done += static_cast<size_t>(cqe.res);
+                // a short read is continued, unless the file ended early
+                if (cqe.res == 0 || it->done == it->length) {
+                    it->length = it->done;
+                    it->complete = true;
+                } else {
+                    submit(*it);
+                }
+            }
+        }
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+        if (uring->unsubmitted > 0) uring->enter(0);
+    }
+    return true;
+}
+
+
+bool BlockReader::next(Block& block) {
+    if (read_error != 0) return false;
+
+    while (true) {
+        if (uring != nullptr) {
+            submit_reads();
+        } else if (in_flight.empty()) {
+            // pread: one blocking read at a time
+            uint32_t buffer;
+            take_free_buffer(buffer, true);
+            Pending read{buffer, 0, 0, 0, 0, true, 0};
+            if (!schedule_next(read.file, read.offset, read.length)) {
+                release(Block{nullptr, 0, 0, 0, false, buffer});
+                return false;
+            }
+            char* target = block_data(buffer);
+            while (read.done < read.length) {
+                ssize_t n = pread(fds[read.file], target + read.done, read.length - read.done,
+                                  static_cast<off_t>(read.offset + read.done));
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) read.error = errno;
+                if (n <= 0) break;
+                read.done += static_cast<size_t>(n);
+            }
+            read.length = read.done;
+            in_flight.push_back(read);
+        }
+        if (!in_flight.empty()) break;
+
+        // nothing in flight: either all blocks were read, or the consumer holds every buffer
+        while (next_file < fds.size() && fds[next_file] < 0) next_file++;
+        if (next_file >= fds.size()) return false;
+        uint32_t buffer;
+        take_free_buffer(buffer, true);
+        release(Block{nullptr, 0, 0, 0, false, buffer});
+    }
+
+    if (uring != nullptr && !wait_front()) return false;
+
+    const Pending read = in_flight.front();
+    in_flight.pop_front();
+    if (read.error != 0) {
+        read_error = read.error;
+        release(Block{nullptr, 0, 0, 0, false, read.buffer});
+        return false;
+    }
+
+    block.data = block_data(read.buffer);
+    block.size = read.length;
+    block.file = read.file;
+    block.offset = read.offset;
+    block.last = read.offset + config.block_bytes >= sizes[read.file];
+    block.buffer = read.buffer;
+    return true;
+}
+
+
+bool LineSplitter::next(LinePiece& piece) {
+    Block block;
+    while (reader.next(block)) {
+        if (block.offset == 0) {
+            carry.clear();
+            skip_to_newline = skip_header;
+        }
+
+        // a line longer than the headroom is dropped, up to its newline in this or a later block
+        if (carry.size() > headroom) {
+            dropped++;
+            carry.clear();
+            skip_to_newline = true;
+        }
+        char* begin = block.data - carry.size();
+        std::memcpy(begin, carry.data(), carry.size());
+        uint64_t offset = block.offset - carry.size();
+        char* end = block.data + block.size;
+        carry.clear();
+
+        if (skip_to_newline) {
+            const char* nl = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (nl == nullptr) {
+                reader.release(block);
+                continue;
+            }
+            offset += static_cast<uint64_t>(nl + 1 - begin);
+            begin += nl + 1 - begin;
+            skip_to_newline = false;
+        }
+
+        if (!block.last) {
+            const char* nl = static_cast<const char*>(memrchr(begin, '\n', end - begin));
+            char* cut = (nl != nullptr) ? begin + (nl + 1 - begin) : begin;
+            carry.assign(cut, end);
+            end = cut;
+        }
+
+        if (begin == end) {
+            reader.release(block);
+            continue;
+        }
+        piece = LinePiece{begin, end, offset, block};
+        return true;
+    }
+    return false;
+}
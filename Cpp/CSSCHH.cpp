@@ -26,6 +26,8 @@ CSSCHH::CSSCHH(float memory_kb){
 
 void CSSCHH::update(uint32_t x, uint32_t y) {
 
+    N++;
+
     insert_ss1(x); // insert flow
 
     uint64_t combined_xy = combine_xy(x,y);
@@ -196,118 +198,16 @@ std::pair<std::map<uint32_t, uint32_t>,
 
 
 
+// includes both hash indexes and their nodes, which grow as the tables fill
+size_t CSSCHH::memory_bytes() const {
+    return memory.bytes();
+}
 
 
-
-void CSSCHH::evaluation(const std::vector<std::pair<uint32_t, uint32_t>> &dataset,
-                          const std::map<uint32_t, uint32_t> &flows,
-                          std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                          uint32_t heavy_hitter_th, float ele_th_phi) {
-
-    std::cout << "\n" << "CSSCHH: " << std::endl;
-
-    N = dataset.size();
-
-    // Process the entire dataset
-    auto start_update = std::chrono::high_resolution_clock::now();
-    for (const auto &[x, y]: dataset) {
-        update(x, y);
-    }
-    auto end_update = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> update_duration = end_update - start_update;
-    double update_throughput_Mdps = (dataset.size() / 1e6) / update_duration.count();
-    std::cout << " - Update Throughput: " << update_throughput_Mdps << " Mdps" << std::endl;
-
-
-    // Query the sketch for results
-    auto start_query = std::chrono::high_resolution_clock::now();
-    auto [queried_heavy_hitters, queried_quad_elements] = query(heavy_hitter_th, ele_th_phi);
-    auto end_query = std::chrono::high_resolution_clock::now();
-    auto query_duration = end_query - start_query;
-    std::cout << " - Query Time: " << std::chrono::duration<double, std::milli>(query_duration).count() << " ms" << std::endl;
-
-    // Find true heavy hitters and their hot quadratic elements
-    std::map<uint32_t, uint32_t> true_heavy_hitters;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_hot_quad_elements;
-
-    for (const auto &[flow_id, flow_size]: flows) {
-        if (flow_size >= heavy_hitter_th) {
-            true_heavy_hitters[flow_id] = flow_size;
-
-            // Find true hot quadratic elements for this heavy hitter
-            if (quadratic_eles.count(flow_id)) {
-                for (const auto &[ele_id, ele_size]: quadratic_eles.at(flow_id)) {
-                    if (ele_size >= ele_th_phi * flow_size)
-                        true_hot_quad_elements[flow_id][ele_id] = ele_size;
-                }
-            }
-        }
-    }
-
-    // --- Heavy Hitter Evaluation ---
-
-    float hh_are_sum = 0.0f;
-    uint32_t hh_true_positives = 0;
-    for (const auto &[id, true_size]: true_heavy_hitters) {
-        if (queried_heavy_hitters.count(id)) {
-            uint32_t queried_size = queried_heavy_hitters.at(id);
-            hh_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-            hh_true_positives++;
-        }
-    }
-
-    float hh_are = (hh_true_positives > 0) ? hh_are_sum / hh_true_positives : 0.0f;
-    float hh_precision = (queried_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                              queried_heavy_hitters.size() : 0.0f;
-    float hh_recall = (true_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                        true_heavy_hitters.size() : 0.0f;
-    float hh_f1 = (hh_precision + hh_recall > 0) ? 2 * (hh_precision * hh_recall) / (hh_precision + hh_recall) : 0.0f;
-
-    std::cout << " - Heavy Hitter Metrics | ";
-    std::cout << "ARE: " << hh_are << ", ";
-    std::cout << "F1: " << hh_f1 << "\n";
-
-
-    // --- Quadratic Element Evaluation ---
-
-    float ele_are_sum = 0.0f;
-    uint32_t ele_true_positives = 0;
-    uint32_t total_queried_hot_ele_count = 0; // queried hot quadratic element count
-    uint32_t total_true_hot_ele_count = 0; // true hot quadratic element count
-
-
-    for (const auto &[flow_id, queried_elements]: queried_quad_elements) {
-        total_queried_hot_ele_count += queried_elements.size();
-    }
-
-
-    // Calculate ARE and True Positives
-    for (const auto &[flow_id, true_hot_elements]: true_hot_quad_elements) {
-        if (queried_quad_elements.count(flow_id)) {
-            const auto &queried_elements = queried_quad_elements.at(flow_id);
-            for (const auto &[ele_id, true_size]: true_hot_elements) {
-                if (queried_elements.count(ele_id)) {
-                    uint32_t queried_size = queried_elements.at(ele_id);
-                    ele_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-                    ele_true_positives++;
-                }
-            }
-        }
-        total_true_hot_ele_count += true_hot_elements.size();
-    }
-
-
-
-    float ele_are = (ele_true_positives > 0) ? ele_are_sum / ele_true_positives : 0.0f;
-    float ele_precision = (total_queried_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
-                                                              total_queried_hot_ele_count : 0.0f;
-    float ele_recall = (total_true_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) / total_true_hot_ele_count
-                                                      : 0.0f;
-    float ele_f1 = (ele_precision + ele_recall > 0) ? 2 * (ele_precision * ele_recall) / (ele_precision + ele_recall)
-                                                    : 0.0f;
-
-    std::cout << " - Heavy Quadratic Ele Metrics | ";
-    std::cout << "ARE: " << ele_are << ", ";
-    std::cout << "F1: " << ele_f1 << "\n";
-
+void CSSCHH::reset() {
+    N = 0;
+    ss1_heavy_hitter.clear();
+    ss2_quad_ele.clear();
+    key_to_index_ss1.clear();
+    key_to_index_ss2.clear();
 }
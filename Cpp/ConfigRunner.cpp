@@ -0,0 +1,101 @@
+#include "header/ConfigRunner.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <thread>
+
+
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+    std::vector<int> parsed;
+    std::stringstream list(text);
+    for (std::string item; std::getline(list, item, ',');) {
+        if (item.empty()) continue;
+        try {
+            size_t dash = item.find('-');
+            size_t used = 0;
+            int first = std::stoi(item.substr(0, dash), &used);
+            if (used != (dash == std::string::npos ? item.size() : dash)) return false;
+            int last = first;
+            if (dash != std::string::npos) {
+                std::string tail = item.substr(dash + 1);
+                last = std::stoi(tail, &used);
+                if (used != tail.size()) return false;
+            }
+            if (first < 0 || last < first) return false;
+            for (int cpu = first; cpu <= last; ++cpu) parsed.push_back(cpu);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (parsed.empty()) return false;
+    cpus = std::move(parsed);
+    return true;
+}
+
+
+std::vector<int> available_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < n; ++cpu) cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+}
+
+
+bool pin_current_thread(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+
+ConfigRunner::ConfigRunner(const std::vector<Record>& dataset, unsigned workers, std::vector<int> cpus)
+        : dataset(dataset), pin(!cpus.empty() || workers != 1),
+          cpus(cpus.empty() ? available_cpus() : std::move(cpus)) {
+    // one worker per core, so that no two runs share one
+    this->workers = workers == 0 ? static_cast<unsigned>(this->cpus.size())
+                                 : std::min<unsigned>(workers, static_cast<unsigned>(this->cpus.size()));
+}
+
+
+std::vector<RunResult> ConfigRunner::run(const std::vector<RunJob>& jobs) const {
+    std::vector<RunResult> results(jobs.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&](int cpu) {
+        if (pin && !pin_current_thread(cpu)) {
+            std::cerr << "Could not pin a run to CPU " << cpu << "; it runs unpinned." << std::endl;
+        }
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            const RunJob& job = jobs[i];
+            results[i] = job.algorithm->run(job.memory_kb, dataset, job.config);
+        }
+    };
+
+    if (workers <= 1) {
+        // serial timing: restore the caller's affinity afterwards
+        cpu_set_t saved;
+        bool restore = pin && pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+        worker(cpus[0]);
+        if (restore) pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < workers; ++w) threads.emplace_back(worker, cpus[w]);
+    for (auto& thread: threads) thread.join();
+    return results;
+}
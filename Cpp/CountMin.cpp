@@ -2,7 +2,8 @@
 #include <algorithm>
 #include "header/CountMin.h"
 
-CountMin::CountMin(float memory_kb) {
+CountMin::CountMin(float memory_kb, MemoryTracker* memory)
+        : counters(TrackingAllocator<uint32_t>(memory)) {
 
     this->counter_bits = 32;
     this->depth = 4;
@@ -11,32 +12,46 @@ CountMin::CountMin(float memory_kb) {
 
     width = static_cast<int>(std::round(total_counters / depth));
 
-    counters = std::vector<std::vector<uint32_t>>(depth, std::vector<uint32_t>(width, 0));
+    counters.assign(static_cast<size_t>(depth) * width, 0u);
 }
 
 
 
 void CountMin::update(const uint32_t flow_label, uint32_t weight) {
-    uint32_t hash_value = 0;
-    for (int i = 0; i < depth; i++) {
-        MurmurHash3_x86_32(&flow_label, 4, i, &hash_value);
-        uint32_t j = hash_value % width;
-        counters[i][j] = std::clamp(counters[i][j] + weight, 0u, UINT32_MAX);
-    }
+    kernels->countmin_add(counters.data(), depth, width, flow_label, weight);
 }
 
 
 uint32_t CountMin::query(const uint32_t flow_label) {
+    return kernels->countmin_query(counters.data(), depth, width, flow_label);
+}
+
+
+uint32_t CountMin::query_update(const uint32_t flow_label, uint32_t weight) {
+    return kernels->countmin_add(counters.data(), depth, width, flow_label, weight);
+}
 
-    int min_value = 0x7FFFFFFF;
-    uint32_t hash_value = 0;
+
+void CountMin::query_update_batch(const uint32_t* keys, size_t n, uint32_t* estimates) {
+    constexpr size_t chunk = 64;
+    uint32_t hash_values[chunk];
+
+    std::fill(estimates, estimates + n, UINT32_MAX);
     for (int i = 0; i < depth; i++) {
-        MurmurHash3_x86_32(&flow_label, 4, i, &hash_value);
-        uint32_t j = hash_value % width;
-        int val = counters[i][j];
-        if (val < min_value) {
-            min_value = val;
+        uint32_t* row = counters.data() + static_cast<size_t>(i) * width;
+        for (size_t base = 0; base < n; base += chunk) {
+            size_t len = std::min(chunk, n - base);
+            kernels->hash_u32(keys + base, len, i, hash_values);
+            for (size_t j = 0; j < len; ++j) {
+                uint32_t& counter = row[hash_values[j] % width];
+                estimates[base + j] = std::min(estimates[base + j], counter);
+                counter++;
+            }
         }
     }
-    return min_value;
+}
+
+
+void CountMin::reset() {
+    std::fill(counters.begin(), counters.end(), 0);
 }
@@ -0,0 +1,181 @@
+#include "header/CsvProjection.h"
+#include "header/TextParse.h"
+
+
+namespace {
+
+// The parse functions expect a field without surrounding blanks.
+
+bool parse_ip_field(const char* p, const char* end, uint64_t& value) {
+    uint32_t ip = 0;
+    if (!parse_ipv4(p, end, ip)) return false;
+    value = ip;
+    return true;
+}
+
+// Values that do not fit in 64 bits are rejected rather than wrapped
+bool parse_uint_field(const char* p, const char* end, uint64_t& value) {
+    if (p == end) return false;
+    uint64_t v = 0;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        if (end - p - 2 > 16) return false;
+        for (p += 2; p < end; ++p) {
+            char c = static_cast<char>(*p | 0x20);
+            if (is_digit(*p)) v = (v << 4) | static_cast<uint64_t>(*p - '0');
+            else if (c >= 'a' && c <= 'f') v = (v << 4) | static_cast<uint64_t>(c - 'a' + 10);
+            else return false;
+        }
+    } else {
+        for (; p < end; ++p) {
+            if (!is_digit(*p)) return false;
+            uint64_t d = static_cast<uint64_t>(*p - '0');
+            if (v > (UINT64_MAX - d) / 10) return false;
+            v = v * 10 + d;
+        }
+    }
+    value = v;
+    return true;
+}
+
+// a protocol number or name; names other than tcp/udp/icmp/icmpv6 (e.g. "OTHER") map to 255
+bool parse_protocol_field(const char* p, const char* end, uint64_t& value) {
+    if (is_digit(*p)) return parse_uint_field(p, end, value);
+    size_t n = static_cast<size_t>(end - p);
+    char name[8] = {};
+    for (size_t i = 0; i < n && i + 1 < sizeof(name); ++i) name[i] = static_cast<char>(p[i] | 0x20);
+    if (n >= sizeof(name)) value = 255;
+    else if (std::strcmp(name, "tcp") == 0) value = 6;
+    else if (std::strcmp(name, "udp") == 0) value = 17;
+    else if (std::strcmp(name, "icmp") == 0) value = 1;
+    else if (std::strcmp(name, "icmpv6") == 0) value = 58;
+    else value = 255;
+    return true;
+}
+
+
+// seconds with an optional fraction of up to 9 digits, to nanoseconds
+bool parse_timestamp_field(const char* p, const char* end, uint64_t& value) {
+    const char* dot = static_cast<const char*>(std::memchr(p, '.', static_cast<size_t>(end - p)));
+    uint64_t seconds = 0;
+    if (!parse_uint_field(p, dot != nullptr ? dot : end, seconds)) return false;
+    uint64_t ns = 0;
+    if (dot != nullptr) {
+        const char* q = dot + 1;
+        int digits = 0;
+        for (; q < end; ++q) {
+            if (!is_digit(*q)) return false;
+            if (digits < 9) {
+                ns = ns * 10 + static_cast<uint64_t>(*q - '0');
+                ++digits;
+            }
+        }
+        for (; digits < 9; ++digits) ns *= 10;
+    }
+    value = seconds * 1000000000ULL + ns;
+    return true;
+}
+
+CsvProjection::FieldParser parser_for(Field field) {
+    switch (field) {
+        case Field::SrcIp:
+        case Field::DstIp:
+            return parse_ip_field;
+        case Field::Protocol:
+            return parse_protocol_field;
+        case Field::Timestamp:
+            return parse_timestamp_field;
+        default:
+            return parse_uint_field;
+    }
+}
+
+// [p, end) without leading/trailing blanks (including the '\r' of CRLF files)
+inline void trim_field(const char*& p, const char*& end) {
+    p = skip_blanks(p, end);
+    while (end > p && is_blank(end[-1])) --end;
+}
+
+} // namespace
+
+
+bool CsvProjection::compile(const char* begin, const char* end, std::vector<KeySpec> key_specs, std::string* error) {
+    specs = std::move(key_specs);
+    columns.clear();
+
+    uint32_t needed = 0;
+    spec_fields.clear();
+    for (const auto& spec: specs) {
+        spec_fields.push_back(spec.used_fields());
+        needed |= spec_fields.back();
+    }
+
+    uint32_t found = 0;
+    size_t last_needed = 0;
+    std::vector<Column> all;
+    const char* p = begin;
+    while (p <= end) {
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+        const char* name_end = comma != nullptr ? comma : end;
+        const char* name_begin = p;
+        trim_field(name_begin, name_end);
+
+        Column column{nullptr, Field::SrcIp};
+        Field field;
+        if (parse_field_name(std::string(name_begin, name_end), field)) {
+            uint32_t bit = 1u << static_cast<uint32_t>(field);
+            if ((needed & bit) && !(found & bit)) {
+                column = {parser_for(field), field};
+                found |= bit;
+                last_needed = all.size();
+            }
+        }
+        all.push_back(column);
+
+        if (comma == nullptr) break;
+        p = comma + 1;
+    }
+
+    uint32_t missing = needed & ~found;
+    if (missing != 0) {
+        if (error != nullptr) {
+            *error = "no column for field '" + std::string(field_name(static_cast<Field>(__builtin_ctz(missing)))) + "'";
+        }
+        return false;
+    }
+
+    all.resize(needed != 0 ? last_needed + 1 : 0);
+    columns = std::move(all);
+    return true;
+}
+
+
+bool CsvProjection::parse_line(const char* begin, const char* end, std::vector<Record>* outs) const {
+    FieldValues values{};
+    uint32_t missing = 0;  // needed fields that are empty on this line
+
+    const char* p = begin;
+    bool last_column = false;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (last_column) return false;  // fewer columns than needed
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+        const char* field_end = comma != nullptr ? comma : end;
+        last_column = (comma == nullptr);
+
+        if (columns[c].parse != nullptr) {
+            const char* field_begin = p;
+            trim_field(field_begin, field_end);
+            if (field_begin == field_end) {
+                missing |= 1u << static_cast<uint32_t>(columns[c].field);
+            } else if (!columns[c].parse(field_begin, field_end, values[columns[c].field])) {
+                return false;
+            }
+        }
+        if (comma != nullptr) p = comma + 1;
+    }
+
+    // e.g. ICMP packets have no ports: they are dropped only by the specs that read ports
+    for (size_t i = 0; i < specs.size(); ++i) {
+        if ((spec_fields[i] & missing) == 0) specs[i].project(values, outs[i]);
+    }
+    return true;
+}
@@ -3,7 +3,7 @@
 #include <algorithm>
 #include <chrono>
 
-#include "header/CountMin.h"
+#include "header/SketchKernels.h"
 
 
 DUET::DUET(float memory_kb) {
@@ -19,7 +19,7 @@ DUET::DUET(float memory_kb) {
 
     // CountMin
     float cm_bits = total_bits * cm_ratio;
-    count_min = new CountMin(cm_bits/1024/8);
+    count_min = CountMin(cm_bits/1024/8, &memory);
 
     // Filter
     size_t filter_bits = static_cast<size_t>(total_bits * filter_ratio);
@@ -27,24 +27,23 @@ DUET::DUET(float memory_kb) {
     d_filter = 4;
     w_filter = static_cast<int>(filter_bits / (d_filter * 96));
     if (w_filter < 1) w_filter = 1;
-    filter.resize(d_filter, std::vector<Bucket>(w_filter, {0, 0}));
+    filter_keys = AlignedBuffer<uint64_t>(static_cast<size_t>(d_filter) * w_filter, &memory);
+    filter_counts = AlignedBuffer<uint32_t>(static_cast<size_t>(d_filter) * w_filter, &memory);
 
     // STable
     size_t stable_bits = static_cast<size_t>(total_bits * stable_ratio);
     l_stable = 200;
     r_stable = static_cast<int>(stable_bits / (l_stable * 96));
     if (r_stable < 1) r_stable = 1;
-    stable.resize(l_stable, std::vector<Bucket>(r_stable, {0, 0}));
+    r_stride = (r_stable + 15) / 16 * 16; // 16 counts = 64 bytes
+    stable_keys = AlignedBuffer<uint64_t>(static_cast<size_t>(l_stable) * r_stride, &memory);
+    stable_counts = AlignedBuffer<uint32_t>(static_cast<size_t>(l_stable) * r_stride, &memory);
 
-    rand_seeds = generateSeeds32(d_filter);
+    std::vector<uint32_t> seeds = generateSeeds32(d_filter);
+    rand_seeds.assign(seeds.begin(), seeds.end());
 
 }
 
-DUET::~DUET() {
-    delete count_min;
-}
-
-
 
 void DUET::Insert2Filter(uint32_t x, uint32_t y) {
 
@@ -58,19 +57,23 @@ void DUET::Insert2Filter(uint32_t x, uint32_t y) {
 
     uint64_t combined_xy = combine_xy(x,y);
 
-    if (filter[row][col].element == 0) {
-        filter[row][col].element = combined_xy;
-        filter[row][col].count = 1;
+    size_t idx = static_cast<size_t>(row) * w_filter + col;
+    uint64_t& element = filter_keys[idx];
+    uint32_t& count = filter_counts[idx];
+
+    if (element == 0) {
+        element = combined_xy;
+        count = 1;
     }
-    else if (filter[row][col].element == combined_xy) {
-        filter[row][col].count++;
+    else if (element == combined_xy) {
+        count++;
     }
 
     else {
-        filter[row][col].count--;
-        if (filter[row][col].count == 0) {
-            filter[row][col].element = combined_xy;
-            filter[row][col].count = 1;
+        count--;
+        if (count == 0) {
+            element = combined_xy;
+            count = 1;
         }
     }
 
@@ -86,55 +89,67 @@ void DUET::Insert2Table(uint32_t x, uint32_t y, uint32_t cnt) {
     MurmurHash3_x86_32(&x, sizeof(x), 17157137, &hash_val);
     uint32_t i = hash_val % l_stable;
 
-    // Search for combined_xy in the determined row
-    int empty_cell_index = -1;
-    uint32_t min_frequency = UINT32_MAX; // Max value for uint32_t
-    int min_cell_index = -1;
+    uint64_t* row_keys = stable_keys.data() + static_cast<size_t>(i) * r_stride;
+    uint32_t* row_counts = stable_counts.data() + static_cast<size_t>(i) * r_stride;
 
-    for (int j = 0; j < r_stable; ++j) {
-        Bucket& current_cell = stable[i][j];
-
-        if (current_cell.element == combined_xy) {
-            // Case 1: The element already exists. Add to its frequency.
-            current_cell.count += cnt;
-            return;
-        }
-
-        // Find an empty cell
-        if (current_cell.element == 0 && empty_cell_index == -1) {
-            empty_cell_index = j;
-        }
+    // Search for combined_xy in the determined row, remembering the first empty cell
+    uint32_t empty_cell_index = 0;
+    int64_t match_index = kernels->probe_row_u64(row_keys, r_stable, combined_xy, empty_cell_index);
 
-        if (current_cell.element != 0 && current_cell.count < min_frequency) {
-            min_frequency = current_cell.count;
-            min_cell_index = j;
-        }
+    if (match_index >= 0) {
+        // Case 1: The element already exists. Add to its frequency.
+        row_counts[match_index] += cnt;
+        return;
     }
 
     // Case 2: Element does not exist, but there is an empty cell.
-    if (empty_cell_index != -1) {
-        Bucket& empty_cell = stable[i][empty_cell_index];
-        empty_cell.element = combined_xy;
-        empty_cell.count = cnt;
+    if (empty_cell_index < static_cast<uint32_t>(r_stable)) {
+        row_keys[empty_cell_index] = combined_xy;
+        row_counts[empty_cell_index] = cnt;
         return;
     }
 
     // Case 3: Element does not exist, and the row is full.
     // Decrease the frequency of the least frequent cell.
-    Bucket& min_cell = stable[i][min_cell_index];
-    if (min_cell.count > cnt) {
-        min_cell.count -= cnt;
+    // All cells are occupied here, so the minimum is taken over the whole row.
+    uint32_t min_cell_index = kernels->argmin_u32(row_counts, r_stable);
+    uint32_t& min_count = row_counts[min_cell_index];
+    if (min_count > cnt) {
+        min_count -= cnt;
     } else {
-        min_cell.element = combined_xy;
-        min_cell.count = cnt - min_cell.count;
+        row_keys[min_cell_index] = combined_xy;
+        min_count = cnt - min_count;
     }
 }
 
 
 void DUET::update(uint32_t x, uint32_t y) {
+    update_estimated(x, y, count_min.query_update(x));
+}
+
+
+void DUET::update_batch(const Record* records, size_t n) {
+
+    constexpr size_t group = 64;
+    uint32_t xs[group];
+    uint32_t cm_es[group];
+
+    for (size_t base = 0; base < n; base += group) {
+        size_t len = std::min(group, n - base);
+
+        // the CountMin pass only depends on x, so it runs ahead for the whole group
+        for (size_t g = 0; g < len; ++g) xs[g] = records[base + g].first;
+        count_min.query_update_batch(xs, len, cm_es);
+
+        for (size_t g = 0; g < len; ++g) {
+            update_estimated(records[base + g].first, records[base + g].second, cm_es[g]);
+        }
+    }
+}
+
+
+void DUET::update_estimated(uint32_t x, uint32_t y, uint32_t cm_es) {
 
-    uint32_t cm_es = count_min->query(x);
-    count_min->update(x);
     if (cm_es < Nth) {
         Insert2Filter(x, y);
         if (cm_es + 1 == Nth) {
@@ -142,12 +157,13 @@ void DUET::update(uint32_t x, uint32_t y) {
                 uint32_t hash_val = 0;
                 MurmurHash3_x86_32(&x, sizeof(x), rand_seeds[i], &hash_val);
                 uint32_t j = hash_val % w_filter;
-                uint64_t combined_xy = filter[i][j].element;
+                size_t idx = static_cast<size_t>(i) * w_filter + j;
+                uint64_t combined_xy = filter_keys[idx];
                 std::pair<uint32_t, uint32_t> labels = split_xy(combined_xy);
                 if (labels.first == x) {
-                    Insert2Table(x,labels.second, filter[i][j].count);
-                    filter[i][j].element = 0;
-                    filter[i][j].count = 0;
+                    Insert2Table(x,labels.second, filter_counts[idx]);
+                    filter_keys[idx] = 0;
+                    filter_counts[idx] = 0;
                 }
             }
         }
@@ -164,7 +180,7 @@ void DUET::update(uint32_t x, uint32_t y) {
 // 1st map stores heavy item/flow along with estimated frequency
 // 2nd map stores hot quadratic elements (in the form of combine(x,y)) and frequencies
 // you can invoke function 'split_xy(uint64_t)' to get 'x' and 'y'
-std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> DUET::query(uint32_t heavy_hitter_th, float phi) {
+std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> DUET::query_combined(uint32_t heavy_hitter_th, float phi) {
 
     // an element is hot quadratic if its count >= (phi * item's frequency)
 
@@ -174,14 +190,14 @@ std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> DUET::quer
     // Iterate through all cells in STable
     for (int i = 0; i < l_stable; ++i) {
         for (int j = 0; j < r_stable; ++j) {
-            const Bucket& current_cell = stable[i][j];
-            if (current_cell.element != 0) {
-                uint64_t combined_xy = current_cell.element;
-                uint32_t xy_count = current_cell.count;
+            size_t idx = static_cast<size_t>(i) * r_stride + j;
+            if (stable_keys[idx] != 0) {
+                uint64_t combined_xy = stable_keys[idx];
+                uint32_t xy_count = stable_counts[idx];
 
                 std::pair<uint32_t, uint32_t> split_pair = split_xy(combined_xy);
                 uint32_t current_x = split_pair.first;
-                uint32_t cm_es = count_min->query(current_x);
+                uint32_t cm_es = count_min.query(current_x);
 
                 // Condition : Check for heavy hitter
                 if (cm_es >= heavy_hitter_th) {
@@ -211,9 +227,9 @@ std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> DUET::quer
  * The key is the heavy hitter's flow ID (uint32_t), and the value is another map.
  * The inner map stores element ID (uint32_t) -> frequency (uint32_t).
  */
-std::pair<std::map<uint32_t, uint32_t>, std::map<uint32_t, std::map<uint32_t, uint32_t>>> DUET::getHHAndHotQuadEle(uint32_t heavy_hitter_th, float phi) {
+std::pair<std::map<uint32_t, uint32_t>, std::map<uint32_t, std::map<uint32_t, uint32_t>>> DUET::query(uint32_t heavy_hitter_th, float phi) {
 
-    auto[heavy_hitters, hot_quadratic_elements] = query(heavy_hitter_th, phi);
+    auto[heavy_hitters, hot_quadratic_elements] = query_combined(heavy_hitter_th, phi);
 
     // This map will store the final hot elements for each heavy hitter
     std::map<uint32_t, std::map<uint32_t, uint32_t>> hot_quad_elements;
@@ -231,114 +247,15 @@ std::pair<std::map<uint32_t, uint32_t>, std::map<uint32_t, std::map<uint32_t, ui
 
 
 
-void DUET::evaluation(const std::vector<std::pair<uint32_t, uint32_t>> &dataset,
-                            const std::map<uint32_t, uint32_t> &flows,
-                            std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                            uint32_t heavy_hitter_th, float ele_th_phi) {
-
-    std::cout << "\n" << "DUET:" << std::endl;
-
-    // Process the entire dataset
-    auto start_update = std::chrono::high_resolution_clock::now();
-    for (const auto &[x, y]: dataset) {
-        update(x, y);
-    }
-    auto end_update = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> update_duration = end_update - start_update;
-    double update_throughput_Mdps = (dataset.size() / 1e6) / update_duration.count();
-    std::cout << " - Update Throughput: " << update_throughput_Mdps << " Mdps" << std::endl;
-
-
-    // Query the sketch for results
-    auto start_query = std::chrono::high_resolution_clock::now();
-    auto [queried_heavy_hitters, queried_quad_elements] = getHHAndHotQuadEle(heavy_hitter_th, ele_th_phi);
-    auto end_query = std::chrono::high_resolution_clock::now();
-    auto query_duration = end_query - start_query;
-    std::cout << " - Query Time: " << std::chrono::duration<double, std::milli>(query_duration).count() << " ms" << std::endl;
-
-
-    // Find true heavy hitters and their hot quadratic elements
-    std::map<uint32_t, uint32_t> true_heavy_hitters;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_hot_quad_elements;
-
-    for (const auto &[flow_id, flow_size]: flows) {
-        if (flow_size >= heavy_hitter_th) {
-            true_heavy_hitters[flow_id] = flow_size;
-
-            // Find true hot quadratic elements for this heavy hitter
-            if (quadratic_eles.count(flow_id)) {
-                for (const auto &[ele_id, ele_size]: quadratic_eles.at(flow_id)) {
-                    if (ele_size >= ele_th_phi * flow_size)
-                        true_hot_quad_elements[flow_id][ele_id] = ele_size;
-                }
-            }
-        }
-    }
-
-    // --- Heavy Hitter Evaluation ---
-
-    float hh_are_sum = 0.0f;
-    uint32_t hh_true_positives = 0;
-    for (const auto &[id, true_size]: true_heavy_hitters) {
-        if (queried_heavy_hitters.count(id)) {
-            uint32_t queried_size = queried_heavy_hitters.at(id);
-            hh_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-            hh_true_positives++;
-        }
-    }
-
-    float hh_are = (hh_true_positives > 0) ? hh_are_sum / hh_true_positives : 0.0f;
-    float hh_precision = (queried_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                              queried_heavy_hitters.size() : 0.0f;
-    float hh_recall = (true_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                        true_heavy_hitters.size() : 0.0f;
-    float hh_f1 = (hh_precision + hh_recall > 0) ? 2 * (hh_precision * hh_recall) / (hh_precision + hh_recall) : 0.0f;
-
-    std::cout << " - Heavy Hitter Metrics | ";
-    std::cout << "ARE: " << hh_are << ", ";
-    std::cout << "F1: " << hh_f1 << "\n";
-
-
-    // --- Quadratic Element Evaluation ---
-
-    float ele_are_sum = 0.0f;
-    uint32_t ele_true_positives = 0;
-    uint32_t total_queried_hot_ele_count = 0; // queried hot quadratic element count
-    uint32_t total_true_hot_ele_count = 0; // true hot quadratic element count
-
-
-    for (const auto &[flow_id, queried_elements]: queried_quad_elements) {
-        total_queried_hot_ele_count += queried_elements.size();
-    }
-
-
-    // Calculate ARE and True Positives
-    for (const auto &[flow_id, true_hot_elements]: true_hot_quad_elements) {
-        if (queried_quad_elements.count(flow_id)) {
-            const auto &queried_elements = queried_quad_elements.at(flow_id);
-            for (const auto &[ele_id, true_size]: true_hot_elements) {
-                if (queried_elements.count(ele_id)) {
-                    uint32_t queried_size = queried_elements.at(ele_id);
-                    ele_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-                    ele_true_positives++;
-                }
-            }
-        }
-        total_true_hot_ele_count += true_hot_elements.size();
-    }
-
-
-
-    float ele_are = (ele_true_positives > 0) ? ele_are_sum / ele_true_positives : 0.0f;
-    float ele_precision = (total_queried_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
-                                                              total_queried_hot_ele_count : 0.0f;
-    float ele_recall = (total_true_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) / total_true_hot_ele_count
-                                                      : 0.0f;
-    float ele_f1 = (ele_precision + ele_recall > 0) ? 2 * (ele_precision * ele_recall) / (ele_precision + ele_recall)
-                                                    : 0.0f;
+size_t DUET::memory_bytes() const {
+    return memory.bytes();
+}
 
-    std::cout << " - Heavy Quadratic Ele Metrics | ";
-    std::cout << "ARE: " << ele_are << ", ";
-    std::cout << "F1: " << ele_f1 << "\n";
 
+void DUET::reset() {
+    count_min.reset();
+    filter_keys.clear();
+    filter_counts.clear();
+    stable_keys.clear();
+    stable_counts.clear();
 }
@@ -1,4 +1,5 @@
 #include "header/DualSketch.h"
+#include "header/DualSketchStats.h"
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -8,30 +9,42 @@
 #include <numeric>
 #include <random>
 #include <chrono>
+#include <cstring>
 
-DualSketch::DualSketch(float memory_kb) {
+namespace {
 
-    k = 32; // 4, 8, 16, 32, 64
-    m_ht_frac = 0.55; // fraction of memory for HT
+// HT buckets have 5 fields: F, U, C, V, D; each is 32 bits
+constexpr uint32_t ht_bucket_bits = 32 + 32 + 32 + 32 + 32;
+// QT cells have 3 fields: E, R, P; each is 32 bits
+constexpr uint32_t qt_cell_bits = 32 + 32 + 32;
 
-    method = 2; // estimate method = {0: lower bound, 1: upper bound, 2: arithmetic mean, 3: harmonic mean}
+constexpr float heavy_table_fraction = 0.55; // fraction of memory for HT
 
+// numbers of HT buckets and QT cells that fit in memory_kb, 'ht_frac' of it for HT
+void table_sizes(float memory_kb, float ht_frac, uint32_t& m1, uint32_t& m2) {
+    float memo_kb_ht = memory_kb * ht_frac;
+    float memo_kb_qt = memory_kb - memo_kb_ht;
 
-    rand_seed = 171273612;
+    m1 = static_cast<uint32_t>(std::round(memo_kb_ht * 1024 * 8 / ht_bucket_bits));
+    m2 = static_cast<uint32_t>(std::round(memo_kb_qt * 1024 * 8 / qt_cell_bits));
+}
 
-    // the total bits of each bucket in HT.
-    // 5 fields: F, U, C, V, D; each is 32 bits
-    uint32_t ht_bucket_bits = 32 + 32 + 32 + 32 + 32;
+} // namespace
 
-    // the total bits of each Cell in QT.
-    // 3 fields: E, R, P; each is 32 bits
-    const uint32_t qt_cell_bits = 32 + 32 + 32;
 
-    float memo_kb_ht = memory_kb * m_ht_frac;
-    float memo_kb_qt = memory_kb - memo_kb_ht;
+DualSketch::DualSketch(float memory_kb, uint32_t window) {
+
+    k = window; // 4, 8, 16, 32, 64
+    m_ht_frac = heavy_table_fraction;
+
+    method = 2; // estimate method = {0: lower bound, 1: upper bound, 2: arithmetic mean, 3: harmonic mean}
 
-    m1 = static_cast<uint32_t>(std::round(memo_kb_ht * 1024 * 8 / ht_bucket_bits));
-    m2 = static_cast<uint32_t>(std::round(memo_kb_qt * 1024 * 8 / qt_cell_bits));
+
+    rand_seed = 171273612;
+
+    memo_kb = memory_kb;
+
+    table_sizes(memory_kb, m_ht_frac, m1, m2);
 
     heavy_table.resize(m1);
     quad_table.resize(m2);
@@ -51,42 +64,82 @@ void DualSketch::update(uint32_t x, uint32_t y) {
     uint32_t hash_val = 0;
     MurmurHash3_x86_32(&x, sizeof(x), rand_seed, &hash_val);
 
+    update_hashed(x, y, hash_val);
+}
+
+
+DualSketchEvent DualSketch::update_case(uint32_t x, uint32_t y) {
+
+    uint32_t hash_val = 0;
+    MurmurHash3_x86_32(&x, sizeof(x), rand_seed, &hash_val);
+
+    return update_hashed(x, y, hash_val);
+}
+
+
+void DualSketch::update_batch(const Record* records, size_t n) {
+
+    constexpr size_t group = 16;
+    uint32_t xs[group];
+    uint32_t hash_vals[group];
+
+    for (size_t base = 0; base < n; base += group) {
+        size_t len = std::min(group, n - base);
+
+        // one kernel call hashes the whole group, 16 lanes at once with AVX-512
+        for (size_t g = 0; g < len; ++g) xs[g] = records[base + g].first;
+        kernels->hash_u32(xs, len, rand_seed, hash_vals);
+
+        for (size_t g = 0; g < len; ++g) {
+            __builtin_prefetch(&heavy_table[hash_vals[g] % m1], 1);
+            __builtin_prefetch(&quad_table[hash_vals[g] % (m2 - k + 1)], 1);
+        }
+
+        for (size_t g = 0; g < len; ++g) {
+            update_hashed(records[base + g].first, records[base + g].second, hash_vals[g]);
+        }
+    }
+}
+
+
+DualSketchEvent DualSketch::update_hashed(uint32_t x, uint32_t y, uint32_t hash_val) {
+
     uint32_t i = hash_val % m1; // bkt index in HT
+    count_event(DualSketchEvent::Update);
 
     // Case 1: HT[i] is empty
     if (heavy_table[i].F == 0) {
-
-        uint32_t min_R_value = UINT32_MAX;
-        int64_t min_cell_index = -1;
+        count_event(DualSketchEvent::EmptyBucket);
 
         uint32_t j_start = hash_val % (m2 - k + 1); // start cell index in QT
-        for (uint32_t j = j_start; j < (j_start + k) ; ++j) {
-            // last accessed cell index is j_start + k - 1
-            if (quad_table[j].E == 0){
-                quad_table[j].E = y;
-                quad_table[j].R = 1;
-                quad_table[j].P = x;
-
-                heavy_table[i].F = x;
-                heavy_table[i].U = heavy_table[i].D;
-                heavy_table[i].C = 1;
-                heavy_table[i].V = 0;
-                return;
-
-            } else{
-                // Find cell with minimum R value
-                if (quad_table[j].R < min_R_value) {
-                    min_R_value = quad_table[j].R;
-                    min_cell_index = j;
-                }
-            }
+
+        // Look for an empty cell (a cell with E = P = 0 ends the scan), else the cell with minimum R
+        uint32_t first_empty = 0, min_R_offset = 0;
+        int64_t free_cell = kernels->qt_window_scan(qt_cells(j_start), k, 0, 0, first_empty, min_R_offset);
+        if (first_empty < k) free_cell = first_empty;
+        if (free_cell >= 0) {
+            uint32_t j = j_start + static_cast<uint32_t>(free_cell);
+            quad_table[j].E = y;
+            quad_table[j].R = 1;
+            quad_table[j].P = x;
+
+            heavy_table[i].F = x;
+            heavy_table[i].U = heavy_table[i].D;
+            heavy_table[i].C = 1;
+            heavy_table[i].V = 0;
+            count_event(DualSketchEvent::EmptyInsert);
+            return DualSketchEvent::EmptyInsert;
         }
+        uint32_t min_cell_index = j_start + min_R_offset;
 
         // No empty cell found, perform decay on the min cell
         quad_table[min_cell_index].R--;
         if (quad_table[min_cell_index].R > 0) {
             heavy_table[i].D++;
+            count_event(DualSketchEvent::EmptyDecay);
+            return DualSketchEvent::EmptyDecay;
         } else {
+            count_event(DualSketchEvent::EmptyReplace);
             uint32_t x_clear = quad_table[min_cell_index].P;
 
             quad_table[min_cell_index].E = y;
@@ -98,18 +151,20 @@ void DualSketch::update(uint32_t x, uint32_t y) {
             heavy_table[i].C = 1;
             heavy_table[i].V = 0;
 
-            if (x_clear == x) return; // In theory, this should never happen, just for code robustness.
+            if (x_clear == x) return DualSketchEvent::EmptyReplace; // In theory, this should never happen, just for code robustness.
+            count_event(DualSketchEvent::CellSteal);
 
             uint32_t hash_val_tmp = 0;
             MurmurHash3_x86_32(&x_clear, sizeof(x_clear), rand_seed, &hash_val_tmp);
             uint32_t j_tmp = hash_val_tmp % (m2 - k + 1);
 
-            for (uint32_t j = j_tmp; j < (j_tmp + k); ++j) {
-                if (quad_table[j].P == x_clear)
-                    return;
+            if (kernels->qt_window_find(qt_cells(j_tmp), k, x_clear) >= 0) {
+                count_event(DualSketchEvent::RescanFound);
+                return DualSketchEvent::EmptyReplace;
             }
 
             uint32_t idx_clear = hash_val_tmp % m1;
+            count_event(DualSketchEvent::RescanEvict);
 
             heavy_table[idx_clear].F = 0;
             heavy_table[idx_clear].U = 0;
@@ -118,53 +173,47 @@ void DualSketch::update(uint32_t x, uint32_t y) {
             heavy_table[idx_clear].V = 0;
 
         }
-        return;
+        return DualSketchEvent::EmptyReplace;
     }
 
 
     // Case 2: HT[i] is not empty, and HT[i].F == x
     if (heavy_table[i].F == x) {
         heavy_table[i].C++;
-
-        int64_t empty_cell_index = -1;
-        int64_t min_cell_index = -1;
-        uint32_t min_R_value = UINT32_MAX;
+        count_event(DualSketchEvent::OwnerUpdate);
 
         uint32_t j_start = hash_val % (m2 - k + 1); // start cell index in QT
-        for (uint32_t j = j_start; j < (j_start + k); ++j) {
 
-            // Element y already exists in a cell
-            if (quad_table[j].E == y && quad_table[j].P == x) {
-                quad_table[j].R++;
-                return;
-            }
-
-            // Find 1st empty cell
-            if (quad_table[j].E == 0 && empty_cell_index == -1 ) {
-                empty_cell_index = j;
-            }
-
-            // Find cell with minimum R value
-            if (quad_table[j].E != 0 && quad_table[j].R < min_R_value) {
-                min_R_value = quad_table[j].R;
-                min_cell_index = j;
-            }
+        // Find the cell of element y, else the 1st empty cell and the cell with minimum R value
+        uint32_t first_empty = 0, min_R_offset = 0;
+        int64_t hit = kernels->qt_window_scan(qt_cells(j_start), k, x, y, first_empty, min_R_offset);
+        if (hit >= 0) {
+            quad_table[j_start + hit].R++;
+            count_event(DualSketchEvent::OwnerHit);
+            count_hit_offset(static_cast<uint32_t>(hit));
+            return DualSketchEvent::OwnerHit;
         }
+        uint32_t empty_cell_index = j_start + first_empty;
+        uint32_t min_cell_index = j_start + min_R_offset;
 
-        // If the loop completes, it means element y was not found.
-        if (empty_cell_index > -1) {
+        // Element y was not found
+        if (first_empty < k) {
             // Insert the new element y into the empty cell
             quad_table[empty_cell_index].E = y;
             quad_table[empty_cell_index].R = 1;
             quad_table[empty_cell_index].P = x;
+            count_event(DualSketchEvent::OwnerInsert);
+            return DualSketchEvent::OwnerInsert;
         } else {
             // No empty cell found, perform decay on the min cell
             quad_table[min_cell_index].R--;
 
             // If R > 0 after decay, end process
             if (quad_table[min_cell_index].R > 0) {
-                return;
+                count_event(DualSketchEvent::OwnerDecay);
+                return DualSketchEvent::OwnerDecay;
             }
+            count_event(DualSketchEvent::OwnerReplace);
 
             // If R == 0, replace the cell with the new element y
             uint32_t x_clear = quad_table[min_cell_index].P;
@@ -176,21 +225,22 @@ void DualSketch::update(uint32_t x, uint32_t y) {
 
             // If the cleared cell belonged to the current flow (x), just replace it
             if (x_clear == x) {
-                return;
+                return DualSketchEvent::OwnerReplace;
             }
 
             // If the cleared cell belonged to another flow (x'), check for consistency
+            count_event(DualSketchEvent::CellSteal);
             uint32_t hash_val_tmp = 0;
             MurmurHash3_x86_32(&x_clear, sizeof(x_clear), rand_seed, &hash_val_tmp);
             uint32_t j_tmp = hash_val_tmp % (m2 - k + 1);
 
-            for (uint32_t j = j_tmp; j < (j_tmp + k); ++j) {
-                if (quad_table[j].P == x_clear) {
-                    return;
-                }
+            if (kernels->qt_window_find(qt_cells(j_tmp), k, x_clear) >= 0) {
+                count_event(DualSketchEvent::RescanFound);
+                return DualSketchEvent::OwnerReplace;
             }
 
             uint32_t idx_clear = hash_val_tmp % m1;
+            count_event(DualSketchEvent::RescanEvict);
 
             // Kick out the old flow
             heavy_table[idx_clear].F = 0;
@@ -198,6 +248,7 @@ void DualSketch::update(uint32_t x, uint32_t y) {
             heavy_table[idx_clear].D += heavy_table[idx_clear].C + heavy_table[idx_clear].V;
             heavy_table[idx_clear].C = 0;
             heavy_table[idx_clear].V = 0;
+            return DualSketchEvent::OwnerReplace;
         }
 
     }
@@ -206,12 +257,15 @@ void DualSketch::update(uint32_t x, uint32_t y) {
     else {
         heavy_table[i].C--;
         heavy_table[i].V++;
+        count_event(DualSketchEvent::OtherUpdate);
 
         // If C > 0 after decay, drop the packet
         if (heavy_table[i].C > 0) {
             heavy_table[i].D++;
-            return;
+            count_event(DualSketchEvent::OtherDecay);
+            return DualSketchEvent::OtherDecay;
         }
+        count_event(DualSketchEvent::OtherEvict);
 
         // If C == 0, kick out the old flow
 
@@ -227,16 +281,11 @@ void DualSketch::update(uint32_t x, uint32_t y) {
         uint32_t hash_val_clear = 0;
         MurmurHash3_x86_32(&x_clear, sizeof(x_clear), rand_seed, &hash_val_clear);
         uint32_t j_clear = hash_val_clear % (m2 - k + 1);
-        for (uint32_t j = j_clear; j < (j_clear + k); ++j) {
-            if (quad_table[j].P == x_clear) {
-                quad_table[j].E = 0;
-                quad_table[j].R = 0;
-                quad_table[j].P = 0;
-            }
-        }
+        count_event(DualSketchEvent::ClearedCells, kernels->qt_window_clear(qt_cells(j_clear), k, x_clear));
 
         // drop the arriving (x,y)
         heavy_table[i].D++;
+        return DualSketchEvent::OtherEvict;
     }
 
 }
@@ -247,6 +296,7 @@ void DualSketch::update(uint32_t x, uint32_t y) {
 
 /**
  * @brief Queries the DualSketch to retrieve heavy hitters and their heavy quadratic elements.
+ * An element is hot if its size >= phi * (estimated size of its heavy hitter).
  * @return A pair of maps.
  * 1st map stores heavy hitters: ID (uint32_t) -> estimated frequency (uint32_t).
  * 2nd map stores hot quadratic elements for each heavy hitter:
@@ -254,7 +304,7 @@ void DualSketch::update(uint32_t x, uint32_t y) {
  * The inner map stores element (uint32_t) -> frequency (uint32_t).
  */
 std::pair<std::map<uint32_t, uint32_t>,
-        std::map<uint32_t, std::map<uint32_t, uint32_t>>> DualSketch::query(uint32_t heavy_hitter_th) {
+        std::map<uint32_t, std::map<uint32_t, uint32_t>>> DualSketch::query(uint32_t heavy_hitter_th, float phi) const {
     std::map<uint32_t, uint32_t> heavy_hitters;
     std::map<uint32_t, std::map<uint32_t, uint32_t>> quad_elements;
 
@@ -303,7 +353,8 @@ std::pair<std::map<uint32_t, uint32_t>,
                 std::map<uint32_t, uint32_t> current_quad_elements;
                 for (uint32_t j = j_start; j < (j_start + k); ++j) {
                     // Check if the cell belongs to the current heavy hitter
-                    if (quad_table[j].E != 0 && quad_table[j].P == x) {
+                    if (quad_table[j].E != 0 && quad_table[j].P == x
+                        && quad_table[j].R >= phi * heavy_hitter_size) {
                         current_quad_elements[quad_table[j].E] = quad_table[j].R;
                     }
                 }
@@ -316,120 +367,200 @@ std::pair<std::map<uint32_t, uint32_t>,
 }
 
 
-void DualSketch::evaluation(const std::vector<std::pair<uint32_t, uint32_t>> &dataset,
-                            const std::map<uint32_t, uint32_t> &flows,
-                            std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                            uint32_t heavy_hitter_th, float ele_th_phi) {
-
-    std::cout << "\n" << "DualSketch:" << std::endl;
 
-    // Process the entire dataset
-    auto start_update = std::chrono::high_resolution_clock::now();
-    for (const auto &[x, y]: dataset) {
-        update(x, y);
+/**
+ * @brief Merges 'other' into this sketch, as if its stream had been added to this one.
+ * HT buckets combine by their owners: equal owners add their counters; different owners
+ * vote, and the one with the larger C keeps the bucket with the other's C taken off (a bucket
+ * left at C = 0 is emptied, as in Case 3). The traffic the merged owner may have lost on the
+ * other side goes into U, so the upper bound stays an upper bound.
+ * QT cells of the flows that still own their buckets are pooled, their R summed per
+ * (flow, element), and put back heaviest first into their flows' windows; cells that no
+ * longer fit are dropped.
+ */
+bool DualSketch::merge(const DualSketch& other) {
+    if (other.m1 != m1 || other.m2 != m2 || other.k != k || other.rand_seed != rand_seed || other.method != method) {
+        return false;
     }
-    auto end_update = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> update_duration = end_update - start_update;
-    double update_throughput_Mdps = (dataset.size() / 1e6) / update_duration.count();
-    std::cout << " - Update Throughput: " << update_throughput_Mdps << " Mdps" << std::endl;
-
-    // Query the sketch for results
-    auto start_query = std::chrono::high_resolution_clock::now();
-    auto [queried_heavy_hitters, queried_quad_elements] = query(heavy_hitter_th);
-    auto end_query = std::chrono::high_resolution_clock::now();
-    auto query_duration = end_query - start_query;
-    std::cout << " - Query Time: " << std::chrono::duration<double, std::milli>(query_duration).count() << " ms" << std::endl;
-
-    // Find true heavy hitters and their hot quadratic elements
-    std::map<uint32_t, uint32_t> true_heavy_hitters;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_hot_quad_elements;
-
-    for (const auto &[flow_id, flow_size]: flows) {
-        if (flow_size >= heavy_hitter_th) {
-            true_heavy_hitters[flow_id] = flow_size;
-
-            // Find true hot quadratic elements for this heavy hitter
-            if (quadratic_eles.count(flow_id)) {
-                for (const auto &[ele_id, ele_size]: quadratic_eles.at(flow_id)) {
-                    if (ele_size >= ele_th_phi * flow_size)
-                        true_hot_quad_elements[flow_id][ele_id] = ele_size;
-                }
+
+    // allocated before anything changes, so a failed merge leaves this sketch as it was
+    struct PooledCell {
+        uint32_t P, E, R;
+    };
+    std::vector<PooledCell> pooled;
+    pooled.reserve(2 * static_cast<size_t>(m2));
+
+    for (uint32_t i = 0; i < m1; ++i) {
+        HTBucket& a = heavy_table[i];
+        const HTBucket& b = other.heavy_table[i];
+
+        if (b.F == 0) {
+            if (a.F != 0) a.U += b.D;
+            a.D += b.D;
+        } else if (a.F == 0) {
+            uint32_t d = a.D;
+            a = b;
+            a.U += d;
+            a.D += d;
+        } else if (a.F == b.F) {
+            a.U += b.U;
+            a.C += b.C;
+            a.V += b.V;
+            a.D += b.D;
+        } else {
+            const HTBucket winner = a.C >= b.C ? a : b;
+            const HTBucket loser = a.C >= b.C ? b : a;
+            a = winner;
+            a.C = winner.C - loser.C;
+            a.V = winner.V + loser.C;
+            a.U = winner.U + loser.D + loser.V;
+            a.D = winner.D + loser.D + loser.C + loser.V;
+            if (a.C == 0) {
+                a.F = 0;
+                a.U = 0;
+                a.D += a.V;
+                a.V = 0;
             }
         }
     }
 
-    // --- Heavy Hitter Evaluation ---
-
-    float hh_are_sum = 0.0f;
-    uint32_t hh_true_positives = 0;
-    for (const auto &[id, true_size]: true_heavy_hitters) {
-        if (queried_heavy_hitters.count(id)) {
-            uint32_t queried_size = queried_heavy_hitters.at(id);
-            hh_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-            hh_true_positives++;
+    const TrackedVector<QTCell>* tables[] = {&quad_table, &other.quad_table};
+    for (const TrackedVector<QTCell>* table: tables) {
+        for (const QTCell& cell: *table) {
+            if (cell.E == 0) continue;
+            uint32_t hash_val = 0;
+            MurmurHash3_x86_32(&cell.P, sizeof(cell.P), rand_seed, &hash_val);
+            if (heavy_table[hash_val % m1].F == cell.P) pooled.push_back({cell.P, cell.E, cell.R});
         }
     }
 
-    float hh_are = (hh_true_positives > 0) ? hh_are_sum / hh_true_positives : 0.0f;
-    float hh_precision = (queried_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                              queried_heavy_hitters.size() : 0.0f;
-    float hh_recall = (true_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                        true_heavy_hitters.size() : 0.0f;
-    float hh_f1 = (hh_precision + hh_recall > 0) ? 2 * (hh_precision * hh_recall) / (hh_precision + hh_recall) : 0.0f;
-
-    std::cout << " - Heavy Hitter Metrics | ";
-    std::cout << "ARE: " << hh_are << ", ";
-    std::cout << "F1: " << hh_f1 << "\n";
-
-
-    // --- Quadratic Element Evaluation ---
-
-    float ele_are_sum = 0.0f;
-    uint32_t ele_true_positives = 0;
-    uint32_t total_queried_hot_ele_count = 0; // queried hot quadratic element count
-    uint32_t total_true_hot_ele_count = 0; // true hot quadratic element count
-
-    // get queried hot quadratic elements
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> queried_hot_quad_elements;
-    for (const auto &[flow_id, queried_elements]: queried_quad_elements) {
-        uint32_t queried_flow_size = queried_heavy_hitters[flow_id];
-        for (const auto &[ele_id, queried_ele_size]: queried_elements){
-            if (queried_ele_size >= ele_th_phi * queried_flow_size)
-            {
-                queried_hot_quad_elements[flow_id][ele_id] = queried_ele_size;
-                total_queried_hot_ele_count += 1;
+    // sum R per (flow, element), then order heaviest first (ties by flow and element)
+    std::sort(pooled.begin(), pooled.end(), [](const PooledCell& l, const PooledCell& r) {
+        return l.P != r.P ? l.P < r.P : l.E < r.E;
+    });
+    size_t distinct = 0;
+    for (size_t c = 0; c < pooled.size(); ++c) {
+        if (distinct > 0 && pooled[distinct - 1].P == pooled[c].P && pooled[distinct - 1].E == pooled[c].E) {
+            pooled[distinct - 1].R += pooled[c].R;
+        } else {
+            pooled[distinct++] = pooled[c];
+        }
+    }
+    pooled.resize(distinct);
+    std::stable_sort(pooled.begin(), pooled.end(), [](const PooledCell& l, const PooledCell& r) { return l.R > r.R; });
+
+    std::fill(quad_table.begin(), quad_table.end(), QTCell());
+    for (const PooledCell& cell: pooled) {
+        uint32_t hash_val = 0;
+        MurmurHash3_x86_32(&cell.P, sizeof(cell.P), rand_seed, &hash_val);
+        uint32_t j_start = hash_val % (m2 - k + 1);
+        for (uint32_t j = j_start; j < (j_start + k); ++j) {
+            if (quad_table[j].E == 0) {
+                quad_table[j].E = cell.E;
+                quad_table[j].R = cell.R;
+                quad_table[j].P = cell.P;
+                break;
             }
         }
     }
+    return true;
+}
 
 
-    // Calculate ARE and True Positives
-    for (const auto &[flow_id, true_hot_elements]: true_hot_quad_elements) {
-        if (queried_hot_quad_elements.count(flow_id)) {
-            const auto &queried_hot_elements = queried_hot_quad_elements.at(flow_id);
-            for (const auto &[ele_id, true_size]: true_hot_elements) {
-                if (queried_hot_elements.count(ele_id)) {
-                    uint32_t queried_size = queried_hot_elements.at(ele_id);
-                    ele_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-                    ele_true_positives++;
-                }
-            }
-        }
-        total_true_hot_ele_count += true_hot_elements.size();
+
+// Image layout, all fields 32-bit little-endian:
+//   "DSK1", version, memory_kb (float bits), k, rand_seed, method, m1, m2,
+//   then m1 HT buckets (F, U, C, V, D) and m2 QT cells (E, R, P).
+namespace {
+
+constexpr uint32_t image_version = 1;
+constexpr size_t image_header_words = 8;
+
+void put_u32(uint8_t*& out, uint32_t value) {
+    for (int b = 0; b < 4; ++b) *out++ = static_cast<uint8_t>(value >> (8 * b));
+}
+
+uint32_t get_u32(const uint8_t*& in) {
+    uint32_t value = 0;
+    for (int b = 0; b < 4; ++b) value |= static_cast<uint32_t>(*in++) << (8 * b);
+    return value;
+}
+
+} // namespace
+
+
+size_t DualSketch::serialized_size() const {
+    return 4 * (image_header_words + 5 * static_cast<size_t>(m1) + 3 * static_cast<size_t>(m2));
+}
+
+
+void DualSketch::serialize(uint8_t* out) const {
+    uint32_t kb_bits = 0;
+    std::memcpy(&kb_bits, &memo_kb, sizeof(kb_bits));
+
+    std::memcpy(out, "DSK1", 4);
+    out += 4;
+    for (uint32_t word: {image_version, kb_bits, k, rand_seed, method, m1, m2}) put_u32(out, word);
+    for (const HTBucket& bucket: heavy_table) {
+        for (uint32_t field: {bucket.F, bucket.U, bucket.C, bucket.V, bucket.D}) put_u32(out, field);
+    }
+    for (const QTCell& cell: quad_table) {
+        for (uint32_t field: {cell.E, cell.R, cell.P}) put_u32(out, field);
+    }
+}
+
+
+std::unique_ptr<DualSketch> DualSketch::deserialize(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < 4 * image_header_words || std::memcmp(data, "DSK1", 4) != 0) return nullptr;
+
+    const uint8_t* in = data + 4;
+    uint32_t version = get_u32(in);
+    uint32_t kb_bits = get_u32(in);
+    uint32_t image_k = get_u32(in);
+    uint32_t image_seed = get_u32(in);
+    uint32_t image_method = get_u32(in);
+    uint32_t image_m1 = get_u32(in);
+    uint32_t image_m2 = get_u32(in);
+
+    float memory_kb = 0;
+    std::memcpy(&memory_kb, &kb_bits, sizeof(memory_kb));
+    // the tables must be those a sketch of memory_kb has, usable by update() (m1 > 0, m2 >= k),
+    // and fill the rest of the image exactly; checked before anything is allocated for them
+    if (version != image_version || !(memory_kb > 0 && memory_kb * 1024.0 <= size)) return nullptr;
+    uint32_t m1 = 0, m2 = 0;
+    table_sizes(memory_kb, heavy_table_fraction, m1, m2);
+    size_t expected = 4 * (image_header_words + 5 * static_cast<size_t>(m1) + 3 * static_cast<size_t>(m2));
+    if (image_m1 != m1 || image_m2 != m2 || m1 == 0 || image_k == 0 || m2 < image_k || size != expected) return nullptr;
+
+    auto sketch = std::make_unique<DualSketch>(memory_kb, image_k);
+    if (sketch->k != image_k || sketch->rand_seed != image_seed || sketch->method != image_method) return nullptr;
+    for (HTBucket& bucket: sketch->heavy_table) {
+        for (uint32_t* field: {&bucket.F, &bucket.U, &bucket.C, &bucket.V, &bucket.D}) *field = get_u32(in);
+    }
+    for (QTCell& cell: sketch->quad_table) {
+        for (uint32_t* field: {&cell.E, &cell.R, &cell.P}) *field = get_u32(in);
+    }
+
+    // every element lies in its flow's window, which also catches a k other than the writer's
+    for (uint32_t j = 0; j < m2; ++j) {
+        const QTCell& cell = sketch->quad_table[j];
+        if (cell.E == 0) continue;
+        uint32_t hash_val = 0;
+        MurmurHash3_x86_32(&cell.P, sizeof(cell.P), sketch->rand_seed, &hash_val);
+        uint32_t j_start = hash_val % (m2 - image_k + 1);
+        if (j < j_start || j >= j_start + image_k) return nullptr;
     }
+    return sketch;
+}
 
 
 
-    float ele_are = (ele_true_positives > 0) ? ele_are_sum / ele_true_positives : 0.0f;
-    float ele_precision = (total_queried_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
-                                                              total_queried_hot_ele_count : 0.0f;
-    float ele_recall = (total_true_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) / total_true_hot_ele_count
-                                                      : 0.0f;
-    float ele_f1 = (ele_precision + ele_recall > 0) ? 2 * (ele_precision * ele_recall) / (ele_precision + ele_recall)
-                                                    : 0.0f;
+size_t DualSketch::memory_bytes() const {
+    return memory.bytes();
+}
 
-    std::cout << " - Heavy Quadratic Ele Metrics | ";
-    std::cout << "ARE: " << ele_are << ", ";
-    std::cout << "F1: " << ele_f1 << "\n";
 
+void DualSketch::reset() {
+    std::fill(heavy_table.begin(), heavy_table.end(), HTBucket());
+    std::fill(quad_table.begin(), quad_table.end(), QTCell());
 }
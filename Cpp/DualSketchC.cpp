@@ -0,0 +1,115 @@
+#include "header/dualsketch.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include "header/DualSketch.h"
+
+
+// The C handle owns the C++ sketch; nothing may throw across the C boundary.
+struct dualsketch {
+    std::unique_ptr<DualSketch> sketch;
+};
+
+
+namespace {
+
+// Record is a std::pair; dualsketch_record is converted in blocks rather than aliased
+constexpr size_t update_block = 1024;
+
+} // namespace
+
+
+dualsketch* dualsketch_create(float memory_kb) {
+    if (!(memory_kb > 0)) return nullptr;
+    try {
+        auto sketch = std::make_unique<DualSketch>(memory_kb);
+        if (!sketch->valid()) return nullptr;
+        return new dualsketch{std::move(sketch)};
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+
+void dualsketch_destroy(dualsketch* sketch) {
+    delete sketch;
+}
+
+
+void dualsketch_update(dualsketch* sketch, const dualsketch_record* records, size_t count) {
+    if (sketch == nullptr || records == nullptr) return;
+    Record block[update_block];
+    for (size_t base = 0; base < count; base += update_block) {
+        size_t len = std::min(update_block, count - base);
+        for (size_t i = 0; i < len; ++i) block[i] = {records[base + i].flow, records[base + i].element};
+        sketch->sketch->update_batch(block, len);
+    }
+}
+
+
+int dualsketch_query(const dualsketch* sketch, uint32_t heavy_hitter_threshold, float phi,
+                     dualsketch_heavy_hitter* hitters, size_t hitter_capacity, size_t* hitter_count,
+                     dualsketch_element* elements, size_t element_capacity, size_t* element_count) {
+    if (sketch == nullptr || hitter_count == nullptr || element_count == nullptr
+        || (hitters == nullptr && hitter_capacity > 0) || (elements == nullptr && element_capacity > 0)) {
+        return DUALSKETCH_INVALID_ARGUMENT;
+    }
+    try {
+        auto [heavy_hitters, quad_elements] = sketch->sketch->query(heavy_hitter_threshold, phi);
+
+        size_t h = 0;
+        for (const auto& [flow, estimate]: heavy_hitters) {
+            if (h < hitter_capacity) hitters[h] = {flow, estimate};
+            h++;
+        }
+        size_t e = 0;
+        for (const auto& [flow, flow_elements]: quad_elements) {
+            for (const auto& [element, estimate]: flow_elements) {
+                if (e < element_capacity) elements[e] = {flow, element, estimate};
+                e++;
+            }
+        }
+        *hitter_count = h;
+        *element_count = e;
+        return h > hitter_capacity || e > element_capacity ? DUALSKETCH_BUFFER_TOO_SMALL : DUALSKETCH_OK;
+    } catch (const std::bad_alloc&) {
+        return DUALSKETCH_OUT_OF_MEMORY;
+    }
+}
+
+
+int dualsketch_merge(dualsketch* into, const dualsketch* from) {
+    if (into == nullptr || from == nullptr || into == from) return DUALSKETCH_INVALID_ARGUMENT;
+    try {
+        return into->sketch->merge(*from->sketch) ? DUALSKETCH_OK : DUALSKETCH_INCOMPATIBLE;
+    } catch (const std::bad_alloc&) {
+        return DUALSKETCH_OUT_OF_MEMORY;
+    }
+}
+
+
+size_t dualsketch_serialized_size(const dualsketch* sketch) {
+    return sketch == nullptr ? 0 : sketch->sketch->serialized_size();
+}
+
+
+int dualsketch_serialize(const dualsketch* sketch, void* buffer, size_t capacity, size_t* written) {
+    if (sketch == nullptr || written == nullptr || (buffer == nullptr && capacity > 0)) return DUALSKETCH_INVALID_ARGUMENT;
+    size_t size = sketch->sketch->serialized_size();
+    *written = size;
+    if (capacity < size) return DUALSKETCH_BUFFER_TOO_SMALL;
+    sketch->sketch->serialize(static_cast<uint8_t*>(buffer));
+    return DUALSKETCH_OK;
+}
+
+
+dualsketch* dualsketch_deserialize(const void* data, size_t size) {
+    try {
+        auto sketch = DualSketch::deserialize(static_cast<const uint8_t*>(data), size);
+        if (sketch == nullptr) return nullptr;
+        return new dualsketch{std::move(sketch)};
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
@@ -0,0 +1,126 @@
+#include "header/DualSketchStats.h"
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+
+namespace {
+
+std::mutex registry_mutex;
+std::vector<const dualsketch_stats_detail::ThreadCounters*> live_threads;
+DualSketchStats finished_threads;
+
+void add(DualSketchStats& sum, const dualsketch_stats_detail::ThreadCounters& counters) {
+    for (size_t e = 0; e < DUALSKETCH_EVENT_COUNT; ++e) {
+        sum.events[e] += counters.events[e].load(std::memory_order_relaxed);
+    }
+    for (size_t o = 0; o < DUALSKETCH_MAX_WINDOW; ++o) {
+        sum.hit_offsets[o] += counters.hit_offsets[o].load(std::memory_order_relaxed);
+    }
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole == 0 ? 0.0 : 100.0 * part / whole;
+}
+
+// smallest offset at or below which a fraction q of the hits were found
+size_t offset_percentile(const DualSketchStats& stats, double q) {
+    uint64_t hits = 0;
+    for (uint64_t n: stats.hit_offsets) hits += n;
+    uint64_t seen = 0;
+    for (size_t o = 0; o < DUALSKETCH_MAX_WINDOW; ++o) {
+        seen += stats.hit_offsets[o];
+        if (seen > 0 && seen >= q * hits) return o;
+    }
+    return 0;
+}
+
+} // namespace
+
+
+namespace dualsketch_stats_detail {
+
+ThreadCounters::ThreadCounters() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    live_threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    add(finished_threads, *this);
+    live_threads.erase(std::find(live_threads.begin(), live_threads.end(), this));
+}
+
+} // namespace dualsketch_stats_detail
+
+
+const char* dualsketch_event_name(DualSketchEvent event) {
+    switch (event) {
+        case DualSketchEvent::Update: return "update";
+        case DualSketchEvent::EmptyBucket: return "case1";
+        case DualSketchEvent::EmptyInsert: return "case1.insert";
+        case DualSketchEvent::EmptyDecay: return "case1.decay";
+        case DualSketchEvent::EmptyReplace: return "case1.replace";
+        case DualSketchEvent::OwnerUpdate: return "case2";
+        case DualSketchEvent::OwnerHit: return "case2.hit";
+        case DualSketchEvent::OwnerInsert: return "case2.insert";
+        case DualSketchEvent::OwnerDecay: return "case2.decay";
+        case DualSketchEvent::OwnerReplace: return "case2.replace";
+        case DualSketchEvent::OtherUpdate: return "case3";
+        case DualSketchEvent::OtherDecay: return "case3.decay";
+        case DualSketchEvent::OtherEvict: return "case3.evict";
+        case DualSketchEvent::ClearedCells: return "case3.cleared_cells";
+        case DualSketchEvent::CellSteal: return "steal";
+        case DualSketchEvent::RescanFound: return "steal.rescan_found";
+        case DualSketchEvent::RescanEvict: return "steal.rescan_evict";
+    }
+    return "?";
+}
+
+
+DualSketchStats& DualSketchStats::operator-=(const DualSketchStats& earlier) {
+    for (size_t e = 0; e < DUALSKETCH_EVENT_COUNT; ++e) events[e] -= earlier.events[e];
+    for (size_t o = 0; o < DUALSKETCH_MAX_WINDOW; ++o) hit_offsets[o] -= earlier.hit_offsets[o];
+    return *this;
+}
+
+
+DualSketchStats dualsketch_stats() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    DualSketchStats sum = finished_threads;
+    for (const auto* counters: live_threads) add(sum, *counters);
+    return sum;
+}
+
+
+void print_dualsketch_stats(const DualSketchStats& s, std::ostream& out) {
+    using E = DualSketchEvent;
+    uint64_t updates = s[E::Update];
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << " - DualSketch events over " << updates << " updates:\n"
+        << "   case 1 (empty bucket) " << percent(s[E::EmptyBucket], updates) << "%: insert "
+        << percent(s[E::EmptyInsert], s[E::EmptyBucket]) << "%, decay "
+        << percent(s[E::EmptyDecay], s[E::EmptyBucket]) << "%, replace "
+        << percent(s[E::EmptyReplace], s[E::EmptyBucket]) << "%\n"
+        << "   case 2 (own bucket)   " << percent(s[E::OwnerUpdate], updates) << "%: hit "
+        << percent(s[E::OwnerHit], s[E::OwnerUpdate]) << "%, insert "
+        << percent(s[E::OwnerInsert], s[E::OwnerUpdate]) << "%, decay "
+        << percent(s[E::OwnerDecay], s[E::OwnerUpdate]) << "%, replace "
+        << percent(s[E::OwnerReplace], s[E::OwnerUpdate]) << "%\n"
+        << "   case 3 (other flow)   " << percent(s[E::OtherUpdate], updates) << "%: decay "
+        << percent(s[E::OtherDecay], s[E::OtherUpdate]) << "%, evict "
+        << percent(s[E::OtherEvict], s[E::OtherUpdate]) << "% ("
+        << (s[E::OtherEvict] ? static_cast<double>(s[E::ClearedCells]) / s[E::OtherEvict] : 0.0)
+        << " QT cells cleared per eviction)\n"
+        << "   QT cells taken from another flow: " << s[E::CellSteal] << ", whose flow kept its HT entry "
+        << percent(s[E::RescanFound], s[E::CellSteal]) << "% / was evicted "
+        << percent(s[E::RescanEvict], s[E::CellSteal]) << "%\n"
+        << "   case 2 hit offset in window: p50 " << offset_percentile(s, 0.5) << ", p90 "
+        << offset_percentile(s, 0.9) << ", p99 " << offset_percentile(s, 0.99) << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,131 @@
+#include "header/Evaluator.h"
+#include <cmath>
+#include <future>
+
+
+Evaluator::Evaluator(const ExactCounts& counts) : counts(counts) {}
+
+
+const GroundTruth& Evaluator::truth(uint32_t heavy_hitter_th, float phi) {
+
+    auto key = std::make_pair(heavy_hitter_th, phi);
+    auto cached = truths.find(key);
+    if (cached != truths.end()) return cached->second;
+
+    GroundTruth truth;
+    truth.heavy_hitter_th = heavy_hitter_th;
+    truth.phi = phi;
+
+    // Find true heavy hitters and their hot quadratic elements.
+    // The exact counts are sorted, so the arrays come out sorted.
+    for (size_t f = 0; f < counts.flows.size(); ++f) {
+        const FlowCount& flow = counts.flows[f];
+        if (flow.count >= heavy_hitter_th) {
+            truth.heavy_hitters.push_back(flow);
+
+            for (uint64_t e = counts.flow_offsets[f]; e < counts.flow_offsets[f + 1]; ++e) {
+                const ElementCount& ele = counts.elements[e];
+                if (ele.count >= phi * flow.count)
+                    truth.hot_elements.push_back(ele);
+            }
+        }
+    }
+
+    return truths.emplace(key, std::move(truth)).first->second;
+}
+
+
+AccuracyMetrics Evaluator::score(const GroundTruth& truth, const QueryResult& answer) {
+
+    const auto& [queried_heavy_hitters, queried_quad_elements] = answer;
+    AccuracyMetrics metrics{};
+
+    // --- Heavy Hitter Evaluation ---
+
+    float hh_are_sum = 0.0f;
+    uint32_t hh_true_positives = 0;
+
+    auto queried_hh = queried_heavy_hitters.begin();
+    for (const auto& hh: truth.heavy_hitters) {
+        while (queried_hh != queried_heavy_hitters.end() && queried_hh->first < hh.flow) ++queried_hh;
+        if (queried_hh == queried_heavy_hitters.end()) break;
+        if (queried_hh->first == hh.flow) {
+            hh_are_sum += std::abs(static_cast<float>(hh.count) - queried_hh->second) / hh.count;
+            hh_true_positives++;
+        }
+    }
+
+    metrics.hh_are = (hh_true_positives > 0) ? hh_are_sum / hh_true_positives : 0.0f;
+    metrics.hh_precision = (queried_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
+                                                                queried_heavy_hitters.size() : 0.0f;
+    metrics.hh_recall = (truth.heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
+                                                           truth.heavy_hitters.size() : 0.0f;
+    metrics.hh_f1 = (metrics.hh_precision + metrics.hh_recall > 0)
+                    ? 2 * (metrics.hh_precision * metrics.hh_recall) / (metrics.hh_precision + metrics.hh_recall)
+                    : 0.0f;
+
+
+    // --- Quadratic Element Evaluation ---
+
+    float ele_are_sum = 0.0f;
+    uint32_t ele_true_positives = 0;
+    uint32_t total_queried_hot_ele_count = 0; // queried hot quadratic element count
+    uint32_t total_true_hot_ele_count = truth.hot_elements.size(); // true hot quadratic element count
+
+    for (const auto &[flow_id, queried_elements]: queried_quad_elements) {
+        total_queried_hot_ele_count += queried_elements.size();
+    }
+
+    // Merge-join (flow, element) of the truth with the queried maps
+    const auto& hot = truth.hot_elements;
+    auto queried_flow = queried_quad_elements.begin();
+    for (size_t i = 0; i < hot.size();) {
+        uint32_t flow_id = hot[i].flow;
+        size_t flow_end = i;
+        while (flow_end < hot.size() && hot[flow_end].flow == flow_id) ++flow_end;
+
+        while (queried_flow != queried_quad_elements.end() && queried_flow->first < flow_id) ++queried_flow;
+        if (queried_flow != queried_quad_elements.end() && queried_flow->first == flow_id) {
+            const auto& queried_elements = queried_flow->second;
+            auto queried_ele = queried_elements.begin();
+            for (size_t j = i; j < flow_end; ++j) {
+                while (queried_ele != queried_elements.end() && queried_ele->first < hot[j].element) ++queried_ele;
+                if (queried_ele == queried_elements.end()) break;
+                if (queried_ele->first == hot[j].element) {
+                    ele_are_sum += std::abs(static_cast<float>(hot[j].count) - queried_ele->second) / hot[j].count;
+                    ele_true_positives++;
+                }
+            }
+        }
+        i = flow_end;
+    }
+
+    metrics.ele_are = (ele_true_positives > 0) ? ele_are_sum / ele_true_positives : 0.0f;
+    metrics.ele_precision = (total_queried_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
+                                                                total_queried_hot_ele_count : 0.0f;
+    metrics.ele_recall = (total_true_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
+                                                          total_true_hot_ele_count : 0.0f;
+    metrics.ele_f1 = (metrics.ele_precision + metrics.ele_recall > 0)
+                     ? 2 * (metrics.ele_precision * metrics.ele_recall) / (metrics.ele_precision + metrics.ele_recall)
+                     : 0.0f;
+
+    return metrics;
+}
+
+
+std::vector<AccuracyMetrics> Evaluator::score_all(const GroundTruth& truth, const std::vector<RunResult>& runs) {
+    std::vector<std::future<AccuracyMetrics>> pending;
+    pending.reserve(runs.size());
+    for (const auto& run: runs) {
+        pending.push_back(std::async(std::launch::async, [&truth, &run]() {
+            return score(truth, run.answer);
+        }));
+    }
+
+    std::vector<AccuracyMetrics> metrics;
+    metrics.reserve(runs.size());
+    for (auto& m: pending) {
+        metrics.push_back(m.get());
+    }
+    return metrics;
+}
@@ -0,0 +1,212 @@
+#include "header/ExactCounter.h"
+#include "header/utils.h"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <sstream>
+#include <thread>
+
+
+namespace {
+
+unsigned resolve_threads(unsigned num_threads) {
+    if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+    return num_threads == 0 ? 1 : num_threads;
+}
+
+
+// Calls fn(t, begin, end) for the t-th of 'num_threads' contiguous chunks of [0, n).
+// The partition only depends on (n, num_threads), so repeated calls see the same chunks.
+template <typename Fn>
+void parallel_chunks(size_t n, unsigned num_threads, Fn fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (unsigned t = 1; t < num_threads; ++t) {
+        workers.emplace_back(fn, t, n * t / num_threads, n * (t + 1) / num_threads);
+    }
+    fn(0u, size_t{0}, n / num_threads);
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+
+// Parallel LSD radix sort with 8-bit digits. Passes where every key has the
+// same digit (e.g. the high bytes of small IDs) are skipped.
+void radix_sort_u64(std::vector<uint64_t>& keys, unsigned num_threads) {
+    const size_t n = keys.size();
+    std::vector<uint64_t> buffer(n);
+    std::vector<std::array<size_t, 256>> hist(num_threads);
+
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        parallel_chunks(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+            auto& h = hist[t];
+            h.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                h[(keys[i] >> shift) & 0xFF]++;
+            }
+        });
+
+        bool trivial_pass = false;
+        for (unsigned d = 0; d < 256 && !trivial_pass; ++d) {
+            size_t digit_total = 0;
+            for (unsigned t = 0; t < num_threads; ++t) digit_total += hist[t][d];
+            trivial_pass = (digit_total == n);
+        }
+        if (trivial_pass) continue;
+
+        // Exclusive prefix sum in (digit, thread) order keeps the sort stable
+        size_t pos = 0;
+        for (unsigned d = 0; d < 256; ++d) {
+            for (unsigned t = 0; t < num_threads; ++t) {
+                size_t c = hist[t][d];
+                hist[t][d] = pos;
+                pos += c;
+            }
+        }
+
+        parallel_chunks(n, num_threads, [&](unsigned t, size_t begin, size_t end) {
+            auto& offsets = hist[t];
+            for (size_t i = begin; i < end; ++i) {
+                buffer[offsets[(keys[i] >> shift) & 0xFF]++] = keys[i];
+            }
+        });
+        keys.swap(buffer);
+    }
+}
+
+} // namespace
+
+
+ExactCounts count_exact(const std::vector<Record>& records, unsigned num_threads) {
+
+    num_threads = resolve_threads(num_threads);
+    const size_t n = records.size();
+
+    std::vector<uint64_t> keys(n);
+    parallel_chunks(n, num_threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            keys[i] = combine_xy(records[i].first, records[i].second);
+        }
+    });
+
+    radix_sort_u64(keys, num_threads);
+
+    // Run-length encode in parallel; chunk boundaries are moved forward to the
+    // next change of flow so that no flow is split across two threads
+    std::vector<size_t> bounds(num_threads + 1, n);
+    bounds[0] = 0;
+    for (unsigned t = 1; t < num_threads; ++t) {
+        size_t b = std::max(n * t / num_threads, bounds[t - 1]);
+        while (b > 0 && b < n && (keys[b] >> 32) == (keys[b - 1] >> 32)) ++b;
+        bounds[t] = b;
+    }
+
+    std::vector<std::vector<FlowCount>> local_flows(num_threads);
+    std::vector<std::vector<ElementCount>> local_elements(num_threads);
+
+    auto encode = [&](unsigned t) {
+        auto& flows = local_flows[t];
+        auto& elements = local_elements[t];
+        for (size_t i = bounds[t]; i < bounds[t + 1];) {
+            size_t run_end = i + 1;
+            while (run_end < bounds[t + 1] && keys[run_end] == keys[i]) ++run_end;
+
+            auto [x, y] = split_xy(keys[i]);
+            uint32_t count = static_cast<uint32_t>(run_end - i);
+            elements.push_back({x, y, count});
+            if (flows.empty() || flows.back().flow != x) {
+                flows.push_back({x, count});
+            } else {
+                flows.back().count += count;
+            }
+            i = run_end;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < num_threads; ++t) {
+        workers.emplace_back(encode, t);
+    }
+    encode(0);
+    for (auto& worker: workers) {
+        worker.join();
+    }
+
+    ExactCounts counts;
+    counts.total = n;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        counts.flows.insert(counts.flows.end(), local_flows[t].begin(), local_flows[t].end());
+        counts.elements.insert(counts.elements.end(), local_elements[t].begin(), local_elements[t].end());
+    }
+
+    counts.flow_offsets.resize(counts.flows.size() + 1);
+    counts.flow_offsets[0] = 0;
+    uint64_t pos = 0;
+    for (size_t i = 0; i < counts.flows.size(); ++i) {
+        while (pos < counts.elements.size() && counts.elements[pos].flow == counts.flows[i].flow) ++pos;
+        counts.flow_offsets[i + 1] = pos;
+    }
+
+    return counts;
+}
+
+
+std::string verify_exact(const std::vector<Record>& records, const ExactCounts& counts) {
+
+    std::map<uint32_t, uint32_t> true_flow_size;
+    std::map<uint64_t, uint32_t> true_element_size;
+    for (const auto &[x, y]: records) {
+        true_flow_size[x]++;
+        true_element_size[combine_xy(x, y)]++;
+    }
+
+    std::ostringstream diff;
+    if (counts.total != records.size()) {
+        diff << "total " << counts.total << " != " << records.size();
+        return diff.str();
+    }
+    if (counts.flows.size() != true_flow_size.size()) {
+        diff << "unique flows " << counts.flows.size() << " != " << true_flow_size.size();
+        return diff.str();
+    }
+    if (counts.elements.size() != true_element_size.size()) {
+        diff << "unique (flow, element) pairs " << counts.elements.size() << " != " << true_element_size.size();
+        return diff.str();
+    }
+
+    size_t i = 0;
+    for (const auto &[flow, count]: true_flow_size) {
+        const FlowCount& got = counts.flows[i++];
+        if (got.flow != flow || got.count != count) {
+            diff << "flow " << flow << ": expected " << count << ", got flow " << got.flow << " count " << got.count;
+            return diff.str();
+        }
+    }
+
+    i = 0;
+    for (const auto &[key, count]: true_element_size) {
+        const ElementCount& got = counts.elements[i++];
+        if (combine_xy(got.flow, got.element) != key || got.count != count) {
+            auto [x, y] = split_xy(key);
+            diff << "element (" << x << ", " << y << "): expected " << count
+                 << ", got (" << got.flow << ", " << got.element << ") count " << got.count;
+            return diff.str();
+        }
+    }
+
+    for (size_t f = 0; f < counts.flows.size(); ++f) {
+        for (uint64_t e = counts.flow_offsets[f]; e < counts.flow_offsets[f + 1]; ++e) {
+            if (counts.elements[e].flow != counts.flows[f].flow) {
+                diff << "flow_offsets of flow " << counts.flows[f].flow << " point at another flow";
+                return diff.str();
+            }
+        }
+    }
+    if (counts.flow_offsets.back() != counts.elements.size()) {
+        diff << "flow_offsets do not cover all elements";
+        return diff.str();
+    }
+
+    return "";
+}
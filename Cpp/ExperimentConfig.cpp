@@ -0,0 +1,211 @@
+#include "header/ExperimentConfig.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+
+namespace {
+
+template <typename T, typename Convert>
+bool parse_list(const std::string& text, std::vector<T>& values, Convert convert) {
+    std::vector<T> parsed;
+    std::stringstream list(text);
+    for (std::string item; std::getline(list, item, ',');) {
+        if (item.empty()) continue;
+        try {
+            size_t used = 0;
+            T value = convert(item, &used);
+            if (used != item.size()) return false;
+            parsed.push_back(value);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (parsed.empty()) return false;
+    values = std::move(parsed);
+    return true;
+}
+
+bool parse_floats(const std::string& text, std::vector<float>& values) {
+    return parse_list(text, values, [](const std::string& s, size_t* used) { return std::stof(s, used); });
+}
+
+bool parse_count(const std::string& text, uint64_t& value) {
+    std::vector<uint64_t> values;
+    if (!parse_list(text, values, [](const std::string& s, size_t* used) { return std::stoull(s, used); })
+        || values.size() != 1) {
+        return false;
+    }
+    value = values[0];
+    return true;
+}
+
+} // namespace
+
+
+void print_experiment_usage(const char* program) {
+    std::cerr
+            << "usage: " << program << " [options] [file ...]\n"
+            << "\n"
+            << "  --format F         caida|mawi|fimi|synthetic|pcap|bin (default caida)\n"
+            << "  --key SPEC         batch mode: flow/element key of mawi and pcap, e.g. \"flow=src_ip;element=dst_port\"\n"
+            << "  --algorithms LIST  comma-separated subset of DualSketch,DUET,GlobalHH,2D-MG,CSSCHH (default all)\n"
+            << "  --memory LIST      memory sizes in KB (default 100,200,300,400)\n"
+            << "  --phi1 LIST        heavy hitter thresholds as a fraction of N (default 0.0001)\n"
+            << "  --phi2 LIST        hot element thresholds as a fraction of the heavy hitter (default 0.1)\n"
+            << "  --batch N          records per update_batch() call, 0 for update() (default 1024)\n"
+            << "  --threads N        threads for loading and exact counting (default all)\n"
+            << "  --repeat N         runs per configuration, for throughput statistics (default 1)\n"
+            << "  --latency N        batch mode: extra pass per run timing one update in N (1 for all) and\n"
+            << "                     periodic queries; prints p50/p99/p99.9/max, per update case for DualSketch\n"
+            << "  --parallel N       batch mode: run N configurations at once, one per core, 0 for all cores;\n"
+            << "                     throughput is then not interference-free, use it for accuracy sweeps\n"
+            << "  --cores LIST       cores to pin runs to, e.g. 2-7 (default: unpinned when serial, all when parallel)\n"
+            << "  --io B             mmap|uring|pread, how text traces are read (default mmap)\n"
+            << "  --no-cache         neither read nor write <file>.bin caches\n"
+            << "  --verify-cache     use a <file>.bin cache only if a checksum of <file> matches too\n"
+            << "  --stream           read the trace in chunks per run; no ground truth\n"
+            << "  --pipeline         run concurrent read/parse/update stages per run\n"
+            << "    --exact          pipeline: count the ground truth as a stage and score the runs\n"
+            << "    --report S       pipeline: query a sketch snapshot every S seconds\n"
+            << "  --isa LEVEL        baseline|avx2|avx512, sketch kernels to use (default: the widest supported)\n"
+            << "  --json FILE        also write the results, with throughput samples and the environment, as JSON\n"
+            << "  --csv FILE         ... and as CSV, one row per algorithm and setting\n"
+            << "\n"
+            << "Without files, the default files of the format's loader are used." << std::endl;
+}
+
+
+bool parse_experiment_args(int argc, char** argv, ExperimentConfig& config, std::string& error) {
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                error = "missing value for " + arg;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        std::string text;
+
+        if (arg == "--help" || arg == "-h") {
+            error.clear();
+            return false;
+        } else if (arg == "--stream" || arg == "--pipeline") {
+            config.mode = arg == "--stream" ? ExperimentMode::Stream : ExperimentMode::Pipeline;
+            // the earlier form "--stream <format> file ..."
+            if (i + 1 < argc && parse_trace_format(argv[i + 1], config.format)) ++i;
+        } else if (arg == "--exact") {
+            config.exact_count = true;
+        } else if (arg == "--no-cache") {
+            config.use_cache = false;
+        } else if (arg == "--verify-cache") {
+            config.verify_cache = true;
+        } else if (arg == "--format") {
+            if (!value(text)) return false;
+            if (!parse_trace_format(text, config.format)) {
+                error = "unknown format: " + text;
+                return false;
+            }
+        } else if (arg == "--key") {
+            if (!value(text)) return false;
+            if (!parse_key_spec(text, config.key_spec, &error)) return false;
+            config.has_key_spec = true;
+        } else if (arg == "--io") {
+            if (!value(text)) return false;
+            if (!parse_io_backend(text, config.io_backend)) {
+                error = "unknown I/O backend: " + text;
+                return false;
+            }
+        } else if (arg == "--algorithms") {
+            if (!value(text)) return false;
+            config.algorithms.clear();
+            std::stringstream list(text);
+            for (std::string name; std::getline(list, name, ',');) {
+                const Algorithm* algorithm = find_algorithm(name);
+                if (algorithm == nullptr) {
+                    error = "unknown algorithm: " + name;
+                    return false;
+                }
+                config.algorithms.push_back(algorithm);
+            }
+        } else if (arg == "--memory" || arg == "--phi1" || arg == "--phi2") {
+            if (!value(text)) return false;
+            std::vector<float>& values = arg == "--memory" ? config.memory_kb
+                                                           : (arg == "--phi1" ? config.phi_1 : config.phi_2);
+            if (!parse_floats(text, values)) {
+                error = "invalid list for " + arg + ": " + text;
+                return false;
+            }
+        } else if (arg == "--report") {
+            if (!value(text)) return false;
+            std::vector<float> interval;
+            if (!parse_floats(text, interval) || interval.size() != 1) {
+                error = "invalid interval: " + text;
+                return false;
+            }
+            config.report_interval_s = interval[0];
+        } else if (arg == "--isa") {
+            if (!value(text)) return false;
+            if (!parse_isa(text, config.isa)) {
+                error = "unknown ISA level: " + text;
+                return false;
+            }
+            if (!isa_supported(config.isa)) {
+                error = "ISA level not supported by this CPU or build: " + text;
+                return false;
+            }
+            config.has_isa = true;
+        } else if (arg == "--json" || arg == "--csv") {
+            if (!value(text)) return false;
+            (arg == "--json" ? config.json_path : config.csv_path) = text;
+        } else if (arg == "--cores") {
+            if (!value(text)) return false;
+            if (!parse_cpu_list(text, config.cores)) {
+                error = "invalid CPU list: " + text;
+                return false;
+            }
+        } else if (arg == "--batch" || arg == "--threads" || arg == "--repeat" || arg == "--parallel"
+                   || arg == "--latency") {
+            if (!value(text)) return false;
+            uint64_t count = 0;
+            if (!parse_count(text, count)) {
+                error = "invalid number for " + arg + ": " + text;
+                return false;
+            }
+            if (arg == "--batch") config.batch_size = count;
+            else if (arg == "--threads") config.threads = static_cast<unsigned>(count);
+            else if (arg == "--parallel") config.parallel = static_cast<unsigned>(count);
+            else if (arg == "--latency") config.latency_sample = static_cast<uint32_t>(count);
+            else config.repeat = static_cast<unsigned>(std::max<uint64_t>(1, count));
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            error = "unknown option: " + arg;
+            return false;
+        } else {
+            config.files.push_back(arg);
+        }
+    }
+
+    if (config.algorithms.empty()) {
+        for (const auto& algorithm: all_algorithms()) config.algorithms.push_back(&algorithm);
+    }
+    if (config.mode != ExperimentMode::Batch && config.files.empty()) {
+        error = "streaming and pipeline modes need trace files";
+        return false;
+    }
+    if (config.mode != ExperimentMode::Batch && config.parallel != 1) {
+        error = "--parallel applies to batch mode only";
+        return false;
+    }
+    if (config.has_key_spec && !key_spec_applies(config.format)) {
+        error = std::string("--key applies to mawi and pcap input only, not ") + trace_format_name(config.format);
+        return false;
+    }
+    if (config.has_key_spec && config.mode != ExperimentMode::Batch) {
+        error = "--key applies to batch mode only";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,346 @@
+#include "header/Json.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+std::string json_escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c: text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+
+void JsonWriter::newline() {
+    out << '\n' << std::string(2 * has_items.size(), ' ');
+}
+
+
+// before a value: the comma and line break of an item, unless it follows its key
+void JsonWriter::separate() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (has_items.empty()) return;
+    if (has_items.back()) out << ',';
+    newline();
+    has_items.back() = true;
+}
+
+
+JsonWriter& JsonWriter::open(char bracket) {
+    separate();
+    out << bracket;
+    has_items.push_back(false);
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::close(char bracket) {
+    bool items = has_items.back();
+    has_items.pop_back();
+    if (items) newline();
+    out << bracket;
+    if (has_items.empty()) out << '\n';
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    separate();
+    out << '"' << json_escape(name) << "\": ";
+    after_key = true;
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::value(const std::string& text) {
+    separate();
+    out << '"' << json_escape(text) << '"';
+    return *this;
+}
+
+
+// by the exponent bits: the build's -ffast-math lets the compiler assume std::isfinite
+static bool is_finite(double number) {
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return ((bits >> 52) & 0x7FF) != 0x7FF;
+}
+
+
+static void write_number(std::ostream& out, double number, int digits = 10) {
+    if (!is_finite(number)) {
+        out << "null";
+        return;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.*g", digits, number);
+    out << text;
+}
+
+
+JsonWriter& JsonWriter::value(double number) {
+    separate();
+    write_number(out, number);
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::value(float number) {
+    separate();
+    write_number(out, number, 7);
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::value(uint64_t number) {
+    separate();
+    out << number;
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out << (flag ? "true" : "false");
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out << "null";
+    return *this;
+}
+
+
+JsonWriter& JsonWriter::value(const std::vector<double>& numbers) {
+    separate();
+    out << '[';
+    for (size_t i = 0; i < numbers.size(); ++i) {
+        if (i > 0) out << ", ";
+        write_number(out, numbers[i]);
+    }
+    out << ']';
+    return *this;
+}
+
+
+const JsonValue* JsonValue::find(const std::string& name) const {
+    if (type != Type::Object) return nullptr;
+    for (const auto& [member, value]: object) {
+        if (member == name) return &value;
+    }
+    return nullptr;
+}
+
+
+double JsonValue::number_or(const std::string& name, double fallback) const {
+    const JsonValue* member = find(name);
+    return member != nullptr && member->type == Type::Number ? member->number : fallback;
+}
+
+
+std::string JsonValue::string_or(const std::string& name, const std::string& fallback) const {
+    const JsonValue* member = find(name);
+    return member != nullptr && member->type == Type::String ? member->string : fallback;
+}
+
+
+namespace {
+
+// Recursive descent over the whole text; result files are small.
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text(text) {}
+
+    bool parse(JsonValue& value, std::string& error) {
+        bool ok = parse_value(value, 0) && (skip_space(), pos == text.size() || fail("trailing characters"));
+        if (!ok) error = message + " at offset " + std::to_string(pos);
+        return ok;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 64;
+
+    const std::string& text;
+    size_t pos = 0;
+    std::string message;
+
+    bool fail(const char* what) {
+        if (message.empty()) message = what;
+        return false;
+    }
+
+    void skip_space() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) {
+            pos++;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t n = std::char_traits<char>::length(literal);
+        if (text.compare(pos, n, literal) != 0) return false;
+        pos += n;
+        return true;
+    }
+
+    bool parse_value(JsonValue& value, int depth) {
+        if (depth > MAX_DEPTH) return fail("nesting too deep");
+        skip_space();
+        if (pos >= text.size()) return fail("unexpected end");
+        char c = text[pos];
+        if (c == '{') return parse_object(value, depth);
+        if (c == '[') return parse_array(value, depth);
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return parse_string(value.string);
+        }
+        if (consume("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (consume("false")) {
+            value.type = JsonValue::Type::Bool;
+            return true;
+        }
+        if (consume("null")) return true;
+        return parse_number(value);
+    }
+
+    bool parse_number(JsonValue& value) {
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        value.number = std::strtod(start, &end);
+        if (end == start) return fail("unexpected character");
+        value.type = JsonValue::Type::Number;
+        pos += end - start;
+        return true;
+    }
+
+    static void append_utf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parse_string(std::string& out) {
+        pos++;  // opening quote
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char escape = text[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) return fail("bad \\u escape");
+                    append_utf8(out, static_cast<uint32_t>(std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16)));
+                    pos += 4;
+                    break;
+                }
+                default: return fail("bad escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parse_array(JsonValue& value, int depth) {
+        value.type = JsonValue::Type::Array;
+        pos++;
+        skip_space();
+        if (pos < text.size() && text[pos] == ']') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            value.array.emplace_back();
+            if (!parse_value(value.array.back(), depth + 1)) return false;
+            skip_space();
+            if (pos < text.size() && text[pos] == ',') {
+                pos++;
+            } else if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return true;
+            } else {
+                return fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    bool parse_object(JsonValue& value, int depth) {
+        value.type = JsonValue::Type::Object;
+        pos++;
+        skip_space();
+        if (pos < text.size() && text[pos] == '}') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            skip_space();
+            if (pos >= text.size() || text[pos] != '"') return fail("expected a key");
+            std::string name;
+            if (!parse_string(name)) return false;
+            skip_space();
+            if (pos >= text.size() || text[pos] != ':') return fail("expected ':'");
+            pos++;
+            value.object.emplace_back(std::move(name), JsonValue());
+            if (!parse_value(value.object.back().second, depth + 1)) return false;
+            skip_space();
+            if (pos < text.size() && text[pos] == ',') {
+                pos++;
+            } else if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return true;
+            } else {
+                return fail("expected ',' or '}'");
+            }
+        }
+    }
+};
+
+} // namespace
+
+
+bool parse_json(const std::string& text, JsonValue& value, std::string& error) {
+    value = JsonValue();
+    return JsonParser(text).parse(value, error);
+}
@@ -0,0 +1,193 @@
+#include "header/KeySpec.h"
+#include "header/MurmurHash3.h"
+#include "header/TextParse.h"
+#include <cctype>
+
+
+namespace {
+
+const char* const FIELD_NAMES[FIELD_COUNT] = {
+        "src_ip", "dst_ip", "protocol", "src_port", "dst_port", "timestamp", "length", "ttl", "flags",
+};
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+bool fail(std::string* error, const std::string& message) {
+    if (error != nullptr) *error = message;
+    return false;
+}
+
+// "a+b+c" -> fields
+bool parse_field_list(const std::string& text, std::vector<Field>& fields, std::string* error) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        size_t plus = text.find('+', start);
+        std::string name = trim(text.substr(start, plus == std::string::npos ? std::string::npos : plus - start));
+        Field field;
+        if (!parse_field_name(name, field)) return fail(error, "unknown field '" + name + "'");
+        fields.push_back(field);
+        if (plus == std::string::npos) break;
+        start = plus + 1;
+    }
+    return true;
+}
+
+// decimal, 0x-hex, dotted quad or a protocol name in any case, as in the protocol column
+bool parse_operand(const std::string& text, uint64_t& value) {
+    std::string name = text;
+    for (char& c: name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (name == "tcp") { value = 6; return true; }
+    if (name == "udp") { value = 17; return true; }
+    if (name == "icmp") { value = 1; return true; }
+    if (name == "icmpv6") { value = 58; return true; }
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    uint32_t ip = 0;
+    if (text.find('.') != std::string::npos) {
+        if (!parse_ipv4(p, end, ip)) return false;
+        value = ip;
+        return true;
+    }
+    if (text.empty()) return false;
+    size_t used = 0;
+    try {
+        value = std::stoull(text, &used, 0);
+    } catch (...) {
+        return false;
+    }
+    return used == text.size();
+}
+
+uint32_t make_key(const std::vector<Field>& fields, const FieldValues& values) {
+    if (fields.size() == 1) return static_cast<uint32_t>(values[fields[0]]);
+
+    uint64_t packed[FIELD_COUNT];
+    for (size_t i = 0; i < fields.size(); ++i) packed[i] = values[fields[i]];
+    uint32_t key = 0;
+    MurmurHash3_x86_32(packed, static_cast<int>(fields.size() * sizeof(uint64_t)), 0, &key);
+    return key != 0 ? key : 1;
+}
+
+} // namespace
+
+
+const char* field_name(Field field) {
+    return FIELD_NAMES[static_cast<size_t>(field)];
+}
+
+
+bool parse_field_name(const std::string& name, Field& field) {
+    for (size_t i = 0; i < FIELD_COUNT; ++i) {
+        if (name == FIELD_NAMES[i]) {
+            field = static_cast<Field>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+uint32_t KeySpec::used_fields() const {
+    uint32_t mask = 0;
+    for (Field f: flow) mask |= 1u << static_cast<uint32_t>(f);
+    for (Field f: element) mask |= 1u << static_cast<uint32_t>(f);
+    for (const auto& filter: filters) mask |= 1u << static_cast<uint32_t>(filter.field);
+    return mask;
+}
+
+
+bool KeySpec::accepts(const FieldValues& values) const {
+    for (const auto& filter: filters) {
+        uint64_t v = values[filter.field];
+        bool pass = false;
+        switch (filter.op) {
+            case FieldFilter::Op::Eq: pass = v == filter.operand; break;
+            case FieldFilter::Op::Ne: pass = v != filter.operand; break;
+            case FieldFilter::Op::Lt: pass = v < filter.operand; break;
+            case FieldFilter::Op::Le: pass = v <= filter.operand; break;
+            case FieldFilter::Op::Gt: pass = v > filter.operand; break;
+            case FieldFilter::Op::Ge: pass = v >= filter.operand; break;
+        }
+        if (!pass) return false;
+    }
+    return true;
+}
+
+
+bool KeySpec::project(const FieldValues& values, std::vector<Record>& out) const {
+    if (!accepts(values)) return false;
+
+    uint32_t x = make_key(flow, values);
+    uint32_t y = make_key(element, values);
+    if (x == 0 || y == 0) return false;
+
+    out.emplace_back(x, y);
+    return true;
+}
+
+
+bool parse_key_spec(const std::string& text, KeySpec& spec, std::string* error) {
+    spec = KeySpec{};
+
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t semi = text.find(';', start);
+        std::string clause = trim(text.substr(start, semi == std::string::npos ? std::string::npos : semi - start));
+        start = (semi == std::string::npos) ? text.size() + 1 : semi + 1;
+        if (clause.empty()) continue;
+
+        if (clause.compare(0, 5, "flow=") == 0) {
+            if (!parse_field_list(clause.substr(5), spec.flow, error)) return false;
+            continue;
+        }
+        if (clause.compare(0, 8, "element=") == 0) {
+            if (!parse_field_list(clause.substr(8), spec.element, error)) return false;
+            continue;
+        }
+
+        // filter: <field><op><value>, two-character operators first
+        static const struct { const char* text; FieldFilter::Op op; } ops[] = {
+                {"==", FieldFilter::Op::Eq}, {"!=", FieldFilter::Op::Ne},
+                {"<=", FieldFilter::Op::Le}, {">=", FieldFilter::Op::Ge},
+                {"<", FieldFilter::Op::Lt}, {">", FieldFilter::Op::Gt},
+                {"=", FieldFilter::Op::Eq},
+        };
+        size_t pos = std::string::npos;
+        FieldFilter filter{};
+        size_t op_len = 0;
+        for (const auto& op: ops) {
+            pos = clause.find(op.text);
+            if (pos != std::string::npos) {
+                filter.op = op.op;
+                op_len = std::char_traits<char>::length(op.text);
+                break;
+            }
+        }
+        if (pos == std::string::npos) return fail(error, "cannot parse clause '" + clause + "'");
+
+        std::string name = trim(clause.substr(0, pos));
+        std::string operand = trim(clause.substr(pos + op_len));
+        if (!parse_field_name(name, filter.field)) return fail(error, "unknown field '" + name + "'");
+        if (!parse_operand(operand, filter.operand)) return fail(error, "bad value '" + operand + "'");
+        spec.filters.push_back(filter);
+    }
+
+    if (spec.flow.empty()) return fail(error, "missing flow=...");
+    if (spec.element.empty()) return fail(error, "missing element=...");
+    return true;
+}
+
+
+KeySpec default_key_spec() {
+    KeySpec spec;
+    spec.flow = {Field::SrcIp};
+    spec.element = {Field::DstIp};
+    return spec;
+}
@@ -0,0 +1,65 @@
+#include "header/LatencyRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+
+double latency_ticks_per_ns() {
+    static const double ticks_per_ns = []() {
+#if defined(__x86_64__) || defined(__i386__)
+        auto start = std::chrono::steady_clock::now();
+        uint64_t start_ticks = latency_ticks_begin();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t end_ticks = latency_ticks_end();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        return ns > 0 ? (end_ticks - start_ticks) / ns : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return ticks_per_ns;
+}
+
+
+uint64_t latency_tick_overhead() {
+    static const uint64_t overhead = []() {
+        std::vector<uint64_t> samples(1 << 14);
+        for (auto& sample: samples) {
+            uint64_t start = latency_ticks_begin();
+            sample = latency_ticks_end() - start;
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        return samples[samples.size() / 2];
+    }();
+    return overhead;
+}
+
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+    total += other.total;
+    max_value = std::max(max_value, other.max_value);
+}
+
+
+uint64_t LatencyHistogram::value_at(double q) const {
+    if (total == 0) return 0;
+    auto rank = static_cast<uint64_t>(q * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen < rank) continue;
+        if (i < (1u << SUB_BITS)) return i;
+        unsigned shift = static_cast<unsigned>(i >> SUB_BITS) - 1;
+        uint64_t lower = ((1ull << SUB_BITS) + (i & ((1u << SUB_BITS) - 1))) << shift;
+        return std::min<uint64_t>(lower + ((1ull << shift) - 1) / 2, max_value);
+    }
+    return max_value;
+}
+
+
+LatencyStats LatencyHistogram::stats() const {
+    double scale = 1.0 / latency_ticks_per_ns();
+    return {total, value_at(0.5) * scale, value_at(0.99) * scale, value_at(0.999) * scale, max_value * scale};
+}
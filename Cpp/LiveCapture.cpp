@@ -0,0 +1,162 @@
+#include "header/LiveCapture.h"
+#include "header/PcapReader.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+namespace {
+
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+
+} // namespace
+
+
+LiveCapture::~LiveCapture() {
+    close();
+}
+
+
+void LiveCapture::close() {
+    if (ring != nullptr) munmap(ring, ring_bytes);
+    if (fd >= 0) ::close(fd);
+    ring = nullptr;
+    ring_bytes = 0;
+    fd = -1;
+}
+
+
+bool LiveCapture::open(const LiveCaptureConfig& config, std::string* error) {
+    close();
+    counters = Stats{};
+    next_index = 0;
+
+    auto fail = [&](const char* what) {
+        if (error != nullptr) *error = std::string(what) + ": " + std::strerror(errno);
+        close();
+        return false;
+    };
+
+    unsigned ifindex = if_nametoindex(config.interface.c_str());
+    if (ifindex == 0) return fail("unknown interface");
+
+    fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (fd < 0) return fail("socket(AF_PACKET)");
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+        return fail("PACKET_VERSION");
+    }
+
+    tpacket_req3 req{};
+    req.tp_block_size = config.block_size;
+    req.tp_block_nr = config.block_count;
+    req.tp_frame_size = config.frame_size;
+    req.tp_frame_nr = (config.block_size / config.frame_size) * config.block_count;
+    req.tp_retire_blk_tov = config.block_timeout_ms;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+        return fail("PACKET_RX_RING");
+    }
+
+    ring_bytes = static_cast<size_t>(config.block_size) * config.block_count;
+    void* mapped = mmap(nullptr, ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        ring = nullptr;
+        return fail("mmap ring");
+    }
+    ring = static_cast<uint8_t*>(mapped);
+    block_size = config.block_size;
+    block_count = config.block_count;
+
+    // Ethernet-like devices (including lo) deliver an Ethernet header, tun-like ones bare IP
+    ifreq ifr{};
+    std::strncpy(ifr.ifr_name, config.interface.c_str(), IFNAMSIZ - 1);
+    linktype = LINKTYPE_ETHERNET;
+    if (ioctl(fd, SIOCGIFHWADDR, &ifr) == 0 && ifr.ifr_hwaddr.sa_family == ARPHRD_NONE) {
+        linktype = LINKTYPE_RAW;
+    }
+
+    sockaddr_ll addr{};
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = static_cast<int>(ifindex);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        return fail("bind");
+    }
+
+    if (config.fanout_group >= 0) {
+        int fanout = (config.fanout_group & 0xffff) | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+        if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) != 0) {
+            return fail("PACKET_FANOUT");
+        }
+    }
+    return true;
+}
+
+
+int LiveCapture::next_block(const KeySpec& spec, std::vector<Record>& out, int timeout_ms) {
+    auto* block = reinterpret_cast<tpacket_block_desc*>(ring + static_cast<size_t>(next_index) * block_size);
+
+    if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+        pollfd pfd{fd, POLLIN | POLLERR, 0};
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0) return errno == EINTR ? 0 : -1;
+        if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const uint32_t used = spec.used_fields();
+    const uint32_t num_packets = block->hdr.bh1.num_pkts;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt;
+    FieldValues values;
+    uint32_t missing;
+
+    for (uint32_t i = 0; i < num_packets; ++i) {
+        const auto* header = reinterpret_cast<const tpacket3_hdr*>(p);
+        const uint8_t* data = p + header->tp_mac;
+
+        counters.bytes += header->tp_len;
+        values = FieldValues{};
+        if (decode_packet(linktype, data, header->tp_snaplen, values, missing)) {
+            counters.decoded++;
+            values[Field::Timestamp] = static_cast<uint64_t>(header->tp_sec) * 1000000000u + header->tp_nsec;
+            if ((used & missing) == 0) spec.project(values, out);
+        }
+        p += header->tp_next_offset;
+    }
+
+    // hand the block back to the kernel
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    next_index = (next_index + 1) % block_count;
+
+    auto block_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    counters.blocks++;
+    counters.packets += num_packets;
+    counters.block_ns_total += block_ns;
+    counters.block_ns_max = std::max(counters.block_ns_max, block_ns);
+    return static_cast<int>(num_packets);
+}
+
+
+void LiveCapture::update_kernel_stats() {
+    tpacket_stats_v3 st{};
+    socklen_t len = sizeof(st);
+    if (fd >= 0 && getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) == 0) {
+        counters.kernel_packets += st.tp_packets;
+        counters.kernel_drops += st.tp_drops;
+        counters.freeze_count += st.tp_freeze_q_cnt;
+    }
+}
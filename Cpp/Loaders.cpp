@@ -0,0 +1,833 @@
+#include "header/Loaders.h"
+#include "header/BlockReader.h"
+#include "header/BoundedQueue.h"
+#include "header/CsvProjection.h"
+#include "header/MappedFile.h"
+#include "header/MurmurHash3.h"
+#include "header/PcapReader.h"
+#include "header/TextParse.h"
+#include "header/TraceFile.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+
+
+namespace {
+
+// Files below this size are parsed on the calling thread
+constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// Threads for parsing and exact counting, 0 for all hardware threads
+unsigned loader_threads = 0;
+
+unsigned worker_threads() {
+    return loader_threads != 0 ? loader_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/*
+ * Maps 'file_path' and parses it line by line, in parallel for large files.
+ * The file is split at line boundaries into chunks that worker threads take in turn;
+ * each chunk is parsed into its own vectors and the vectors are appended to 'outputs'
+ * in file order, so the record order is the same as a sequential read.
+ *
+ * parse_line(begin, end, offset, outs) gets one line without its '\n' and the
+ * line's byte offset in the file, appends to any of outs[0, outputs.size()), and
+ * returns false if the line is rejected. Returns false if the file cannot be opened.
+ */
+template <typename ParseLine>
+bool parse_file_multi(const std::string &file_path, bool skip_header, const ParseLine &parse_line,
+                      std::vector<std::vector<Record>> &outputs, uint64_t &skipped_lines) {
+
+    MappedFile file;
+    if (!file.open(file_path)) return false;
+    file.advise_sequential();
+
+    const char *begin = file.data();
+    const char *end = begin + file.size();
+    if (skip_header && begin != end) {
+        begin = find_line_end(begin, end);
+        if (begin != end) ++begin;
+    }
+    size_t size = static_cast<size_t>(end - begin);
+
+    unsigned num_threads = worker_threads();
+    size_t parts = std::max<size_t>(1, std::min<size_t>(num_threads * 4, size / MIN_CHUNK_BYTES));
+    std::vector<size_t> bounds = split_at_lines(begin, size, parts);
+    size_t num_chunks = bounds.size() - 1;
+    size_t num_outputs = outputs.size();
+
+    std::vector<std::vector<std::vector<Record>>> chunks(num_chunks);
+    std::vector<uint64_t> chunk_skipped(num_chunks, 0);
+    std::atomic<size_t> next_chunk{0};
+
+    auto worker = [&]() {
+        for (size_t c = next_chunk++; c < num_chunks; c = next_chunk++) {
+            const char *p = begin + bounds[c];
+            const char *chunk_end = begin + bounds[c + 1];
+            auto &outs = chunks[c];
+            outs.resize(num_outputs);
+            for (auto &out: outs) out.reserve((chunk_end - p) / 16);
+            while (p < chunk_end) {
+                const char *line_end = find_line_end(p, chunk_end);
+                if (!parse_line(p, line_end, static_cast<uint64_t>(p - file.data()), outs.data())) {
+                    chunk_skipped[c]++;
+                }
+                p = line_end + 1;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::min<size_t>(num_threads, num_chunks); ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &w: workers) {
+        w.join();
+    }
+
+    for (size_t o = 0; o < num_outputs; ++o) {
+        size_t total = outputs[o].size();
+        for (const auto &chunk: chunks) total += chunk[o].size();
+        outputs[o].reserve(total);
+        for (const auto &chunk: chunks) {
+            outputs[o].insert(outputs[o].end(), chunk[o].begin(), chunk[o].end());
+        }
+    }
+    for (uint64_t skipped: chunk_skipped) skipped_lines += skipped;
+    return true;
+}
+
+
+// parse_file_multi() for a parser with one output: parse_line(begin, end, offset, out)
+template <typename ParseLine>
+bool parse_file(const std::string &file_path, bool skip_header, const ParseLine &parse_line,
+                std::vector<Record> &data, uint64_t &skipped_lines) {
+    std::vector<std::vector<Record>> outputs(1);
+    outputs[0] = std::move(data);
+    bool ok = parse_file_multi(file_path, skip_header,
+                               [&](const char *p, const char *end, uint64_t offset, std::vector<Record> *outs) {
+                                   return parse_line(p, end, offset, outs[0]);
+                               }, outputs, skipped_lines);
+    data = std::move(outputs[0]);
+    return ok;
+}
+
+
+// Line parsers of the text formats: (begin, end, offset, out) -> accepted
+
+// "source_ip dest_ip ..." as dotted quads
+bool parse_caida_line(const char *p, const char *end, uint64_t, std::vector<Record> &out) {
+    const char *src_begin = skip_blanks(p, end);
+    const char *src_end = skip_token(src_begin, end);
+    const char *dst_begin = skip_blanks(src_end, end);
+    const char *dst_end = skip_token(dst_begin, end);
+
+    uint32_t src_ip_int = 0, dst_ip_int = 0;
+    if (!parse_ipv4(src_begin, src_end, src_ip_int)) return false;
+    if (!parse_ipv4(dst_begin, dst_end, dst_ip_int)) return false;
+
+    if (src_ip_int == 0 || dst_ip_int == 0) return false;
+
+    out.emplace_back(src_ip_int, dst_ip_int);
+    return true;
+}
+
+// "src_ip,dst_ip,..."
+bool parse_mawi_line(const char *p, const char *end, uint64_t, std::vector<Record> &out) {
+    // Assumes field order is: src_ip,dst_ip,...
+    const char *src_end = static_cast<const char *>(std::memchr(p, ',', end - p));
+    if (src_end == nullptr) return false;
+    const char *dst_begin = src_end + 1;
+    const char *dst_end = static_cast<const char *>(std::memchr(dst_begin, ',', end - dst_begin));
+    if (dst_end == nullptr) dst_end = end;
+    if (dst_end > dst_begin && dst_end[-1] == '\r') --dst_end;
+
+    uint32_t src_ip = 0, dst_ip = 0;
+    if (!parse_ipv4(p, src_end, src_ip)) return false;
+    if (!parse_ipv4(dst_begin, dst_end, dst_ip)) return false;
+
+    if (src_ip == 0 || dst_ip == 0) return false;
+
+    out.emplace_back(src_ip, dst_ip);
+    return true;
+}
+
+// "item item ..."; single-item lines get a flow derived from the line offset
+bool parse_fimi_line(const char *p, const char *end, uint64_t offset, std::vector<Record> &out) {
+    const char *first_begin = skip_blanks(p, end);
+    const char *first_end = skip_token(first_begin, end);
+    const char *second_begin = skip_blanks(first_end, end);
+    const char *second_end = skip_token(second_begin, end);
+
+    uint32_t first = 0, second = 0;
+    if (!parse_u32(first_begin, first_end, first)) return false;
+
+    uint32_t flow_id, ele_id;
+    if (parse_u32(second_begin, second_end, second)) {
+        flow_id = first + 1;
+        ele_id = second + 1;
+    } else {
+        uint32_t hash_val = 0;
+        MurmurHash3_x86_32(&offset, sizeof(offset), 0, &hash_val);
+        flow_id = (hash_val % 32767) + 1 + 1;
+        ele_id = first + 1;
+    }
+
+    if (flow_id == 0 || ele_id == 0) return false;
+
+    out.emplace_back(flow_id, ele_id);
+    return true;
+}
+
+// "flow element" as unsigned integers, the Zipf ranks (>= 1) themselves, as HH_GenZipf writes them
+bool parse_synthetic_line(const char *p, const char *end, uint64_t, std::vector<Record> &out) {
+    const char *key_begin = skip_blanks(p, end);
+    const char *key_end = skip_token(key_begin, end);
+    const char *ele_begin = skip_blanks(key_end, end);
+    const char *ele_end = skip_token(ele_begin, end);
+
+    uint32_t key_int = 0, ele_int = 0;
+    if (!parse_u32(key_begin, key_end, key_int)) return false;
+    if (!parse_u32(ele_begin, ele_end, ele_int)) return false;
+
+    if (key_int == 0 || ele_int == 0) return false;
+
+    out.emplace_back(key_int, ele_int);
+    return true;
+}
+
+
+// Appends the records of a whole capture; packets without an IP header count as skipped
+bool read_capture(const std::string &file_path, const KeySpec &spec, std::vector<Record> &records,
+                  uint64_t &skipped_packets) {
+    PcapReader reader;
+    std::string error;
+    if (!reader.open(file_path, &error)) {
+        std::cerr << file_path << ": " << error << std::endl;
+        return false;
+    }
+    while (reader.read_batch(spec, records, SIZE_MAX) > 0) {}
+    skipped_packets += reader.stats().non_ip;
+    return true;
+}
+
+
+/*
+ * Parses text files through a BlockReader (io_uring or pread) instead of mmap. This thread
+ * cuts the blocks into line-aligned pieces (LineSplitter), which are parsed by worker
+ * threads that give the blocks back; the pieces' records are concatenated per file in order.
+ */
+void parse_files_blocks(const std::vector<std::string> &file_paths, TraceFormat format, bool use_io_uring,
+                        std::vector<std::vector<Record>> &records, std::vector<char> &parsed,
+                        uint64_t &skipped_lines) {
+
+    struct Piece {
+        const char *begin;
+        const char *end;
+        uint64_t offset;            // file offset of begin
+        std::vector<Record> *out;
+        Block block;
+    };
+
+    BlockReaderConfig config;
+    config.use_io_uring = use_io_uring;
+    BlockReader reader(config);
+    reader.open(file_paths);
+
+    const LineParser parse_line = line_parser(format);
+    const bool skip_header = has_header_line(format);
+    const unsigned num_workers = worker_threads();
+
+    size_t num_files = file_paths.size();
+    std::vector<std::deque<std::vector<Record>>> pieces(num_files);
+    BoundedQueue<Piece> queue(num_workers * 2);
+    std::atomic<uint64_t> skipped{0};
+
+    auto worker = [&]() {
+        Piece piece;
+        while (queue.pop(piece)) {
+            uint64_t piece_skipped = 0;
+            piece.out->reserve((piece.end - piece.begin) / 16);
+            for (const char *p = piece.begin; p < piece.end;) {
+                const char *line_end = find_line_end(p, piece.end);
+                if (!parse_line(p, line_end, piece.offset + static_cast<uint64_t>(p - piece.begin), *piece.out)) {
+                    piece_skipped++;
+                }
+                p = line_end + 1;
+            }
+            skipped += piece_skipped;
+            reader.release(piece.block);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < num_workers; ++t) {
+        workers.emplace_back(worker);
+    }
+
+    LineSplitter splitter(reader, config.headroom, skip_header);
+    LinePiece line_piece;
+    while (splitter.next(line_piece)) {
+        pieces[line_piece.block.file].emplace_back();
+        queue.push(Piece{line_piece.begin, line_piece.end, line_piece.offset,
+                         &pieces[line_piece.block.file].back(), line_piece.block});
+    }
+    queue.close();
+    for (auto &w: workers) {
+        w.join();
+    }
+
+    if (reader.error() != 0) {
+        std::cerr << "Read error: " << std::strerror(reader.error()) << std::endl;
+    }
+    records.assign(num_files, {});
+    parsed.assign(num_files, 0);
+    for (size_t f = 0; f < num_files; ++f) {
+        parsed[f] = reader.is_open(static_cast<uint32_t>(f)) && reader.error() == 0;
+        size_t total = 0;
+        for (const auto &piece: pieces[f]) total += piece.size();
+        records[f].reserve(total);
+        for (const auto &piece: pieces[f]) records[f].insert(records[f].end(), piece.begin(), piece.end());
+    }
+    skipped_lines += skipped + splitter.dropped_lines();
+}
+
+
+bool use_trace_cache = true;
+bool verify_trace_cache = false;
+IoBackend io_backend = IoBackend::Mmap;
+
+
+/*
+ * Loads the source files in order, appending to 'data', and returns which files loaded.
+ * A valid "<file>.bin" cache next to a text source is read instead of the text; the other
+ * files are parsed (through the selected I/O backend) and their caches (re)written for
+ * the next run.
+ */
+std::vector<char> load_sources(const std::vector<std::string> &file_paths, TraceFormat format,
+                               std::vector<Record> &data, uint64_t &skipped_lines) {
+
+    size_t num_files = file_paths.size();
+    std::vector<char> loaded(num_files, 0);
+    std::vector<char> cached(num_files, 0);
+    std::vector<std::string> to_parse;
+    for (size_t f = 0; f < num_files; ++f) {
+        cached[f] = format == TraceFormat::Binary || (use_trace_cache && trace_cache_current(file_paths[f], format));
+        if (!cached[f]) to_parse.push_back(file_paths[f]);
+    }
+
+    std::vector<std::vector<Record>> parsed_records;
+    std::vector<char> parsed;
+    if (format != TraceFormat::Pcap && format != TraceFormat::Binary && io_backend != IoBackend::Mmap) {
+        parse_files_blocks(to_parse, format, io_backend == IoBackend::IoUring, parsed_records, parsed, skipped_lines);
+    } else {
+        parsed_records.resize(to_parse.size());
+        parsed.resize(to_parse.size());
+        for (size_t i = 0; i < to_parse.size(); ++i) {
+            parsed[i] = parse_trace_file(to_parse[i], format, parsed_records[i], skipped_lines);
+        }
+    }
+
+    for (size_t f = 0, i = 0; f < num_files; ++f) {
+        const std::string &file_path = file_paths[f];
+        if (cached[f]) {
+            const std::string path = format == TraceFormat::Binary ? file_path : trace_cache_path(file_path);
+            loaded[f] = read_trace(path, data);
+            continue;
+        }
+
+        std::vector<Record> &records = parsed_records[i];
+        loaded[f] = parsed[i++];
+        if (!loaded[f]) continue;
+
+        if (use_trace_cache) {
+            std::string cache_path = trace_cache_path(file_path);
+            TraceHeader source{};
+            source.source_format = trace_format_id(format);
+            source.parser_version = trace_parser_version(format);
+            if (!describe_source(file_path, source, true) || !write_trace(cache_path, records, &source)) {
+                std::cerr << "Could not write trace cache: " << cache_path << std::endl;
+            }
+        }
+
+        if (data.empty()) {
+            data = std::move(records);
+        } else {
+            data.insert(data.end(), records.begin(), records.end());
+        }
+        std::vector<Record>().swap(records);
+    }
+    return loaded;
+}
+
+
+void report_skipped(uint64_t skipped_lines, const char *what = "invalid or empty lines") {
+    if (skipped_lines > 0) {
+        std::cout << "Skipped " << skipped_lines << " " << what << "." << std::endl;
+    }
+}
+
+} // namespace
+
+
+std::string trace_cache_path(const std::string &source_path) {
+    return source_path + ".bin";
+}
+
+
+void set_trace_cache_enabled(bool enabled) {
+    use_trace_cache = enabled;
+}
+
+
+bool trace_cache_enabled() {
+    return use_trace_cache;
+}
+
+
+void set_trace_cache_verify(bool verify) {
+    verify_trace_cache = verify;
+}
+
+
+uint16_t trace_format_id(TraceFormat format) {
+    return static_cast<uint16_t>(format) + 1;
+}
+
+
+// Text formats 2: the block reader no longer parses the remainder of a line longer than its headroom.
+// Synthetic 3: the keys are the ranks, no longer shifted by 1.
+uint32_t trace_parser_version(TraceFormat format) {
+    switch (format) {
+        case TraceFormat::CAIDA: return 2;
+        case TraceFormat::MAWI: return 2;
+        case TraceFormat::FIMI: return 2;
+        case TraceFormat::Synthetic: return 3;
+        case TraceFormat::Pcap: return 1;
+        case TraceFormat::Binary: return 0;
+    }
+    return 0;
+}
+
+
+bool trace_cache_current(const std::string &source_path, TraceFormat format) {
+    return trace_cache_valid(trace_cache_path(source_path), source_path, trace_format_id(format),
+                             trace_parser_version(format), verify_trace_cache);
+}
+
+
+void set_io_backend(IoBackend backend) {
+    io_backend = backend;
+}
+
+
+void set_loader_threads(unsigned num_threads) {
+    loader_threads = num_threads;
+}
+
+
+bool parse_io_backend(const std::string &name, IoBackend &backend) {
+    if (name == "mmap") backend = IoBackend::Mmap;
+    else if (name == "uring") backend = IoBackend::IoUring;
+    else if (name == "pread") backend = IoBackend::Pread;
+    else return false;
+    return true;
+}
+
+
+const char* trace_format_name(TraceFormat format) {
+    switch (format) {
+        case TraceFormat::CAIDA: return "caida";
+        case TraceFormat::MAWI: return "mawi";
+        case TraceFormat::FIMI: return "fimi";
+        case TraceFormat::Synthetic: return "synthetic";
+        case TraceFormat::Pcap: return "pcap";
+        case TraceFormat::Binary: return "bin";
+    }
+    return "?";
+}
+
+
+bool parse_trace_files(const std::vector<std::string> &file_paths, TraceFormat format, IoBackend backend,
+                       std::vector<Record> &records, uint64_t &skipped_lines) {
+    bool all_parsed = true;
+    if (format == TraceFormat::Pcap || format == TraceFormat::Binary || backend == IoBackend::Mmap) {
+        for (const auto &file_path: file_paths) {
+            all_parsed &= parse_trace_file(file_path, format, records, skipped_lines);
+        }
+        return all_parsed;
+    }
+
+    std::vector<std::vector<Record>> per_file;
+    std::vector<char> parsed;
+    parse_files_blocks(file_paths, format, backend == IoBackend::IoUring, per_file, parsed, skipped_lines);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        all_parsed &= parsed[f] != 0;
+        records.insert(records.end(), per_file[f].begin(), per_file[f].end());
+    }
+    return all_parsed;
+}
+
+
+LineParser line_parser(TraceFormat format) {
+    switch (format) {
+        case TraceFormat::CAIDA: return parse_caida_line;
+        case TraceFormat::MAWI: return parse_mawi_line;
+        case TraceFormat::FIMI: return parse_fimi_line;
+        case TraceFormat::Synthetic: return parse_synthetic_line;
+        case TraceFormat::Pcap:
+        case TraceFormat::Binary: break;
+    }
+    return nullptr;
+}
+
+
+bool has_header_line(TraceFormat format) {
+    return format == TraceFormat::MAWI;
+}
+
+
+bool parse_trace_format(const std::string &name, TraceFormat &format) {
+    if (name == "caida") format = TraceFormat::CAIDA;
+    else if (name == "mawi") format = TraceFormat::MAWI;
+    else if (name == "fimi") format = TraceFormat::FIMI;
+    else if (name == "synthetic") format = TraceFormat::Synthetic;
+    else if (name == "pcap") format = TraceFormat::Pcap;
+    else if (name == "bin") format = TraceFormat::Binary;
+    else return false;
+    return true;
+}
+
+
+bool parse_trace_file(const std::string &file_path, TraceFormat format,
+                      std::vector<Record> &records, uint64_t &skipped_lines) {
+    switch (format) {
+        case TraceFormat::CAIDA:
+            return parse_file(file_path, false, parse_caida_line, records, skipped_lines);
+        case TraceFormat::MAWI:
+            return parse_file(file_path, true, parse_mawi_line, records, skipped_lines);
+        case TraceFormat::FIMI:
+            return parse_file(file_path, false, parse_fimi_line, records, skipped_lines);
+        case TraceFormat::Synthetic:
+            return parse_file(file_path, false, parse_synthetic_line, records, skipped_lines);
+        case TraceFormat::Pcap:
+            return read_capture(file_path, default_key_spec(), records, skipped_lines);
+        case TraceFormat::Binary:
+            return read_trace(file_path, records);
+    }
+    return false;
+}
+
+
+/**
+ * @brief Loads the CAIDA 2019 dataset from the given files.
+ * Each line holds "source_ip dest_ip" as dotted quads; other fields after them are ignored.
+ * @return A tuple containing two collections:
+ * 1. std::vector<Record>: The raw dataset of (source_ip, dest_ip) pairs.
+ * 2. ExactCounts: The true count for each flow (source IP) and for each element (dest IP)
+ * within each flow, as sorted arrays.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetCAIDA(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_lines = 0;
+
+    std::vector<char> loaded = load_sources(file_paths, TraceFormat::CAIDA, data, skipped_lines);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Failed to open file: " << file_paths[f] << std::endl;
+            continue;
+        }
+
+        std::cout << file_paths[f] << " is loaded." << std::endl;
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_lines);
+    std::cout << file_paths.size() << " data loaded.\n"
+              << "Totaling packets: " << data.size()
+              << ", Unique flows (src_ip as flow label): " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads the MAWI dataset from the given files.
+ * Each file starts with a CSV header, followed by lines "src_ip,dst_ip,...".
+ * @return A tuple containing two collections:
+ * 1. std::vector<Record>: The raw dataset of (source_ip, dest_ip) pairs.
+ * 2. ExactCounts: The true count for each flow (source IP) and for each element (dest IP)
+ * within each flow, as sorted arrays.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetMAWI(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_lines = 0;
+
+    std::vector<std::string> non_empty;
+    for (const auto &file_path: file_paths) {
+        MappedFile probe;
+        if (probe.open(file_path) && probe.size() == 0) {
+            std::cerr << "Empty file: " << file_path << std::endl;
+            continue;
+        }
+        non_empty.push_back(file_path);
+    }
+
+    std::vector<char> loaded = load_sources(non_empty, TraceFormat::MAWI, data, skipped_lines);
+    for (size_t f = 0; f < non_empty.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Failed to open file: " << non_empty[f] << std::endl;
+            continue;
+        }
+
+        std::cout << "Loaded file: " << non_empty[f] << std::endl;
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_lines);
+    std::cout << "Total data: " << data.size();
+    std::cout << ", Unique flows (src_ip as flow ID): " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Reads the MAWI files once and projects every line through each key spec.
+ * Column positions are taken from each file's header line, so only the columns the
+ * specs read need to be present, in any order.
+ * @return One record vector per spec, in the order of 'specs'.
+ */
+std::vector<std::vector<Record>> projectDataSetMAWI(const std::vector<std::string> &file_paths,
+                                                    const std::vector<KeySpec> &specs) {
+
+    std::vector<std::vector<Record>> outputs(specs.size());
+    uint64_t skipped_lines = 0;
+
+    for (const auto &file_path: file_paths) {
+        MappedFile probe;
+        if (!probe.open(file_path)) {
+            std::cerr << "Failed to open file: " << file_path << std::endl;
+            continue;
+        }
+        if (probe.size() == 0) {
+            std::cerr << "Empty file: " << file_path << std::endl;
+            continue;
+        }
+
+        CsvProjection projection;
+        std::string error;
+        const char *header_end = find_line_end(probe.data(), probe.data() + probe.size());
+        if (!projection.compile(probe.data(), header_end, specs, &error)) {
+            std::cerr << "Cannot project " << file_path << ": " << error << std::endl;
+            continue;
+        }
+
+        auto parse_line = [&projection](const char *p, const char *end, uint64_t, std::vector<Record> *outs) {
+            return projection.parse_line(p, end, outs);
+        };
+        if (!parse_file_multi(file_path, true, parse_line, outputs, skipped_lines)) {
+            std::cerr << "Failed to open file: " << file_path << std::endl;
+            continue;
+        }
+
+        std::cout << "Loaded file: " << file_path << std::endl;
+    }
+
+    report_skipped(skipped_lines);
+    return outputs;
+}
+
+
+/**
+ * @brief Loads the MAWI dataset with the (flow, element) key given by 'spec'
+ * instead of (src_ip, dst_ip). Projected loads are not cached.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetMAWI(const std::vector<std::string> &file_paths,
+                                                             const KeySpec &spec) {
+
+    std::vector<Record> data = std::move(projectDataSetMAWI(file_paths, {spec})[0]);
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    std::cout << "Total data: " << data.size();
+    std::cout << ", Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads transactions from the Frequent Itemset Mining Dataset Repository.
+ * The first two items of a transaction form (flow, element), both shifted by 1.
+ * A single-item transaction gets a pseudo-random flow in [2, 32768], derived from
+ * the line's byte offset so that the result does not depend on the thread count
+ * and a cached conversion of the file gives the same records.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDatasetFreqItemMining(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_lines = 0;
+
+    std::vector<char> loaded = load_sources(file_paths, TraceFormat::FIMI, data, skipped_lines);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Failed to open file: " << file_paths[f] << std::endl;
+        }
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_lines);
+    std::cout << "All data is loaded, totaling data: " << data.size() << std::endl;
+    std::cout << "Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads the synthetic Zipf dataset written by genSyntheticDataset.py.
+ * Each line holds "flow element" as unsigned integers: the Zipf ranks, used as the keys
+ * unchanged, as in the binary traces of HH_GenZipf.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadSyntheticDataset(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_lines = 0;
+
+    std::vector<char> loaded = load_sources(file_paths, TraceFormat::Synthetic, data, skipped_lines);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Failed to open file: " << file_paths[f] << '\n';
+            continue;
+        }
+        std::cout << file_paths[f] << " is loaded.\n";
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_lines);
+    std::cout << file_paths.size() << " files data loaded.\n"
+              << "Totaling: " << data.size()
+              << ", Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads packet captures (classic pcap or pcapng), keyed by (source IP, dest IP).
+ * The keys are read straight from the packet headers; see PcapReader.h.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetPcap(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_packets = 0;
+
+    std::vector<char> loaded = load_sources(file_paths, TraceFormat::Pcap, data, skipped_packets);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Failed to read capture: " << file_paths[f] << std::endl;
+            continue;
+        }
+        std::cout << file_paths[f] << " is loaded." << std::endl;
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_packets, "non-IP packets");
+    std::cout << "Totaling packets: " << data.size()
+              << ", Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads packet captures with the (flow, element) key given by 'spec'.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetPcap(const std::vector<std::string> &file_paths,
+                                                             const KeySpec &spec) {
+
+    std::vector<Record> data;
+    uint64_t skipped_packets = 0;
+
+    for (const auto &file_path: file_paths) {
+        if (!read_capture(file_path, spec, data, skipped_packets)) {
+            std::cerr << "Failed to read capture: " << file_path << std::endl;
+            continue;
+        }
+        std::cout << file_path << " is loaded." << std::endl;
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    report_skipped(skipped_packets, "non-IP packets");
+    std::cout << "Totaling packets: " << data.size()
+              << ", Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+/**
+ * @brief Loads binary traces (see TraceFile.h), e.g. written by HH_TraceConvert or HH_GenZipf.
+ */
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetBinary(const std::vector<std::string> &file_paths) {
+
+    std::vector<Record> data;
+    uint64_t skipped_lines = 0;
+
+    std::vector<char> loaded = load_sources(file_paths, TraceFormat::Binary, data, skipped_lines);
+    for (size_t f = 0; f < file_paths.size(); ++f) {
+        if (!loaded[f]) {
+            std::cerr << "Not a valid trace: " << file_paths[f] << std::endl;
+            continue;
+        }
+        std::cout << file_paths[f] << " is loaded." << std::endl;
+    }
+
+    ExactCounts counts = count_exact(data, loader_threads);
+
+    std::cout << file_paths.size() << " files data loaded.\n"
+              << "Totaling: " << data.size()
+              << ", Unique flows: " << counts.flows.size() << std::endl;
+
+    return std::make_tuple(std::move(data), std::move(counts));
+}
+
+
+std::tuple<std::vector<Record>, ExactCounts> loadDataSet(const std::vector<std::string> &file_paths,
+                                                         TraceFormat format) {
+    switch (format) {
+        case TraceFormat::CAIDA: return loadDataSetCAIDA(file_paths);
+        case TraceFormat::MAWI: return loadDataSetMAWI(file_paths);
+        case TraceFormat::FIMI: return loadDatasetFreqItemMining(file_paths);
+        case TraceFormat::Synthetic: return loadSyntheticDataset(file_paths);
+        case TraceFormat::Pcap: return loadDataSetPcap(file_paths);
+        case TraceFormat::Binary: return loadDataSetBinary(file_paths);
+    }
+    return {};
+}
+
+
+bool key_spec_applies(TraceFormat format) {
+    return format == TraceFormat::MAWI || format == TraceFormat::Pcap;
+}
+
+
+std::tuple<std::vector<Record>, ExactCounts> loadDataSet(const std::vector<std::string> &file_paths,
+                                                         TraceFormat format, const KeySpec &spec) {
+    if (format == TraceFormat::MAWI) return loadDataSetMAWI(file_paths, spec);
+    if (format == TraceFormat::Pcap) return loadDataSetPcap(file_paths, spec);
+    std::cerr << "Key specs apply to mawi and pcap input only, not " << trace_format_name(format) << "." << std::endl;
+    return {};
+}
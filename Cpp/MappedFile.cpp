@@ -0,0 +1,69 @@
+#include "header/MappedFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) return true;
+
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    bytes = static_cast<const char*>(mapped);
+    return true;
+}
+
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    bytes = nullptr;
+    length = 0;
+    fd = -1;
+}
+
+
+void MappedFile::advise_sequential() const {
+    if (bytes != nullptr) {
+        madvise(const_cast<char*>(bytes), length, MADV_SEQUENTIAL);
+    }
+}
+
+
+void MappedFile::release(size_t offset, size_t len) const {
+    if (bytes == nullptr || offset >= length) return;
+    len = std::min(len, length - offset);
+
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = (offset + len) / page * page;
+    if (end > begin) {
+        madvise(const_cast<char*>(bytes) + begin, end - begin, MADV_DONTNEED);
+    }
+}
@@ -8,6 +8,7 @@
 // non-native version will be less than optimal.
 
 #include "./header/MurmurHash3.h"
+#include "./header/SketchKernels.h"
 
 //-----------------------------------------------------------------------------
 // Platform-specific functions and macros
@@ -149,6 +150,16 @@ void MurmurHash3_x86_32 ( const void * key, int len,
   *(uint32_t*)out = h1;
 } 
 
+//-----------------------------------------------------------------------------
+// Many 4-byte keys at once. The vector bodies need their instruction set enabled, so
+// they live in the per-level kernels; this picks the level the CPU supports.
+
+void MurmurHash3_x86_32_keys ( const uint32_t * keys, size_t count,
+                               uint32_t seed, uint32_t * out )
+{
+  sketch_kernels().hash_u32(keys, count, seed, out);
+}
+
 //-----------------------------------------------------------------------------
 
 void MurmurHash3_x86_128 ( const void * key, const int len,
@@ -0,0 +1,402 @@
+#include "header/PcapReader.h"
+#include "header/MurmurHash3.h"
+#include <cstring>
+
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+constexpr uint32_t PCAPNG_SHB = 0x0a0d0d0a;
+constexpr uint32_t PCAPNG_BYTE_ORDER = 0x1a2b3c4d;
+
+constexpr uint32_t PCAPNG_IDB = 1;
+constexpr uint32_t PCAPNG_PB = 2;
+constexpr uint32_t PCAPNG_SPB = 3;
+constexpr uint32_t PCAPNG_EPB = 6;
+
+constexpr uint32_t LINKTYPE_NULL = 0;
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr uint32_t LINKTYPE_IPV6 = 229;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+constexpr uint32_t DLT_RAW_12 = 12;  // DLT_RAW on most BSDs
+constexpr uint32_t DLT_RAW_14 = 14;  // DLT_RAW on OpenBSD
+
+// Mapped parts of the capture are dropped in steps of this size
+constexpr size_t RELEASE_BYTES = 64 << 20;
+
+inline uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+           | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t fold_ipv6(const uint8_t* addr) {
+    uint32_t key = 0;
+    MurmurHash3_x86_32(addr, 16, 0, &key);
+    return key;
+}
+
+inline uint32_t field_bit(Field f) {
+    return 1u << static_cast<uint32_t>(f);
+}
+
+constexpr uint32_t L4_FIELDS = (1u << static_cast<uint32_t>(Field::SrcPort))
+                               | (1u << static_cast<uint32_t>(Field::DstPort))
+                               | (1u << static_cast<uint32_t>(Field::Flags));
+
+
+// TCP/UDP/SCTP ports and TCP flags at 'l4'; 'len' bytes are captured
+void decode_l4(uint8_t protocol, const uint8_t* l4, size_t len, FieldValues& values, uint32_t& missing) {
+    if ((protocol == 6 || protocol == 17 || protocol == 132) && len >= 4) {
+        values[Field::SrcPort] = be16(l4);
+        values[Field::DstPort] = be16(l4 + 2);
+        missing &= ~(field_bit(Field::SrcPort) | field_bit(Field::DstPort));
+    }
+    if (protocol == 6 && len >= 14) {
+        values[Field::Flags] = l4[13];
+        missing &= ~field_bit(Field::Flags);
+    }
+}
+
+
+bool decode_ipv4(const uint8_t* ip, size_t len, FieldValues& values, uint32_t& missing) {
+    if (len < 20) return false;
+    size_t ihl = static_cast<size_t>(ip[0] & 0x0f) * 4;
+    if (ihl < 20) return false;
+
+    values[Field::SrcIp] = be32(ip + 12);
+    values[Field::DstIp] = be32(ip + 16);
+    values[Field::Protocol] = ip[9];
+    values[Field::Ttl] = ip[8];
+    values[Field::Length] = be16(ip + 2);
+
+    bool first_fragment = (be16(ip + 6) & 0x1fff) == 0;
+    if (first_fragment && len > ihl) decode_l4(ip[9], ip + ihl, len - ihl, values, missing);
+    return true;
+}
+
+
+bool decode_ipv6(const uint8_t* ip, size_t len, FieldValues& values, uint32_t& missing) {
+    if (len < 40) return false;
+
+    values[Field::SrcIp] = fold_ipv6(ip + 8);
+    values[Field::DstIp] = fold_ipv6(ip + 24);
+    values[Field::Ttl] = ip[7];
+    values[Field::Length] = static_cast<uint64_t>(be16(ip + 4)) + 40;
+
+    // walk the extension headers to the transport header
+    uint8_t next = ip[6];
+    size_t off = 40;
+    for (int hops = 0; hops < 8; ++hops) {
+        if (next == 0 || next == 43 || next == 60) {          // hop-by-hop, routing, destination options
+            if (len < off + 2) break;
+            uint8_t after = ip[off];
+            off += (static_cast<size_t>(ip[off + 1]) + 1) * 8;
+            next = after;
+        } else if (next == 44) {                               // fragment
+            if (len < off + 8) break;
+            uint8_t after = ip[off];
+            bool first_fragment = (be16(ip + off + 2) & 0xfff8) == 0;
+            off += 8;
+            next = after;
+            if (!first_fragment) {
+                values[Field::Protocol] = next;
+                return true;
+            }
+        } else if (next == 51) {                               // authentication header
+            if (len < off + 2) break;
+            uint8_t after = ip[off];
+            off += (static_cast<size_t>(ip[off + 1]) + 2) * 4;
+            next = after;
+        } else {
+            break;
+        }
+    }
+    values[Field::Protocol] = next;
+    if (len > off) decode_l4(next, ip + off, len - off, values, missing);
+    return true;
+}
+
+
+bool decode_ip(const uint8_t* ip, size_t len, FieldValues& values, uint32_t& missing) {
+    if (len < 1) return false;
+    switch (ip[0] >> 4) {
+        case 4: return decode_ipv4(ip, len, values, missing);
+        case 6: return decode_ipv6(ip, len, values, missing);
+        default: return false;
+    }
+}
+
+
+bool decode_ethertype(uint16_t ethertype, const uint8_t* ip, size_t len, FieldValues& values, uint32_t& missing) {
+    if (ethertype == 0x0800) return decode_ipv4(ip, len, values, missing);
+    if (ethertype == 0x86dd) return decode_ipv6(ip, len, values, missing);
+    return false;
+}
+
+
+// 10^-exp or 2^-exp second units to nanoseconds
+uint64_t units_to_ns(uint64_t units, bool pow2, uint8_t exp) {
+    if (pow2) return static_cast<uint64_t>((static_cast<unsigned __int128>(units) * 1000000000u) >> exp);
+    static const uint64_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+                                     10000000000ULL, 100000000000ULL, 1000000000000ULL};
+    if (exp <= 9) return units * pow10[9 - exp];
+    if (exp <= 21) return units / pow10[exp - 9];
+    return 0;
+}
+
+} // namespace
+
+
+bool decode_packet(uint32_t linktype, const uint8_t* data, uint32_t caplen, FieldValues& values, uint32_t& missing) {
+    missing = L4_FIELDS;
+
+    switch (linktype) {
+        case LINKTYPE_ETHERNET: {
+            if (caplen < 14) return false;
+            size_t off = 12;
+            uint16_t ethertype = be16(data + off);
+            // 802.1Q, 802.1ad and the old QinQ tag, possibly stacked
+            while ((ethertype == 0x8100 || ethertype == 0x88a8 || ethertype == 0x9100) && caplen >= off + 6) {
+                off += 4;
+                ethertype = be16(data + off);
+            }
+            off += 2;
+            return decode_ethertype(ethertype, data + off, caplen - off, values, missing);
+        }
+        case LINKTYPE_RAW:
+        case DLT_RAW_12:
+        case DLT_RAW_14:
+            return decode_ip(data, caplen, values, missing);
+        case LINKTYPE_IPV4:
+            return decode_ipv4(data, caplen, values, missing);
+        case LINKTYPE_IPV6:
+            return decode_ipv6(data, caplen, values, missing);
+        case LINKTYPE_LINUX_SLL:
+            if (caplen < 16) return false;
+            return decode_ethertype(be16(data + 14), data + 16, caplen - 16, values, missing);
+        case LINKTYPE_LINUX_SLL2:
+            if (caplen < 20) return false;
+            return decode_ethertype(be16(data), data + 20, caplen - 20, values, missing);
+        case LINKTYPE_NULL: {
+            // address family in the byte order of the capturing host
+            if (caplen < 4) return false;
+            uint32_t family = load32(data);
+            if (family > 0xffff) family = __builtin_bswap32(family);
+            if (family == 2) return decode_ipv4(data + 4, caplen - 4, values, missing);
+            if (family == 24 || family == 28 || family == 30) return decode_ipv6(data + 4, caplen - 4, values, missing);
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+
+uint16_t PcapReader::rd16(const uint8_t* p) const {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return swapped ? __builtin_bswap16(v) : v;
+}
+
+
+uint32_t PcapReader::rd32(const uint8_t* p) const {
+    uint32_t v = load32(p);
+    return swapped ? __builtin_bswap32(v) : v;
+}
+
+
+bool PcapReader::open(const std::string& path, std::string* error) {
+    auto fail = [&](const char* message) {
+        if (error != nullptr) *error = message;
+        file.close();
+        return false;
+    };
+
+    if (!file.open(path)) return fail("cannot open file");
+    file.advise_sequential();
+    begin = reinterpret_cast<const uint8_t*>(file.data());
+    end = begin + file.size();
+    released = 0;
+    counters = Stats{};
+    interfaces.clear();
+
+    if (file.size() < 24) return fail("file too short for a capture");
+
+    uint32_t magic = load32(begin);
+    if (magic == PCAPNG_SHB) {
+        // the section header block is parsed by next_pcapng_packet()
+        pcapng = true;
+        uint32_t order = load32(begin + 8);
+        if (order != PCAPNG_BYTE_ORDER && order != __builtin_bswap32(PCAPNG_BYTE_ORDER)) {
+            return fail("bad pcapng byte-order magic");
+        }
+        swapped = order != PCAPNG_BYTE_ORDER;
+        cursor = begin;
+        return true;
+    }
+
+    pcapng = false;
+    bool nanosecond;
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+        swapped = false;
+        nanosecond = magic == PCAP_MAGIC_NS;
+    } else if (magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS)) {
+        swapped = true;
+        nanosecond = magic == __builtin_bswap32(PCAP_MAGIC_NS);
+    } else {
+        return fail("not a pcap or pcapng file");
+    }
+
+    // the upper bits of the link type field carry FCS information
+    interfaces.push_back({rd32(begin + 20) & 0xffff, false, static_cast<uint8_t>(nanosecond ? 9 : 6)});
+    cursor = begin + 24;
+    return true;
+}
+
+
+bool PcapReader::next_pcap_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                                  uint64_t& timestamp_ns, const Interface*& iface) {
+    if (end - cursor < 16) return false;
+    uint32_t ts_sec = rd32(cursor);
+    uint32_t ts_frac = rd32(cursor + 4);
+    caplen = rd32(cursor + 8);
+    origlen = rd32(cursor + 12);
+    if (static_cast<size_t>(end - cursor - 16) < caplen) return false;  // truncated capture
+
+    iface = &interfaces[0];
+    timestamp_ns = static_cast<uint64_t>(ts_sec) * 1000000000u + units_to_ns(ts_frac, false, iface->ts_exp);
+    data = cursor + 16;
+    cursor += 16 + static_cast<size_t>(caplen);
+    return true;
+}
+
+
+bool PcapReader::next_pcapng_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                                    uint64_t& timestamp_ns, const Interface*& iface) {
+    while (end - cursor >= 12) {
+        uint32_t type = load32(cursor);
+        if (type == PCAPNG_SHB) {
+            // a new section may change the byte order and restarts the interface list
+            uint32_t order = load32(cursor + 8);
+            if (order != PCAPNG_BYTE_ORDER && order != __builtin_bswap32(PCAPNG_BYTE_ORDER)) return false;
+            swapped = order != PCAPNG_BYTE_ORDER;
+            interfaces.clear();
+        }
+        type = rd32(cursor);
+        uint32_t block_len = rd32(cursor + 4);
+        if (block_len < 12 || (block_len & 3) != 0 || static_cast<size_t>(end - cursor) < block_len) return false;
+
+        const uint8_t* body = cursor + 8;
+        size_t body_len = block_len - 12;
+        cursor += block_len;
+
+        if (type == PCAPNG_IDB) {
+            if (body_len < 8) return false;
+            Interface idb{rd16(body), false, 6};
+            // options: code, length, value padded to 4 bytes; if_tsresol is code 9
+            for (size_t off = 8; off + 4 <= body_len;) {
+                uint16_t code = rd16(body + off);
+                uint16_t len = rd16(body + off + 2);
+                if (code == 0 || off + 4 + len > body_len) break;
+                if (code == 9 && len >= 1) {
+                    idb.ts_pow2 = (body[off + 4] & 0x80) != 0;
+                    idb.ts_exp = body[off + 4] & 0x7f;
+                }
+                off += 4 + ((static_cast<size_t>(len) + 3) & ~static_cast<size_t>(3));
+            }
+            interfaces.push_back(idb);
+        } else if (type == PCAPNG_EPB || type == PCAPNG_PB) {
+            if (body_len < 20) return false;
+            uint32_t id = (type == PCAPNG_EPB) ? rd32(body) : rd16(body);
+            if (id >= interfaces.size()) return false;
+            iface = &interfaces[id];
+            uint64_t units = (static_cast<uint64_t>(rd32(body + 4)) << 32) | rd32(body + 8);
+            caplen = rd32(body + 12);
+            origlen = rd32(body + 16);
+            if (caplen > body_len - 20) return false;
+            timestamp_ns = units_to_ns(units, iface->ts_pow2, iface->ts_exp);
+            data = body + 20;
+            return true;
+        } else if (type == PCAPNG_SPB) {
+            if (body_len < 4 || interfaces.empty()) return false;
+            iface = &interfaces[0];
+            origlen = rd32(body);
+            caplen = std::min<uint32_t>(origlen, static_cast<uint32_t>(body_len - 4));
+            timestamp_ns = 0;
+            data = body + 4;
+            return true;
+        }
+        // other blocks (name resolution, statistics, custom, ...) are skipped
+    }
+    return false;
+}
+
+
+bool PcapReader::next_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                             uint64_t& timestamp_ns, const Interface*& iface) {
+    if (cursor == nullptr) return false;
+    return pcapng ? next_pcapng_packet(data, caplen, origlen, timestamp_ns, iface)
+                  : next_pcap_packet(data, caplen, origlen, timestamp_ns, iface);
+}
+
+
+void PcapReader::release_consumed() {
+    size_t consumed = static_cast<size_t>(cursor - begin);
+    if (consumed - released >= RELEASE_BYTES) {
+        file.release(released, consumed - released);
+        released = consumed;
+    }
+}
+
+
+bool PcapReader::next(FieldValues& values, uint32_t& missing) {
+    const uint8_t* data;
+    uint32_t caplen, origlen;
+    uint64_t timestamp_ns;
+    const Interface* iface;
+
+    while (next_packet(data, caplen, origlen, timestamp_ns, iface)) {
+        counters.packets++;
+        values = FieldValues{};
+        if (decode_packet(iface->linktype, data, caplen, values, missing)) {
+            values[Field::Timestamp] = timestamp_ns;
+            counters.decoded++;
+            return true;
+        }
+        counters.non_ip++;
+    }
+    return false;
+}
+
+
+size_t PcapReader::read_batch(const KeySpec& spec, std::vector<Record>& out, size_t max_records, TraceExtras* extras) {
+    const uint32_t used = spec.used_fields();
+    size_t appended = 0;
+    FieldValues values;
+    uint32_t missing;
+
+    while (appended < max_records && next(values, missing)) {
+        if ((used & missing) != 0 || !spec.project(values, out)) continue;
+        if (extras != nullptr) {
+            extras->timestamps.push_back(values[Field::Timestamp]);
+            extras->weights.push_back(static_cast<uint32_t>(values[Field::Length]));
+        }
+        ++appended;
+    }
+    release_consumed();
+    return appended;
+}
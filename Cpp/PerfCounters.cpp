@@ -0,0 +1,122 @@
+#include "header/PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace {
+
+uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+void event_attr(PerfEvent event, perf_event_attr& attr) {
+    switch (event) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1dMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::LlcMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                      PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::PageFaults:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+    }
+}
+
+} // namespace
+
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instr";
+        case PerfEvent::L1dMisses: return "L1d miss";
+        case PerfEvent::LlcMisses: return "LLC miss";
+        case PerfEvent::DtlbMisses: return "dTLB miss";
+        case PerfEvent::BranchMisses: return "br miss";
+        case PerfEvent::PageFaults: return "faults";
+    }
+    return "?";
+}
+
+
+PerfCounters::PerfCounters() {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        event_attr(static_cast<PerfEvent>(i), attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // this thread, any CPU, no group
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0 && error.empty()) {
+            error = std::string(perf_event_name(static_cast<PerfEvent>(i))) + ": " + std::strerror(errno);
+            if (errno == ENOENT || errno == EOPNOTSUPP) error += " (no PMU, e.g. in a virtual machine)";
+            if (errno == EACCES || errno == EPERM) error += " (see /proc/sys/kernel/perf_event_paranoid)";
+        }
+    }
+}
+
+
+PerfCounters::~PerfCounters() {
+    for (int fd: fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+
+void PerfCounters::start() {
+    for (int fd: fds) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    }
+    for (int fd: fds) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+
+PerfSample PerfCounters::stop() {
+    for (int fd: fds) {
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    PerfSample sample;
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (fds[i] < 0) continue;
+        uint64_t data[3] = {0, 0, 0};  // value, time_enabled, time_running
+        if (read(fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+        if (data[2] == 0) continue;    // never scheduled on the PMU
+        sample.values[i] = data[2] < data[1] ? static_cast<double>(data[0]) * data[1] / data[2] : data[0];
+        sample.valid[i] = true;
+    }
+    return sample;
+}
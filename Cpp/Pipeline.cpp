@@ -0,0 +1,313 @@
+#include "header/Pipeline.h"
+#include "header/BlockReader.h"
+#include "header/TextParse.h"
+#include "header/TraceStream.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+
+StageStats StageCounters::stats() const {
+    return {name, batches, records, bytes, busy_ns / 1e9, input_wait_ns / 1e9, output_wait_ns / 1e9};
+}
+
+
+BatchChannel::BatchChannel(size_t depth, size_t batch_records) : full(depth), empty(depth + 2) {
+    for (size_t i = 0; i < depth + 2; ++i) {
+        std::vector<Record> batch;
+        batch.reserve(batch_records);
+        empty.push(std::move(batch));
+    }
+}
+
+
+bool BatchChannel::acquire(std::vector<Record>& batch, StageCounters& counters) {
+    uint64_t start = pipeline_clock_ns();
+    bool ok = empty.pop(batch);
+    counters.output_wait_ns += pipeline_clock_ns() - start;
+    batch.clear();
+    return ok;
+}
+
+
+bool BatchChannel::send(std::vector<Record>& batch, StageCounters& counters) {
+    counters.batches++;
+    counters.records += batch.size();
+    uint64_t start = pipeline_clock_ns();
+    bool ok = full.push(std::move(batch));
+    counters.output_wait_ns += pipeline_clock_ns() - start;
+    return ok;
+}
+
+
+bool BatchChannel::receive(std::vector<Record>& batch, StageCounters& counters) {
+    if (batch.capacity() > 0) {
+        batch.clear();
+        empty.try_push(batch);
+    }
+    uint64_t start = pipeline_clock_ns();
+    bool ok = full.pop(batch);
+    counters.input_wait_ns += pipeline_clock_ns() - start;
+    return ok;
+}
+
+
+void BatchChannel::abort() {
+    full.close();
+    empty.close();
+}
+
+
+struct IngestStages::State {
+    std::vector<std::string> file_paths;
+    TraceFormat format;
+    PipelineConfig config;
+
+    BatchChannel channel;
+    StageCounters read_counters{"read"};
+    StageCounters parse_counters{"parse"};
+    std::thread read_thread;
+    std::thread parse_thread;
+    uint64_t skipped = 0;
+
+    // text traces only
+    BlockReaderConfig reader_config;
+    BlockReader reader;
+    SpscQueue<LinePiece> pieces;
+
+    State(const std::vector<std::string>& file_paths, TraceFormat format, const PipelineConfig& config)
+            : file_paths(file_paths), format(format), config(config),
+              channel(config.queue_depth, config.batch_records),
+              reader_config(make_reader_config(config)), reader(reader_config),
+              pieces(config.queue_depth) {}
+
+    static BlockReaderConfig make_reader_config(const PipelineConfig& config) {
+        BlockReaderConfig reader_config;
+        reader_config.use_io_uring = config.use_io_uring;
+        // blocks queued for the parser plus blocks in flight
+        reader_config.buffers = static_cast<unsigned>(config.queue_depth) + reader_config.queue_depth + 2;
+        return reader_config;
+    }
+
+    bool is_text() const {
+        return format != TraceFormat::Binary && format != TraceFormat::Pcap;
+    }
+
+    void read_blocks();
+    void parse_pieces();
+    void read_records();
+};
+
+
+// read stage of text traces: line-aligned blocks
+void IngestStages::State::read_blocks() {
+    reader.open(file_paths);
+    LineSplitter splitter(reader, reader_config.headroom, has_header_line(format));
+    LinePiece piece;
+    while (true) {
+        uint64_t busy_start = pipeline_clock_ns();
+        bool more = splitter.next(piece);
+        read_counters.busy_ns += pipeline_clock_ns() - busy_start;
+        if (!more) break;
+
+        read_counters.batches++;
+        read_counters.bytes += piece.end - piece.begin;
+        uint64_t wait_start = pipeline_clock_ns();
+        bool pushed = pieces.push(piece);
+        read_counters.output_wait_ns += pipeline_clock_ns() - wait_start;
+        if (!pushed) {
+            reader.release(piece.block);
+            break;
+        }
+    }
+    skipped += splitter.dropped_lines();
+    pieces.close();
+}
+
+
+// parse stage of text traces
+void IngestStages::State::parse_pieces() {
+    const LineParser parse_line = line_parser(format);
+    std::vector<Record> batch;
+    bool open = channel.acquire(batch, parse_counters);
+
+    LinePiece piece;
+    while (open) {
+        uint64_t wait_start = pipeline_clock_ns();
+        bool more = pieces.pop(piece);
+        parse_counters.input_wait_ns += pipeline_clock_ns() - wait_start;
+        if (!more) break;
+
+        uint64_t busy_start = pipeline_clock_ns();
+        uint64_t output_wait_before = parse_counters.output_wait_ns;
+        for (const char* p = piece.begin; p < piece.end && open;) {
+            const char* line_end = find_line_end(p, piece.end);
+            if (!parse_line(p, line_end, piece.offset + static_cast<uint64_t>(p - piece.begin), batch)) skipped++;
+            p = line_end + 1;
+            if (batch.size() >= config.batch_records) {
+                open = channel.send(batch, parse_counters) && channel.acquire(batch, parse_counters);
+            }
+        }
+        parse_counters.bytes += piece.end - piece.begin;
+        reader.release(piece.block);
+        parse_counters.busy_ns += pipeline_clock_ns() - busy_start - (parse_counters.output_wait_ns - output_wait_before);
+    }
+
+    // drain what the reader may still hand over after an early stop
+    if (!open) {
+        pieces.close();
+        while (pieces.pop(piece)) reader.release(piece.block);
+    }
+    if (open && !batch.empty()) channel.send(batch, parse_counters);
+    channel.close();
+}
+
+
+// the single read + parse stage of binary traces and captures
+void IngestStages::State::read_records() {
+    StreamConfig stream_config;
+    stream_config.chunk_records = config.batch_records;
+    stream_config.queue_depth = 2;
+    TraceStream stream(file_paths, format, stream_config);
+
+    std::vector<Record> chunk;
+    std::vector<Record> batch;
+    while (true) {
+        uint64_t busy_start = pipeline_clock_ns();
+        bool more = stream.next(chunk);
+        read_counters.busy_ns += pipeline_clock_ns() - busy_start;
+        if (!more) break;
+
+        if (!channel.acquire(batch, read_counters)) break;
+        batch.assign(chunk.begin(), chunk.end());
+        if (!channel.send(batch, read_counters)) break;
+    }
+    read_counters.bytes = stream.bytes();
+    skipped = stream.skipped();
+    channel.close();
+}
+
+
+IngestStages::IngestStages(const std::vector<std::string>& file_paths, TraceFormat format,
+                           const PipelineConfig& config)
+        : state(new State(file_paths, format, config)) {
+    if (state->is_text()) {
+        state->read_thread = std::thread(&State::read_blocks, state.get());
+        state->parse_thread = std::thread(&State::parse_pieces, state.get());
+    } else {
+        state->read_counters.name = "read+parse";
+        state->read_thread = std::thread(&State::read_records, state.get());
+    }
+}
+
+
+IngestStages::~IngestStages() {
+    state->channel.abort();
+    if (state->parse_thread.joinable()) state->parse_thread.join();
+    if (state->read_thread.joinable()) state->read_thread.join();
+}
+
+
+BatchChannel& IngestStages::output() {
+    return state->channel;
+}
+
+
+void IngestStages::finish(PipelineReport& report) {
+    if (state->parse_thread.joinable()) state->parse_thread.join();
+    if (state->read_thread.joinable()) state->read_thread.join();
+
+    report.skipped += state->skipped;
+    report.stages.push_back(state->read_counters.stats());
+    if (state->is_text()) {
+        report.queues.push_back(queue_stats("read->parse", state->pieces));
+        report.stages.push_back(state->parse_counters.stats());
+        report.queues.push_back(state->channel.stats("parse->next"));
+    } else {
+        report.queues.push_back(state->channel.stats("read->next"));
+    }
+}
+
+
+CountStage::CountStage(BatchChannel& input, const PipelineConfig& config)
+        : input(input), channel(config.queue_depth, config.batch_records) {
+    thread = std::thread(&CountStage::run, this);
+}
+
+
+CountStage::~CountStage() {
+    channel.abort();
+    input.abort();
+    if (thread.joinable()) thread.join();
+}
+
+
+void CountStage::run() {
+    std::vector<Record> records;
+    std::vector<Record> batch;
+    std::vector<Record> forward;
+    bool open = true;
+    while (input.receive(batch, counters)) {
+        uint64_t busy_start = pipeline_clock_ns();
+        records.insert(records.end(), batch.begin(), batch.end());
+        counters.busy_ns += pipeline_clock_ns() - busy_start;
+
+        if (open && channel.acquire(forward, counters)) {
+            forward.assign(batch.begin(), batch.end());
+            open = channel.send(forward, counters);
+        }
+    }
+    channel.close();
+
+    uint64_t busy_start = pipeline_clock_ns();
+    exact_counts = count_exact(records);
+    counters.busy_ns += pipeline_clock_ns() - busy_start;
+}
+
+
+void CountStage::finish(PipelineReport& report) {
+    if (thread.joinable()) thread.join();
+    report.stages.push_back(counters.stats());
+}
+
+
+void print_pipeline_report(const PipelineReport& report) {
+    std::cout << " - Pipeline: " << report.records << " records in " << report.seconds << " s, "
+              << report.skipped << " skipped" << std::endl;
+
+    std::cout << "   " << std::left << std::setw(12) << "stage" << std::right
+              << std::setw(10) << "batches" << std::setw(12) << "records" << std::setw(10) << "MB"
+              << std::setw(10) << "busy %" << std::setw(10) << "in wait" << std::setw(10) << "out wait"
+              << std::setw(14) << "Mdps (busy)" << std::endl;
+
+    const StageStats* busiest = nullptr;
+    for (const auto& stage: report.stages) {
+        double wall = report.seconds > 0 ? report.seconds : 1;
+        std::cout << "   " << std::left << std::setw(12) << stage.name << std::right << std::fixed
+                  << std::setw(10) << stage.batches << std::setw(12) << stage.records
+                  << std::setprecision(1) << std::setw(10) << stage.bytes / 1e6
+                  << std::setw(10) << 100.0 * stage.busy_s / wall
+                  << std::setprecision(3) << std::setw(10) << stage.input_wait_s
+                  << std::setw(10) << stage.output_wait_s
+                  << std::setprecision(2) << std::setw(14)
+                  << (stage.busy_s > 0 ? stage.records / stage.busy_s / 1e6 : 0.0) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        if (stage.name != "report" && (busiest == nullptr || stage.busy_s > busiest->busy_s)) busiest = &stage;
+    }
+
+    std::cout << "   " << std::left << std::setw(16) << "queue" << std::right
+              << std::setw(10) << "capacity" << std::setw(16) << "mean occupancy"
+              << std::setw(12) << "full waits" << std::setw(13) << "empty waits" << std::endl;
+    for (const auto& queue: report.queues) {
+        std::cout << "   " << std::left << std::setw(16) << queue.name << std::right
+                  << std::setw(10) << queue.capacity << std::fixed << std::setprecision(2)
+                  << std::setw(16) << queue.mean_occupancy
+                  << std::setw(12) << queue.full_waits << std::setw(13) << queue.empty_waits << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    if (busiest != nullptr) {
+        std::cout << "   Bottleneck: " << busiest->name << " (busy " << busiest->busy_s << " s of "
+                  << report.seconds << " s)" << std::endl;
+    }
+}
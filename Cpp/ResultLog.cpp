@@ -0,0 +1,461 @@
+#include "header/ResultLog.h"
+#include "header/DualSketchStats.h"
+#include "header/Json.h"
+#include "header/SketchKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#ifndef HH_BUILD_FLAGS
+#define HH_BUILD_FLAGS "unknown"
+#endif
+
+
+namespace {
+
+std::string cpu_model() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);) {
+        if (line.rfind("model name", 0) != 0) continue;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos && colon + 2 <= line.size()) return line.substr(colon + 2);
+    }
+    return "unknown";
+}
+
+std::string format_float(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%g", value);
+    return text;
+}
+
+// Continued fraction of the incomplete beta function, by Lentz's method
+double beta_continued_fraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    if (std::fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; ++m) {
+        double numerator = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+        d = 1.0 + numerator * d;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = 1.0 + numerator / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+
+        numerator = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+        d = 1.0 + numerator * d;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = 1.0 + numerator / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < 1e-14) break;
+    }
+    return h;
+}
+
+double regularized_incomplete_beta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x));
+    if (x < (a + 1) / (a + b + 2)) return front * beta_continued_fraction(a, b, x) / a;
+    return 1 - front * beta_continued_fraction(b, a, 1 - x) / b;
+}
+
+// P(|T| >= t) for Student's t distribution with 'dof' degrees of freedom
+double student_t_two_sided(double t, double dof) {
+    return regularized_incomplete_beta(dof / 2, 0.5, dof / (dof + t * t));
+}
+
+// The t with P(|T| >= t) = p, by bisection
+double student_t_critical(double p, double dof) {
+    double low = 0, high = 1e3;
+    for (int i = 0; i < 100; ++i) {
+        double mid = (low + high) / 2;
+        if (student_t_two_sided(mid, dof) > p) low = mid;
+        else high = mid;
+    }
+    return (low + high) / 2;
+}
+
+double mean_of(const std::vector<double>& samples) {
+    double sum = 0;
+    for (double x: samples) sum += x;
+    return samples.empty() ? 0 : sum / samples.size();
+}
+
+double variance_of(const std::vector<double>& samples, double mean) {
+    if (samples.size() < 2) return 0;
+    double sum = 0;
+    for (double x: samples) sum += (x - mean) * (x - mean);
+    return sum / (samples.size() - 1);
+}
+
+void write_latency(JsonWriter& json, const LatencyStats& latency) {
+    json.begin_object();
+    json.key("samples").value(latency.samples);
+    json.key("p50").value(latency.p50_ns);
+    json.key("p99").value(latency.p99_ns);
+    json.key("p99.9").value(latency.p999_ns);
+    json.key("max").value(latency.max_ns);
+    json.end_object();
+}
+
+LatencyStats read_latency(const JsonValue& value) {
+    LatencyStats latency{};
+    latency.samples = static_cast<uint64_t>(value.number_or("samples", 0));
+    latency.p50_ns = value.number_or("p50", 0);
+    latency.p99_ns = value.number_or("p99", 0);
+    latency.p999_ns = value.number_or("p99.9", 0);
+    latency.max_ns = value.number_or("max", 0);
+    return latency;
+}
+
+std::string csv_field(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (char c: text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+} // namespace
+
+
+RunEnvironment current_environment(int argc, char** argv) {
+    RunEnvironment env;
+
+    char host[256] = {};
+    if (gethostname(host, sizeof(host) - 1) == 0) env.host = host;
+    env.cpu_model = cpu_model();
+    env.hardware_threads = std::thread::hardware_concurrency();
+
+    struct utsname name{};
+    if (uname(&name) == 0) env.os = std::string(name.sysname) + " " + name.release + " " + name.machine;
+
+#if defined(__clang__)
+    env.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    env.compiler = "gcc " __VERSION__;
+#else
+    env.compiler = "unknown";
+#endif
+    env.build_flags = HH_BUILD_FLAGS;
+    env.build_flags.erase(0, env.build_flags.find_first_not_of(' '));
+    env.sketch_isa = isa_name(sketch_kernels().isa);
+    env.dualsketch_stats = dualsketch_stats_enabled;
+
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    env.timestamp = timestamp;
+
+    for (int i = 0; i < argc; ++i) {
+        if (i > 0) env.command += ' ';
+        env.command += argv[i];
+    }
+    return env;
+}
+
+
+SampleSummary summarize(const std::vector<double>& samples) {
+    SampleSummary summary;
+    summary.count = samples.size();
+    if (samples.empty()) return summary;
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    summary.min = sorted.front();
+    summary.max = sorted.back();
+    size_t mid = sorted.size() / 2;
+    summary.median = sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+
+    summary.mean = mean_of(samples);
+    summary.stddev = std::sqrt(variance_of(samples, summary.mean));
+    double half_width = 0;
+    if (samples.size() >= 2) {
+        half_width = student_t_critical(0.05, samples.size() - 1.0) * summary.stddev / std::sqrt(samples.size());
+    }
+    summary.ci95_low = summary.mean - half_width;
+    summary.ci95_high = summary.mean + half_width;
+    return summary;
+}
+
+
+WelchTest welch_t_test(const std::vector<double>& a, const std::vector<double>& b) {
+    WelchTest test;
+    if (a.size() < 2 || b.size() < 2) return test;
+
+    double mean_a = mean_of(a), mean_b = mean_of(b);
+    double se_a = variance_of(a, mean_a) / a.size();
+    double se_b = variance_of(b, mean_b) / b.size();
+    double se = se_a + se_b;
+    if (se <= 0) {
+        // no spread on either side: any difference at all is certain
+        test.p_value = mean_a == mean_b ? 1.0 : 0.0;
+        return test;
+    }
+    test.t = (mean_b - mean_a) / std::sqrt(se);
+    // Welch-Satterthwaite
+    test.dof = se * se / (se_a * se_a / (a.size() - 1.0) + se_b * se_b / (b.size() - 1.0));
+    test.p_value = student_t_two_sided(test.t, test.dof);
+    return test;
+}
+
+
+std::string ResultRow::key() const {
+    return mode + " | " + dataset + " | " + algorithm + " | " + format_float(memory_kb) + " KB | phi_1 "
+           + format_float(phi_1) + " | phi_2 " + format_float(phi_2) + " | batch " + std::to_string(batch_size);
+}
+
+
+ResultRow result_row(const std::vector<RunResult>& runs) {
+    ResultRow row;
+    if (runs.empty()) return row;
+    const RunResult& first = runs.front();
+    row.algorithm = first.name;
+    row.memory_kb = first.memory_kb;
+    row.records = first.num_updates;
+    row.memory_bytes = first.memory_bytes;
+
+    std::vector<double> query_ms;
+    for (const auto& run: runs) {
+        row.throughput_mdps.push_back(run.update_throughput_Mdps);
+        query_ms.push_back(run.query_ms);
+    }
+    row.query_ms = summarize(query_ms).median;
+
+    row.update_latency = first.update_latency;
+    row.query_latency = first.query_latency;
+    for (const auto& [name, latency]: first.update_latency_by_case) row.update_latency_by_case.emplace_back(name, latency);
+    return row;
+}
+
+
+bool ResultLog::write_json(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    JsonWriter json(out);
+    json.begin_object();
+
+    json.key("environment").begin_object();
+    json.key("host").value(environment.host);
+    json.key("cpu_model").value(environment.cpu_model);
+    json.key("hardware_threads").value(static_cast<uint64_t>(environment.hardware_threads));
+    json.key("os").value(environment.os);
+    json.key("compiler").value(environment.compiler);
+    json.key("build_flags").value(environment.build_flags);
+    json.key("sketch_isa").value(environment.sketch_isa);
+    json.key("dualsketch_stats").value(environment.dualsketch_stats);
+    json.key("timestamp").value(environment.timestamp);
+    json.key("command").value(environment.command);
+    json.end_object();
+
+    json.key("results").begin_array();
+    for (const ResultRow& row: results) {
+        json.begin_object();
+        json.key("mode").value(row.mode);
+        json.key("dataset").value(row.dataset);
+        json.key("algorithm").value(row.algorithm);
+        json.key("memory_kb").value(row.memory_kb);
+        json.key("phi_1").value(row.phi_1);
+        json.key("phi_2").value(row.phi_2);
+        json.key("batch_size").value(static_cast<uint64_t>(row.batch_size));
+        json.key("records").value(row.records);
+
+        SampleSummary throughput = summarize(row.throughput_mdps);
+        json.key("throughput_mdps").begin_object();
+        json.key("samples").value(row.throughput_mdps);
+        json.key("median").value(throughput.median);
+        json.key("mean").value(throughput.mean);
+        json.key("stddev").value(throughput.stddev);
+        json.key("ci95").value(std::vector<double>{throughput.ci95_low, throughput.ci95_high});
+        json.key("min").value(throughput.min);
+        json.key("max").value(throughput.max);
+        json.end_object();
+
+        json.key("query_ms").value(row.query_ms);
+        json.key("memory_bytes").value(row.memory_bytes);
+
+        if (row.update_latency.samples > 0) {
+            json.key("update_latency_ns");
+            write_latency(json, row.update_latency);
+            if (!row.update_latency_by_case.empty()) {
+                json.key("update_latency_ns_by_case").begin_object();
+                for (const auto& [name, latency]: row.update_latency_by_case) {
+                    json.key(name);
+                    write_latency(json, latency);
+                }
+                json.end_object();
+            }
+            json.key("query_latency_ns");
+            write_latency(json, row.query_latency);
+        }
+
+        if (row.has_accuracy) {
+            const AccuracyMetrics& m = row.accuracy;
+            json.key("accuracy").begin_object();
+            json.key("hh_are").value(m.hh_are);
+            json.key("hh_precision").value(m.hh_precision);
+            json.key("hh_recall").value(m.hh_recall);
+            json.key("hh_f1").value(m.hh_f1);
+            json.key("ele_are").value(m.ele_are);
+            json.key("ele_precision").value(m.ele_precision);
+            json.key("ele_recall").value(m.ele_recall);
+            json.key("ele_f1").value(m.ele_f1);
+            json.end_object();
+        }
+        json.end_object();
+    }
+    json.end_array();
+
+    json.end_object();
+    return static_cast<bool>(out);
+}
+
+
+bool ResultLog::write_csv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    out << "mode,dataset,algorithm,memory_kb,phi_1,phi_2,batch_size,records,"
+        << "runs,throughput_median_mdps,throughput_mean_mdps,throughput_stddev_mdps,"
+        << "throughput_ci95_low_mdps,throughput_ci95_high_mdps,throughput_samples_mdps,query_ms,memory_bytes,"
+        << "update_p50_ns,update_p99_ns,update_p999_ns,update_max_ns,"
+        << "query_p50_ns,query_p99_ns,query_p999_ns,query_max_ns,"
+        << "hh_are,hh_precision,hh_recall,hh_f1,ele_are,ele_precision,ele_recall,ele_f1,"
+        << "host,cpu_model,compiler,build_flags,sketch_isa,dualsketch_stats,timestamp\n";
+
+    for (const ResultRow& row: results) {
+        SampleSummary throughput = summarize(row.throughput_mdps);
+        std::string samples;
+        for (double x: row.throughput_mdps) samples += (samples.empty() ? "" : ";") + format_float(x);
+
+        out << csv_field(row.mode) << ',' << csv_field(row.dataset) << ',' << csv_field(row.algorithm) << ','
+            << row.memory_kb << ',' << row.phi_1 << ',' << row.phi_2 << ',' << row.batch_size << ',' << row.records << ','
+            << throughput.count << ',' << throughput.median << ',' << throughput.mean << ',' << throughput.stddev << ','
+            << throughput.ci95_low << ',' << throughput.ci95_high << ',' << samples << ','
+            << row.query_ms << ',' << row.memory_bytes << ',';
+
+        // latency and accuracy columns stay empty where they were not measured
+        if (row.update_latency.samples > 0) {
+            const LatencyStats& u = row.update_latency;
+            const LatencyStats& q = row.query_latency;
+            out << u.p50_ns << ',' << u.p99_ns << ',' << u.p999_ns << ',' << u.max_ns << ','
+                << q.p50_ns << ',' << q.p99_ns << ',' << q.p999_ns << ',' << q.max_ns << ',';
+        } else {
+            out << ",,,,,,,,";
+        }
+        if (row.has_accuracy) {
+            const AccuracyMetrics& m = row.accuracy;
+            out << m.hh_are << ',' << m.hh_precision << ',' << m.hh_recall << ',' << m.hh_f1 << ','
+                << m.ele_are << ',' << m.ele_precision << ',' << m.ele_recall << ',' << m.ele_f1 << ',';
+        } else {
+            out << ",,,,,,,,";
+        }
+
+        out << csv_field(environment.host) << ',' << csv_field(environment.cpu_model) << ','
+            << csv_field(environment.compiler) << ',' << csv_field(environment.build_flags) << ','
+            << environment.sketch_isa << ','
+            << (environment.dualsketch_stats ? 1 : 0) << ',' << environment.timestamp << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+
+bool read_result_log(const std::string& path, ResultLog& log, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    JsonValue root;
+    if (!parse_json(text.str(), root, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    const JsonValue* results = root.find("results");
+    if (results == nullptr || results->type != JsonValue::Type::Array) {
+        error = path + ": no \"results\" array";
+        return false;
+    }
+
+    log = ResultLog();
+    if (const JsonValue* env = root.find("environment")) {
+        log.environment.host = env->string_or("host", "");
+        log.environment.cpu_model = env->string_or("cpu_model", "");
+        log.environment.hardware_threads = static_cast<unsigned>(env->number_or("hardware_threads", 0));
+        log.environment.os = env->string_or("os", "");
+        log.environment.compiler = env->string_or("compiler", "");
+        log.environment.build_flags = env->string_or("build_flags", "");
+        log.environment.sketch_isa = env->string_or("sketch_isa", "");
+        const JsonValue* stats = env->find("dualsketch_stats");
+        log.environment.dualsketch_stats = stats != nullptr && stats->boolean;
+        log.environment.timestamp = env->string_or("timestamp", "");
+        log.environment.command = env->string_or("command", "");
+    }
+
+    for (const JsonValue& item: results->array) {
+        ResultRow row;
+        row.mode = item.string_or("mode", "");
+        row.dataset = item.string_or("dataset", "");
+        row.algorithm = item.string_or("algorithm", "");
+        row.memory_kb = static_cast<float>(item.number_or("memory_kb", 0));
+        row.phi_1 = static_cast<float>(item.number_or("phi_1", 0));
+        row.phi_2 = static_cast<float>(item.number_or("phi_2", 0));
+        row.batch_size = static_cast<size_t>(item.number_or("batch_size", 0));
+        row.records = static_cast<uint64_t>(item.number_or("records", 0));
+        if (const JsonValue* throughput = item.find("throughput_mdps")) {
+            if (const JsonValue* samples = throughput->find("samples")) {
+                for (const JsonValue& x: samples->array) row.throughput_mdps.push_back(x.number);
+            }
+        }
+        row.query_ms = item.number_or("query_ms", 0);
+        row.memory_bytes = static_cast<uint64_t>(item.number_or("memory_bytes", 0));
+
+        if (const JsonValue* latency = item.find("update_latency_ns")) row.update_latency = read_latency(*latency);
+        if (const JsonValue* latency = item.find("query_latency_ns")) row.query_latency = read_latency(*latency);
+        if (const JsonValue* by_case = item.find("update_latency_ns_by_case")) {
+            for (const auto& [name, latency]: by_case->object) {
+                row.update_latency_by_case.emplace_back(name, read_latency(latency));
+            }
+        }
+        if (const JsonValue* m = item.find("accuracy")) {
+            row.has_accuracy = true;
+            row.accuracy.hh_are = static_cast<float>(m->number_or("hh_are", 0));
+            row.accuracy.hh_precision = static_cast<float>(m->number_or("hh_precision", 0));
+            row.accuracy.hh_recall = static_cast<float>(m->number_or("hh_recall", 0));
+            row.accuracy.hh_f1 = static_cast<float>(m->number_or("hh_f1", 0));
+            row.accuracy.ele_are = static_cast<float>(m->number_or("ele_are", 0));
+            row.accuracy.ele_precision = static_cast<float>(m->number_or("ele_precision", 0));
+            row.accuracy.ele_recall = static_cast<float>(m->number_or("ele_recall", 0));
+            row.accuracy.ele_f1 = static_cast<float>(m->number_or("ele_f1", 0));
+        }
+        log.add(std::move(row));
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "header/SketchDriver.h"
+#include "header/Evaluator.h"
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+
+static void report_latency(const char* label, const LatencyStats& latency) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1)
+              << label << "p50 " << latency.p50_ns << " ns, p99 " << latency.p99_ns
+              << " ns, p99.9 " << latency.p999_ns << " ns, max " << latency.max_ns
+              << " ns (" << latency.samples << " samples)" << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+
+// the configured budget next to the heap bytes the sketch actually holds
+static void report_memory(const RunResult& run) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    double measured_kb = run.memory_bytes / 1024.0;
+    std::cout << std::fixed << std::setprecision(1)
+              << " - Memory: budget " << run.memory_kb << " KB, measured " << measured_kb << " KB ("
+              << (run.memory_kb > 0 ? 100.0 * measured_kb / run.memory_kb : 0.0) << "%)" << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+
+void report_latencies(const RunResult& run) {
+    if (run.update_latency.samples == 0) return;
+    report_latency(" - Update Latency | ", run.update_latency);
+    for (const auto& [name, latency]: run.update_latency_by_case) {
+        std::string label = "     " + std::string(name) + " | ";
+        report_latency(label.c_str(), latency);
+    }
+    report_latency(" - Query Latency | ", run.query_latency);
+}
+
+
+void report_run(const RunResult& run, const AccuracyMetrics& metrics) {
+
+    std::cout << "\n" << run.name << ":" << std::endl;
+    std::cout << " - Update Throughput: " << run.update_throughput_Mdps << " Mdps" << std::endl;
+    std::cout << " - Query Time: " << run.query_ms << " ms" << std::endl;
+    report_memory(run);
+
+    std::cout << " - Heavy Hitter Metrics | ";
+    std::cout << "ARE: " << metrics.hh_are << ", ";
+    std::cout << "F1: " << metrics.hh_f1 << "\n";
+
+    std::cout << " - Heavy Quadratic Ele Metrics | ";
+    std::cout << "ARE: " << metrics.ele_are << ", ";
+    std::cout << "F1: " << metrics.ele_f1 << "\n";
+
+    report_latencies(run);
+}
+
+
+void report_stream_run(const RunResult& run) {
+
+    size_t num_quad_elements = 0;
+    for (const auto &[flow, elements]: run.answer.second) {
+        num_quad_elements += elements.size();
+    }
+
+    std::cout << "\n" << run.name << ":" << std::endl;
+    std::cout << " - Streamed Records: " << run.num_updates << " in " << run.update_seconds << " s" << std::endl;
+    std::cout << " - End-to-end Throughput: " << run.update_throughput_Mdps << " Mdps" << std::endl;
+    std::cout << " - Query Time: " << run.query_ms << " ms" << std::endl;
+    report_memory(run);
+    std::cout << " - Reported Heavy Hitters: " << run.answer.first.size()
+              << ", Hot Quadratic Elements: " << num_quad_elements << "\n";
+}
@@ -0,0 +1,110 @@
+
+#include <cstdlib>
+#include <iostream>
+#include "header/SketchKernels.h"
+
+
+// The tables, one per SketchKernels<Level>.cpp. The AVX ones are only built on x86-64,
+// which CMake signals with HH_X86_KERNELS.
+namespace sketch_kernels_baseline { extern const SketchKernels table; }
+#ifdef HH_X86_KERNELS
+namespace sketch_kernels_avx2 { extern const SketchKernels table; }
+namespace sketch_kernels_avx512 { extern const SketchKernels table; }
+#endif
+
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Baseline: return "baseline";
+        case Isa::Avx2: return "avx2";
+        case Isa::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+
+bool parse_isa(const std::string& name, Isa& isa) {
+    for (Isa candidate: {Isa::Baseline, Isa::Avx2, Isa::Avx512}) {
+        if (name == isa_name(candidate)) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool isa_supported(Isa isa) {
+    if (isa == Isa::Baseline) return true;
+#ifdef HH_X86_KERNELS
+    // also checks that the OS saves the wider registers (XGETBV)
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma");
+    if (isa == Isa::Avx2) return avx2;
+    return avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+           && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+#else
+    return false;
+#endif
+}
+
+
+Isa detected_isa() {
+    if (isa_supported(Isa::Avx512)) return Isa::Avx512;
+    if (isa_supported(Isa::Avx2)) return Isa::Avx2;
+    return Isa::Baseline;
+}
+
+
+static const SketchKernels* table_of(Isa isa) {
+#ifdef HH_X86_KERNELS
+    if (isa == Isa::Avx512) return &sketch_kernels_avx512::table;
+    if (isa == Isa::Avx2) return &sketch_kernels_avx2::table;
+#endif
+    (void) isa;
+    return &sketch_kernels_baseline::table;
+}
+
+
+// The detected level, lowered by HH_ISA if it names a supported one
+static const SketchKernels* choose_kernels() {
+    Isa isa = detected_isa();
+    if (const char* requested_name = std::getenv("HH_ISA")) {
+        Isa requested;
+        if (!parse_isa(requested_name, requested)) {
+            std::cerr << "HH_ISA: unknown level \"" << requested_name << "\" (baseline, avx2, avx512), using "
+                      << isa_name(isa) << std::endl;
+        } else if (!isa_supported(requested)) {
+            std::cerr << "HH_ISA: " << requested_name << " is not supported here, using " << isa_name(isa) << std::endl;
+        } else {
+            isa = requested;
+        }
+    }
+    return table_of(isa);
+}
+
+
+static const SketchKernels* forced_kernels = nullptr;  // by set_sketch_isa()
+
+
+const SketchKernels& sketch_kernels() {
+    if (forced_kernels != nullptr) return *forced_kernels;
+    static const SketchKernels* chosen = choose_kernels();  // once, even if sketches are built concurrently
+    return *chosen;
+}
+
+
+bool set_sketch_isa(Isa isa) {
+    if (!isa_supported(isa)) return false;
+    forced_kernels = table_of(isa);
+    return true;
+}
+
+
+void print_sketch_dispatch(std::ostream& out) {
+    Isa active = sketch_kernels().isa;
+    Isa detected = detected_isa();
+    out << "Sketch kernels: " << isa_name(active);
+    if (active != detected) out << " (detected " << isa_name(detected) << ")";
+    out << std::endl;
+}
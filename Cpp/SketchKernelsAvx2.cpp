@@ -0,0 +1,5 @@
+// Kernels for AVX2 + BMI2 + FMA, built with -mavx2 -mbmi2 -mfma (see CMakeLists.txt)
+
+#define HH_KERNEL_NAMESPACE sketch_kernels_avx2
+#define HH_KERNEL_ISA Isa::Avx2
+#include "header/SketchKernelsImpl.h"
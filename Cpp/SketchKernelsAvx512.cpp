@@ -0,0 +1,5 @@
+// Kernels for AVX-512 F/BW/DQ/VL, built with -mavx512f -mavx512bw -mavx512dq -mavx512vl
+
+#define HH_KERNEL_NAMESPACE sketch_kernels_avx512
+#define HH_KERNEL_ISA Isa::Avx512
+#include "header/SketchKernelsImpl.h"
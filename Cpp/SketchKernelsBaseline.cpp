@@ -0,0 +1,5 @@
+// Kernels for baseline x86-64 (or the target's default ISA), and the fallback everywhere
+
+#define HH_KERNEL_NAMESPACE sketch_kernels_baseline
+#define HH_KERNEL_ISA Isa::Baseline
+#include "header/SketchKernelsImpl.h"
@@ -0,0 +1,236 @@
+#include "header/TraceFile.h"
+#include "header/MappedFile.h"
+#include "header/MurmurHash3.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+static_assert(sizeof(Record) == 2 * sizeof(uint32_t), "records are stored as packed uint32 pairs");
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = {'D', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t TRACE_VERSION = 1;
+
+// False if the size does not fit in 64 bits, e.g. for a corrupt record_count
+bool expected_file_size(const TraceHeader& header, uint64_t& size) {
+    uint64_t bytes_per_record = sizeof(Record);
+    if (header.columns & TRACE_COL_TIMESTAMP) bytes_per_record += sizeof(uint64_t);
+    if (header.columns & TRACE_COL_WEIGHT) bytes_per_record += sizeof(uint32_t);
+    if (header.record_count > (UINT64_MAX - sizeof(TraceHeader)) / bytes_per_record) return false;
+    size = sizeof(TraceHeader) + header.record_count * bytes_per_record;
+    return true;
+}
+
+bool header_valid(const TraceHeader& header, uint64_t file_size) {
+    uint64_t expected_size = 0;
+    return std::memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0
+           && header.version == TRACE_VERSION
+           && header.header_bytes == sizeof(TraceHeader)
+           && header.key_width_x == sizeof(uint32_t)
+           && header.key_width_y == sizeof(uint32_t)
+           && expected_file_size(header, expected_size)
+           && expected_size == file_size;
+}
+
+TraceHeader make_header(uint64_t record_count) {
+    TraceHeader header{};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.header_bytes = sizeof(TraceHeader);
+    header.record_count = record_count;
+    header.key_width_x = sizeof(uint32_t);
+    header.key_width_y = sizeof(uint32_t);
+    return header;
+}
+
+std::string temporary_path(const std::string& path) {
+    return path + ".tmp." + std::to_string(getpid());
+}
+
+bool write_all(std::FILE* out, const void* data, size_t bytes) {
+    return bytes == 0 || std::fwrite(data, 1, bytes, out) == bytes;
+}
+
+} // namespace
+
+
+uint64_t trace_checksum(const char* data, size_t size) {
+    // MurmurHash3_x64_128 over 1 MiB blocks, chained into one 64-bit value
+    constexpr size_t block = 1 << 20;
+    uint64_t checksum = 0xcbf29ce484222325ULL ^ size;
+    for (size_t offset = 0, i = 0; offset < size; offset += block, ++i) {
+        uint64_t h[2];
+        int len = static_cast<int>(std::min(block, size - offset));
+        MurmurHash3_x64_128(data + offset, len, static_cast<uint32_t>(i), h);
+        checksum = (checksum ^ h[0]) * 0x100000001b3ULL + h[1];
+    }
+    return checksum;
+}
+
+
+bool describe_source(const std::string& source_path, TraceHeader& header, bool with_checksum) {
+    struct stat st{};
+    if (stat(source_path.c_str(), &st) != 0) return false;
+
+    header.source_size = static_cast<uint64_t>(st.st_size);
+    header.source_mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    header.source_checksum = 0;
+
+    if (with_checksum) {
+        MappedFile source;
+        if (!source.open(source_path)) return false;
+        source.advise_sequential();
+        header.source_checksum = trace_checksum(source.data(), source.size());
+    }
+    return true;
+}
+
+
+bool write_trace(const std::string& path, const std::vector<Record>& records,
+                 const TraceHeader* source, const TraceExtras* extras) {
+
+    TraceHeader header = make_header(records.size());
+    if (source != nullptr) {
+        header.source_size = source->source_size;
+        header.source_mtime_ns = source->source_mtime_ns;
+        header.source_checksum = source->source_checksum;
+        header.source_format = source->source_format;
+        header.parser_version = source->parser_version;
+    }
+
+    bool with_timestamps = extras != nullptr && !extras->timestamps.empty();
+    bool with_weights = extras != nullptr && !extras->weights.empty();
+    if (with_timestamps && extras->timestamps.size() != records.size()) return false;
+    if (with_weights && extras->weights.size() != records.size()) return false;
+    if (with_timestamps) header.columns |= TRACE_COL_TIMESTAMP;
+    if (with_weights) header.columns |= TRACE_COL_WEIGHT;
+
+    // write next to the target and rename, so that readers never see a partial trace
+    std::string tmp_path = temporary_path(path);
+    std::FILE* out = std::fopen(tmp_path.c_str(), "wb");
+    if (out == nullptr) return false;
+
+    bool ok = write_all(out, &header, sizeof(header))
+              && write_all(out, records.data(), records.size() * sizeof(Record));
+    if (ok && with_timestamps) {
+        ok = write_all(out, extras->timestamps.data(), extras->timestamps.size() * sizeof(uint64_t));
+    }
+    if (ok && with_weights) {
+        ok = write_all(out, extras->weights.data(), extras->weights.size() * sizeof(uint32_t));
+    }
+    ok = (std::fclose(out) == 0) && ok;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+TraceWriter::~TraceWriter() {
+    if (out != nullptr) {
+        std::fclose(out);
+        std::remove(tmp_path.c_str());
+    }
+}
+
+
+bool TraceWriter::open(const std::string& target_path, uint64_t record_count) {
+    if (out != nullptr) return false;
+    path = target_path;
+    tmp_path = temporary_path(path);
+    expected = record_count;
+    written = 0;
+
+    out = std::fopen(tmp_path.c_str(), "wb");
+    if (out == nullptr) return false;
+    TraceHeader header = make_header(record_count);
+    ok = write_all(out, &header, sizeof(header));
+    return ok;
+}
+
+
+bool TraceWriter::append(const Record* records, size_t n) {
+    if (out == nullptr) return false;
+    ok = ok && write_all(out, records, n * sizeof(Record));
+    written += n;
+    return ok;
+}
+
+
+bool TraceWriter::close() {
+    if (out == nullptr) return false;
+    bool closed = std::fclose(out) == 0;
+    out = nullptr;
+    if (!ok || !closed || written != expected || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+bool read_trace_header(const std::string& path, TraceHeader& header) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+
+    bool ok = std::fread(&header, 1, sizeof(header), in) == sizeof(header);
+    struct stat st{};
+    ok = ok && fstat(fileno(in), &st) == 0 && header_valid(header, static_cast<uint64_t>(st.st_size));
+    std::fclose(in);
+    return ok;
+}
+
+
+bool read_trace(const std::string& path, std::vector<Record>& records, TraceHeader* header, TraceExtras* extras) {
+
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(TraceHeader)) return false;
+    file.advise_sequential();
+
+    TraceHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (!header_valid(h, file.size())) return false;
+
+    const char* p = file.data() + sizeof(TraceHeader);
+    size_t n = h.record_count;
+
+    size_t old_size = records.size();
+    records.resize(old_size + n);
+    std::memcpy(static_cast<void*>(records.data() + old_size), p, n * sizeof(Record));
+    p += n * sizeof(Record);
+
+    if (h.columns & TRACE_COL_TIMESTAMP) {
+        if (extras != nullptr) {
+            extras->timestamps.resize(n);
+            std::memcpy(extras->timestamps.data(), p, n * sizeof(uint64_t));
+        }
+        p += n * sizeof(uint64_t);
+    }
+    if ((h.columns & TRACE_COL_WEIGHT) && extras != nullptr) {
+        extras->weights.resize(n);
+        std::memcpy(extras->weights.data(), p, n * sizeof(uint32_t));
+    }
+
+    if (header != nullptr) *header = h;
+    return true;
+}
+
+
+bool trace_cache_valid(const std::string& cache_path, const std::string& source_path,
+                       uint16_t source_format, uint32_t parser_version, bool verify_checksum) {
+    TraceHeader cached;
+    if (!read_trace_header(cache_path, cached)) return false;
+    if (cached.source_format != source_format || cached.parser_version != parser_version) return false;
+
+    TraceHeader current{};
+    if (!describe_source(source_path, current, verify_checksum)) return false;
+
+    if (cached.source_size != current.source_size || cached.source_mtime_ns != current.source_mtime_ns) return false;
+    return !verify_checksum || cached.source_checksum == current.source_checksum;
+}
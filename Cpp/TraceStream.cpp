@@ -0,0 +1,173 @@
+#include "header/TraceStream.h"
+#include "header/MappedFile.h"
+#include "header/PcapReader.h"
+#include "header/TextParse.h"
+#include "header/TraceFile.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+namespace {
+
+// Consumed parts of a mapping are dropped in steps of this size
+constexpr size_t RELEASE_BYTES = 64 << 20;
+
+} // namespace
+
+
+TraceStream::TraceStream(std::vector<std::string> file_paths, TraceFormat format, StreamConfig config)
+        : file_paths(std::move(file_paths)), format(format), config(config),
+          full_chunks(config.queue_depth), free_chunks(config.queue_depth + 2) {
+
+    this->config.chunk_records = std::max<size_t>(1, config.chunk_records);
+    for (size_t i = 0; i < config.queue_depth + 2; ++i) {
+        std::vector<Record> chunk;
+        chunk.reserve(this->config.chunk_records);
+        free_chunks.push(std::move(chunk));
+    }
+    reader = std::thread(&TraceStream::read_all, this);
+}
+
+
+TraceStream::~TraceStream() {
+    // unblocks the reader if the consumer stopped early
+    full_chunks.close();
+    free_chunks.close();
+    if (reader.joinable()) reader.join();
+}
+
+
+bool TraceStream::next(std::vector<Record>& chunk) {
+    if (chunk.capacity() > 0) {
+        chunk.clear();
+        free_chunks.push(std::move(chunk));
+    }
+    return full_chunks.pop(chunk);
+}
+
+
+// Passes a filled chunk to the consumer and takes an empty buffer in its place.
+bool TraceStream::emit(std::vector<Record>& chunk) {
+    records_read += chunk.size();
+    if (!full_chunks.push(std::move(chunk))) return false;
+    if (!free_chunks.pop(chunk)) return false;
+    chunk.clear();
+    return true;
+}
+
+
+void TraceStream::read_all() {
+    std::vector<Record> chunk;
+    if (!free_chunks.pop(chunk)) return;
+
+    bool ok = true;
+    for (const auto& path: file_paths) {
+        if (format != TraceFormat::Binary && trace_cache_enabled() && trace_cache_current(path, format)) {
+            ok = read_binary(trace_cache_path(path), chunk);
+        } else if (format == TraceFormat::Binary) {
+            ok = read_binary(path, chunk);
+        } else if (format == TraceFormat::Pcap) {
+            ok = read_capture(path, chunk);
+        } else {
+            ok = read_text(path, format, chunk);
+        }
+        if (!ok) break;
+    }
+    if (ok && !chunk.empty()) emit(chunk);
+
+    full_chunks.close();
+    free_chunks.close();
+}
+
+
+bool TraceStream::read_binary(const std::string& path, std::vector<Record>& chunk) {
+    TraceHeader header{};
+    MappedFile file;
+    if (!read_trace_header(path, header) || !file.open(path)) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        failed_files++;
+        return true;
+    }
+    file.advise_sequential();
+
+    const char* records = file.data() + sizeof(TraceHeader);
+    size_t released = 0;
+    for (uint64_t done = 0; done < header.record_count;) {
+        size_t n = std::min<uint64_t>(config.chunk_records - chunk.size(), header.record_count - done);
+        size_t old_size = chunk.size();
+        chunk.resize(old_size + n);
+        std::memcpy(static_cast<void*>(chunk.data() + old_size), records + done * sizeof(Record), n * sizeof(Record));
+        done += n;
+
+        if (chunk.size() == config.chunk_records && !emit(chunk)) return false;
+
+        size_t consumed = sizeof(TraceHeader) + done * sizeof(Record);
+        if (consumed - released >= RELEASE_BYTES) {
+            file.release(released, consumed - released);
+            released = consumed;
+        }
+    }
+    bytes_read += file.size();
+    return true;
+}
+
+
+bool TraceStream::read_text(const std::string& path, TraceFormat text_format, std::vector<Record>& chunk) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        failed_files++;
+        return true;
+    }
+    file.advise_sequential();
+
+    LineParser parse_line = line_parser(text_format);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    const char* p = begin;
+    if (has_header_line(text_format) && p != end) {
+        p = find_line_end(p, end);
+        if (p != end) ++p;
+    }
+
+    uint64_t skipped = 0;
+    size_t released = 0;
+    while (p < end) {
+        const char* line_end = find_line_end(p, end);
+        if (!parse_line(p, line_end, static_cast<uint64_t>(p - begin), chunk)) skipped++;
+        p = line_end + 1;
+
+        if (chunk.size() >= config.chunk_records) {
+            if (!emit(chunk)) return false;
+
+            size_t consumed = std::min(static_cast<size_t>(p - begin), file.size());
+            if (consumed - released >= RELEASE_BYTES) {
+                file.release(released, consumed - released);
+                released = consumed;
+            }
+        }
+    }
+    skipped_lines += skipped;
+    bytes_read += file.size();
+    return true;
+}
+
+
+bool TraceStream::read_capture(const std::string& path, std::vector<Record>& chunk) {
+    PcapReader capture;
+    std::string error;
+    if (!capture.open(path, &error)) {
+        std::cerr << path << ": " << error << std::endl;
+        failed_files++;
+        return true;
+    }
+
+    const KeySpec spec = default_key_spec();
+    while (capture.read_batch(spec, chunk, config.chunk_records - chunk.size()) > 0) {
+        if (chunk.size() == config.chunk_records && !emit(chunk)) return false;
+    }
+    skipped_lines += capture.stats().non_ip;
+    bytes_read += capture.bytes();
+    return true;
+}
@@ -1,4 +1,3 @@
-
 #include <cmath>
 #include <random>
 #include <chrono>
@@ -6,9 +5,7 @@
 
 
 
-TwoDMisraGries::TwoDMisraGries(float memory_kb) {
-
-    s2 = 8; // length for each inner list
+TwoDMisraGries::TwoDMisraGries(float memory_kb) : s1(0), num_slots(0), index_mask(0), index_shift(31), gen(std::random_device{}()) {
 
     // 2 fields: heavy hitter key and frequency, each is 32 bits
     uint32_t outer_bits = 32 + 32;
@@ -31,97 +28,169 @@ TwoDMisraGries::TwoDMisraGries(float memory_kb) {
         return;
     }
 
+    // The arena and its index are the only allocations of this sketch
+    slots = AlignedBuffer<OuterSlot>(s1, &memory);
+
+    uint32_t index_capacity = 2;
+    index_shift = 31;
+    while (index_capacity < 2 * s1) {
+        index_capacity <<= 1;
+        index_shift--;
+    }
+    index = AlignedBuffer<SlotIndexEntry>(index_capacity, &memory);
+    index_mask = index_capacity - 1;
+    for (uint32_t i = 0; i < index_capacity; ++i) {
+        index[i].slot = EMPTY_SLOT;
+    }
 }
 
 
 
 
-void TwoDMisraGries::update(uint32_t x, uint32_t y) {
+// Fibonacci hashing of the flow key into the index. The position is taken from the top bits
+// of the product, which depend on every bit of x; the low bits depend only on the low bits of
+// x, so keys differing in their upper bits (addresses in host order, ports in a high field)
+// would all share one probe chain.
+uint32_t TwoDMisraGries::index_pos(uint32_t x) const {
+    return (x * 0x9E3779B1u) >> index_shift;
+}
 
-    auto it = outer_map.find(x);
 
-    if (it != outer_map.end()) { // case 1, x exists.
-        it->second.freq_outer++;
-        update_inner_list(it->second.inner_list, y);
+uint32_t TwoDMisraGries::index_probes(uint32_t x) const {
+    if (index.size() == 0) return 0;
+    uint32_t probes = 1;
+    for (uint32_t pos = index_pos(x); index[pos].slot != EMPTY_SLOT && index[pos].key != x; pos = (pos + 1) & index_mask) {
+        probes++;
+    }
+    return probes;
+}
 
-    } else { // case 2: x does not exist
 
-        if (outer_map.size() < s1) {
+uint32_t TwoDMisraGries::find_slot(uint32_t x) const {
+    if (index.size() == 0) return EMPTY_SLOT;
+    for (uint32_t pos = index_pos(x); ; pos = (pos + 1) & index_mask) {
+        const SlotIndexEntry& entry = index[pos];
+        if (entry.slot == EMPTY_SLOT) return EMPTY_SLOT;
+        if (entry.key == x) return entry.slot;
+    }
+}
 
-            OuterStruct new_outer;
-            new_outer.freq_outer = 1;
 
-            InnerStruct new_inner;
-            new_inner.key_inner = y;
-            new_inner.freq_inner = 1;
+void TwoDMisraGries::index_insert(uint32_t x, uint32_t slot) {
+    uint32_t pos = index_pos(x);
+    while (index[pos].slot != EMPTY_SLOT) {
+        pos = (pos + 1) & index_mask;
+    }
+    index[pos].key = x;
+    index[pos].slot = slot;
+}
 
-            new_outer.inner_list.push_back(new_inner);
-            outer_map.emplace(x, new_outer);
 
-        } else {
+void TwoDMisraGries::index_erase(uint32_t x) {
+    uint32_t pos = index_pos(x);
+    while (index[pos].key != x || index[pos].slot == EMPTY_SLOT) {
+        pos = (pos + 1) & index_mask;
+    }
 
-            std::vector<uint32_t> keys_to_remove;
-            for (auto& pair : outer_map) {
-                pair.second.freq_outer--;
-
-                if (pair.second.freq_outer == 0) {
-                    keys_to_remove.push_back(pair.first);
-                } else{
-                    // random choose an item in inner list, decrease its freq
-                    std::random_device rd;
-                    std::mt19937 gen(rd());
-                    std::vector<InnerStruct>& inner_list = pair.second.inner_list;
-                    if (!inner_list.empty()) {
-                        std::uniform_int_distribution<> distrib(0, inner_list.size() - 1);
-                        size_t index_to_decrease = distrib(gen);
-
-                        inner_list[index_to_decrease].freq_inner--;
-
-                        if (inner_list[index_to_decrease].freq_inner == 0) {
-                            inner_list.erase(inner_list.begin() + index_to_decrease);
-                        }
-                    }
-                }
+    // Backward-shift deletion: pull later entries of the probe chain into the hole,
+    // so that lookups never need tombstones
+    uint32_t hole = pos;
+    for (uint32_t next = (hole + 1) & index_mask; index[next].slot != EMPTY_SLOT; next = (next + 1) & index_mask) {
+        uint32_t home = index_pos(index[next].key);
+        // move 'next' into the hole unless its home lies cyclically in (hole, next]
+        if (((next - home) & index_mask) >= ((next - hole) & index_mask)) {
+            index[hole] = index[next];
+            hole = next;
+        }
+    }
+    index[hole].slot = EMPTY_SLOT;
+}
 
-            }
 
-            for (uint32_t key : keys_to_remove) {
-                outer_map.erase(key);
-            }
-        }
+void TwoDMisraGries::index_relocate(uint32_t x, uint32_t slot) {
+    uint32_t pos = index_pos(x);
+    while (index[pos].key != x || index[pos].slot == EMPTY_SLOT) {
+        pos = (pos + 1) & index_mask;
     }
+    index[pos].slot = slot;
 }
 
 
-void TwoDMisraGries::update_inner_list(std::vector<InnerStruct>& list, uint32_t y) {
 
-    for (auto& inner_ : list) {
-        if (inner_.key_inner == y) {
-            inner_.freq_inner++;
-            return;
+
+void TwoDMisraGries::update(uint32_t x, uint32_t y) {
+
+    uint32_t slot = find_slot(x);
+
+    if (slot != EMPTY_SLOT) { // case 1, x exists.
+        OuterSlot& outer = slots[slot];
+        outer.freq_outer++;
+        update_inner_list(outer, y);
+
+    } else { // case 2: x does not exist
+
+        if (num_slots < s1) {
+
+            OuterSlot& outer = slots[num_slots];
+            outer.key_outer = x;
+            outer.freq_outer = 1;
+            outer.key_inner[0] = y;
+            outer.freq_inner[0] = 1;
+            outer.inner_size = 1;
+
+            index_insert(x, num_slots);
+            num_slots++;
+
+        } else {
+            decrement_all();
         }
     }
+}
 
-    if (list.size() < s2) {
-        InnerStruct new_inner;
-        new_inner.key_inner = y;
-        new_inner.freq_inner = 1;
-        list.push_back(new_inner);
-        return;
-    }
 
-    std::vector<size_t> indices_to_remove;
-    for (size_t i = 0; i < list.size(); ++i) {
-        list[i].freq_inner--;
-        if (list[i].freq_inner == 0) {
-            indices_to_remove.push_back(i);
+// Decrement every flow; flows reaching 0 are evicted, the others decay one random inner entry.
+// Evicted slots are refilled with the last live slot to keep the arena dense.
+void TwoDMisraGries::decrement_all() {
+
+    uint32_t i = 0;
+    while (i < num_slots) {
+        OuterSlot& outer = slots[i];
+        outer.freq_outer--;
+
+        if (outer.freq_outer == 0) {
+            index_erase(outer.key_outer);
+            num_slots--;
+            if (i != num_slots) {
+                outer = slots[num_slots];
+                index_relocate(outer.key_outer, i);
+
+                // the moved slot has not been decremented yet, revisit position i
+                continue;
+            }
+        } else if (outer.inner_size > 0) {
+            // random choose an item in inner list, decrease its freq
+            std::uniform_int_distribution<uint32_t> distrib(0, outer.inner_size - 1);
+            uint32_t index_to_decrease = distrib(gen);
+
+            outer.freq_inner[index_to_decrease]--;
+
+            if (outer.freq_inner[index_to_decrease] == 0) {
+                // order of the inner list is irrelevant, fill the gap with the last entry
+                uint32_t last = --outer.inner_size;
+                outer.key_inner[index_to_decrease] = outer.key_inner[last];
+                outer.freq_inner[index_to_decrease] = outer.freq_inner[last];
+            }
         }
+        ++i;
     }
+}
 
-    std::sort(indices_to_remove.rbegin(), indices_to_remove.rend());
-    for (size_t index : indices_to_remove) {
-        list.erase(list.begin() + index);
-    }
+
+void TwoDMisraGries::update_inner_list(OuterSlot& outer, uint32_t y) {
+
+    static_assert(s2 == 8, "update_inner_list scans the inner list as a single 8-lane vector");
+
+    outer.inner_size = kernels->misra_gries_u32x8(outer.key_inner, outer.freq_inner, outer.inner_size, y);
 }
 
 
@@ -141,17 +210,17 @@ std::pair<std::map<uint32_t, uint32_t>,
     std::map<uint32_t, uint32_t> heavy_hitters;
     std::map<uint32_t, std::map<uint32_t, uint32_t>> quad_elements;
 
-    for (auto& pair : outer_map) {
-        auto x = pair.first;
-        auto x_freq = pair.second.freq_outer;
+    for (uint32_t slot = 0; slot < num_slots; ++slot) {
+        const OuterSlot& outer = slots[slot];
+        auto x = outer.key_outer;
+        auto x_freq = outer.freq_outer;
 
         if ( x_freq >= heavy_hitter_th){
             heavy_hitters[x] = x_freq;
 
-            std::vector<InnerStruct>& inner_list = pair.second.inner_list;
-            for (uint32_t i = 0; i < inner_list.size(); ++i) {
-                auto y = inner_list[i].key_inner;
-                auto y_freq = inner_list[i].freq_inner;
+            for (uint32_t i = 0; i < outer.inner_size; ++i) {
+                auto y = outer.key_inner[i];
+                auto y_freq = outer.freq_inner[i];
                 if ( y_freq >= x_freq * phi ) {
                     quad_elements[x][y] = y_freq;
                 }
@@ -165,113 +234,15 @@ std::pair<std::map<uint32_t, uint32_t>,
 
 
 
-void TwoDMisraGries::evaluation(const std::vector<std::pair<uint32_t, uint32_t>> &dataset,
-                          const std::map<uint32_t, uint32_t> &flows,
-                          std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                          uint32_t heavy_hitter_th, float ele_th_phi) {
-
-    std::cout << "\n" << "2D-MG:" << std::endl;
-
-    // Process the entire dataset
-    auto start_update = std::chrono::high_resolution_clock::now();
-    for (const auto &[x, y]: dataset) {
-        update(x, y);
-    }
-    auto end_update = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> update_duration = end_update - start_update;
-    double update_throughput_Mdps = (dataset.size() / 1e6) / update_duration.count();
-    std::cout << " - Update Throughput: " << update_throughput_Mdps << " Mdps" << std::endl;
-
-
-    // Query the sketch for results
-    auto start_query = std::chrono::high_resolution_clock::now();
-    auto [queried_heavy_hitters, queried_quad_elements] = query(heavy_hitter_th, ele_th_phi);
-    auto end_query = std::chrono::high_resolution_clock::now();
-    auto query_duration = end_query - start_query;
-    std::cout << " - Query Time: " << std::chrono::duration<double, std::milli>(query_duration).count() << " ms" << std::endl;
-
-    // Find true heavy hitters and their hot quadratic elements
-    std::map<uint32_t, uint32_t> true_heavy_hitters;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_hot_quad_elements;
-
-    for (const auto &[flow_id, flow_size]: flows) {
-        if (flow_size >= heavy_hitter_th) {
-            true_heavy_hitters[flow_id] = flow_size;
-
-            // Find true hot quadratic elements for this heavy hitter
-            if (quadratic_eles.count(flow_id)) {
-                for (const auto &[ele_id, ele_size]: quadratic_eles.at(flow_id)) {
-                    if (ele_size >= ele_th_phi * flow_size)
-                        true_hot_quad_elements[flow_id][ele_id] = ele_size;
-                }
-            }
-        }
-    }
-
-    // --- Heavy Hitter Evaluation ---
-
-    float hh_are_sum = 0.0f;
-    uint32_t hh_true_positives = 0;
-    for (const auto &[id, true_size]: true_heavy_hitters) {
-        if (queried_heavy_hitters.count(id)) {
-            uint32_t queried_size = queried_heavy_hitters.at(id);
-            hh_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-            hh_true_positives++;
-        }
-    }
-
-    float hh_are = (hh_true_positives > 0) ? hh_are_sum / hh_true_positives : 0.0f;
-    float hh_precision = (queried_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                              queried_heavy_hitters.size() : 0.0f;
-    float hh_recall = (true_heavy_hitters.size() > 0) ? static_cast<float>(hh_true_positives) /
-                                                        true_heavy_hitters.size() : 0.0f;
-    float hh_f1 = (hh_precision + hh_recall > 0) ? 2 * (hh_precision * hh_recall) / (hh_precision + hh_recall) : 0.0f;
-
-    std::cout << " - Heavy Hitter Metrics | ";
-    std::cout << "ARE: " << hh_are << ", ";
-    std::cout << "F1: " << hh_f1 << "\n";
-
-
-    // --- Quadratic Element Evaluation ---
-
-    float ele_are_sum = 0.0f;
-    uint32_t ele_true_positives = 0;
-    uint32_t total_queried_hot_ele_count = 0; // queried hot quadratic element count
-    uint32_t total_true_hot_ele_count = 0; // true hot quadratic element count
+size_t TwoDMisraGries::memory_bytes() const {
+    return memory.bytes();
+}
 
 
-    for (const auto &[flow_id, queried_elements]: queried_quad_elements) {
-        total_queried_hot_ele_count += queried_elements.size();
+void TwoDMisraGries::reset() {
+    num_slots = 0;
+    slots.clear();
+    for (uint32_t i = 0; i < index.size(); ++i) {
+        index[i].slot = EMPTY_SLOT;
     }
-
-
-    // Calculate ARE and True Positives
-    for (const auto &[flow_id, true_hot_elements]: true_hot_quad_elements) {
-        if (queried_quad_elements.count(flow_id)) {
-            const auto &queried_elements = queried_quad_elements.at(flow_id);
-            for (const auto &[ele_id, true_size]: true_hot_elements) {
-                if (queried_elements.count(ele_id)) {
-                    uint32_t queried_size = queried_elements.at(ele_id);
-                    ele_are_sum += std::abs(static_cast<float>(true_size) - queried_size) / true_size;
-                    ele_true_positives++;
-                }
-            }
-        }
-        total_true_hot_ele_count += true_hot_elements.size();
-    }
-
-
-
-    float ele_are = (ele_true_positives > 0) ? ele_are_sum / ele_true_positives : 0.0f;
-    float ele_precision = (total_queried_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) /
-                                                              total_queried_hot_ele_count : 0.0f;
-    float ele_recall = (total_true_hot_ele_count > 0) ? static_cast<float>(ele_true_positives) / total_true_hot_ele_count
-                                                      : 0.0f;
-    float ele_f1 = (ele_precision + ele_recall > 0) ? 2 * (ele_precision * ele_recall) / (ele_precision + ele_recall)
-                                                    : 0.0f;
-
-    std::cout << " - Heavy Quadratic Ele Metrics | ";
-    std::cout << "ARE: " << ele_are << ", ";
-    std::cout << "F1: " << ele_f1 << "\n";
-
-}
\ No newline at end of file
+}
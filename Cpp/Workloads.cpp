@@ -0,0 +1,141 @@
+#include "header/Workloads.h"
+#include "header/DualSketch.h"
+#include "header/MurmurHash3.h"
+#include <random>
+#include <unordered_set>
+
+
+namespace {
+
+// Distinct nonzero keys for i < 2^32 - 1: multiplication by an odd constant is a bijection
+uint32_t scramble(uint64_t i, uint32_t multiplier) {
+    return static_cast<uint32_t>((i + 1) * multiplier);
+}
+
+uint32_t random_key(std::mt19937_64& rng) {
+    uint32_t key;
+    do {
+        key = static_cast<uint32_t>(rng());
+    } while (key == 0);
+    return key;
+}
+
+uint32_t flow_hash(uint32_t x, uint32_t seed) {
+    uint32_t hash_val = 0;
+    MurmurHash3_x86_32(&x, sizeof(x), seed, &hash_val);
+    return hash_val;
+}
+
+
+// Flows that share HT bucket hash % m1 == target
+std::vector<uint32_t> bucket_colliders(const DualSketch& sketch, uint32_t count) {
+    std::vector<uint32_t> flows;
+    uint32_t target = sketch.heavy_buckets() / 2;
+    for (uint32_t x = 1; flows.size() < count && x != 0; ++x) {
+        if (flow_hash(x, sketch.hash_seed()) % sketch.heavy_buckets() == target) flows.push_back(x);
+    }
+    return flows;
+}
+
+
+// Flows in distinct HT buckets that share the QT window starting at hash % (m2 - k + 1) == target
+std::vector<uint32_t> window_colliders(const DualSketch& sketch, uint32_t count) {
+    std::vector<uint32_t> flows;
+    std::unordered_set<uint32_t> buckets;
+    uint32_t windows = sketch.quad_cells() - sketch.window_cells() + 1;
+    uint32_t target = windows / 2;
+    for (uint32_t x = 1; flows.size() < count && x != 0; ++x) {
+        uint32_t hash_val = flow_hash(x, sketch.hash_seed());
+        if (hash_val % windows == target && buckets.insert(hash_val % sketch.heavy_buckets()).second) {
+            flows.push_back(x);
+        }
+    }
+    return flows;
+}
+
+} // namespace
+
+
+const std::vector<Workload>& all_workloads() {
+    static const std::vector<Workload> workloads = {
+            Workload::Distinct, Workload::BucketCollision, Workload::WindowCollision,
+            Workload::SingleFlow, Workload::Churn};
+    return workloads;
+}
+
+
+const char* workload_name(Workload workload) {
+    switch (workload) {
+        case Workload::Distinct: return "distinct";
+        case Workload::BucketCollision: return "bucket-collision";
+        case Workload::WindowCollision: return "window-collision";
+        case Workload::SingleFlow: return "single-flow";
+        case Workload::Churn: return "churn";
+    }
+    return "";
+}
+
+
+bool parse_workload(const std::string& name, Workload& workload) {
+    for (Workload w: all_workloads()) {
+        if (name == workload_name(w)) {
+            workload = w;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+std::vector<Record> make_workload(Workload workload, const WorkloadConfig& config) {
+    std::vector<Record> records(config.records);
+    std::mt19937_64 rng(config.seed);
+
+    switch (workload) {
+        case Workload::Distinct: {
+            for (uint64_t i = 0; i < records.size(); ++i) {
+                records[i] = {scramble(i, 0x9e3779b1u), scramble(i, 0x85ebca6bu)};
+            }
+            break;
+        }
+
+        case Workload::BucketCollision:
+        case Workload::WindowCollision: {
+            DualSketch sketch(config.memory_kb);
+            std::vector<uint32_t> flows = workload == Workload::BucketCollision
+                                          ? bucket_colliders(sketch, config.colliding_flows)
+                                          : window_colliders(sketch, config.colliding_flows);
+            if (flows.empty()) flows.push_back(1);
+            for (uint64_t i = 0; i < records.size(); ++i) {
+                records[i] = {flows[i % flows.size()], scramble(i, 0x85ebca6bu)};
+            }
+            break;
+        }
+
+        case Workload::SingleFlow: {
+            for (uint64_t i = 0; i < records.size(); ++i) {
+                records[i] = {1, scramble(i, 0x85ebca6bu)};
+            }
+            break;
+        }
+
+        case Workload::Churn: {
+            // half of every phase goes to its heavy flows, each with a few hot elements
+            uint64_t phase_length = std::max<uint64_t>(1, records.size() / std::max(1u, config.churn_phases));
+            std::vector<uint32_t> heavy(std::max(1u, config.churn_heavy_flows));
+            for (uint64_t i = 0; i < records.size(); ++i) {
+                if (i % phase_length == 0) {
+                    for (auto& x: heavy) x = random_key(rng);
+                }
+                uint64_t r = rng();
+                if (r & 1) {
+                    records[i] = {heavy[(r >> 1) % heavy.size()], static_cast<uint32_t>((r >> 32) % 16 + 1)};
+                } else {
+                    records[i] = {random_key(rng), random_key(rng)};
+                }
+            }
+            break;
+        }
+    }
+    return records;
+}
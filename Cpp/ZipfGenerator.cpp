@@ -0,0 +1,218 @@
+#include "header/ZipfGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+// xoshiro256**, one instance per block
+class BlockRng {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    BlockRng(uint64_t seed, uint64_t block) {
+        uint64_t state = seed ^ (block * 0xd1342543de82ef95ULL);
+        for (auto& word: s) word = splitmix64(state);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // uniform in [0, 1)
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+
+// log1p(x) / x and expm1(x) / x, accurate near 0
+double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+// h(x) = x^-alpha, H its antiderivative (up to a constant) and H^-1 the inverse of H
+double h(double x, double alpha) {
+    return std::exp(-alpha * std::log(x));
+}
+
+double h_integral(double x, double alpha) {
+    double log_x = std::log(x);
+    return helper2((1.0 - alpha) * log_x) * log_x;
+}
+
+double h_integral_inverse(double x, double alpha) {
+    double t = std::max(-1.0, x * (1.0 - alpha));
+    return std::exp(helper1(t) * x);
+}
+
+// sum of k^-alpha over k > n, alpha > 1: the terms up to 1000 directly, the rest by Euler-Maclaurin
+double zeta_tail(double alpha, uint64_t n) {
+    constexpr uint64_t direct = 1000;
+    double sum = 0.0;
+    uint64_t m = n + 1;
+    for (; m < direct; ++m) sum += h(static_cast<double>(m), alpha);
+    double dm = static_cast<double>(m);
+    return sum + std::pow(dm, 1.0 - alpha) / (alpha - 1.0) + h(dm, alpha) / 2.0 + alpha * h(dm, alpha + 1.0) / 12.0;
+}
+
+} // namespace
+
+
+void ZipfGenerator::Dimension::init(double alpha, uint32_t maximum, ZipfTail tail) {
+    this->alpha = alpha;
+    this->maximum = std::max<uint32_t>(1, maximum);
+    this->tail = tail;
+
+    // P(rank > maximum) of the unbounded distribution, all of which lands on the maximum
+    p_clip = tail == ZipfTail::Clip && alpha > 1.0 ? zeta_tail(alpha, this->maximum) / zeta_tail(alpha, 0) : 0.0;
+
+    h_integral_x1 = h_integral(1.5, alpha) - 1.0;
+    h_integral_n = h_integral(this->maximum + 0.5, alpha);
+    s = 2.0 - h_integral_inverse(h_integral(2.5, alpha) - h(2.0, alpha), alpha);
+}
+
+
+template <typename Rng>
+uint32_t ZipfGenerator::Dimension::sample(Rng& rng) const {
+    if (p_clip > 0.0 && rng.uniform() < p_clip) return maximum;
+
+    // rejection-inversion, Hoermann and Derflinger (1996): inverts the continuous
+    // envelope H and accepts k unless it falls in the gap between h and the step function
+    while (true) {
+        double u = h_integral_n + rng.uniform() * (h_integral_x1 - h_integral_n);
+        double x = h_integral_inverse(u, alpha);
+        double k = std::min<double>(maximum, std::max(1.0, std::floor(x + 0.5)));
+        if (k - x <= s || u >= h_integral(k + 0.5, alpha) - h(k, alpha)) {
+            return static_cast<uint32_t>(k);
+        }
+    }
+}
+
+
+ZipfGenerator::ZipfGenerator(const ZipfConfig& config) : cfg(config) {
+    flow.init(cfg.flow_alpha, cfg.max_flow, cfg.tail);
+    element.init(cfg.element_alpha, cfg.max_element, cfg.tail);
+}
+
+
+std::string ZipfGenerator::validate() const {
+    for (const Dimension* dim: {&flow, &element}) {
+        const char* what = dim == &flow ? "flow" : "element";
+        if (!(dim->alpha > 0.0) || !std::isfinite(dim->alpha)) {
+            return std::string(what) + " alpha must be positive";
+        }
+        if (dim->tail == ZipfTail::Clip && !(dim->alpha > 1.0)) {
+            return std::string(what) + " alpha must be > 1 with a clipped tail (use the truncated tail)";
+        }
+    }
+    return {};
+}
+
+
+void ZipfGenerator::generate_block(uint64_t block, std::vector<Record>& out) const {
+    uint64_t begin = block * BLOCK_RECORDS;
+    size_t count = begin < cfg.records ? static_cast<size_t>(std::min<uint64_t>(BLOCK_RECORDS, cfg.records - begin)) : 0;
+
+    BlockRng rng(cfg.seed, block);
+    out.resize(count);
+    for (auto& [x, y]: out) {
+        x = flow.sample(rng);
+        y = element.sample(rng);
+    }
+}
+
+
+std::vector<Record> ZipfGenerator::generate(unsigned num_threads) const {
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = static_cast<unsigned>(std::min<uint64_t>(num_threads, std::max<uint64_t>(1, num_blocks())));
+
+    std::vector<Record> records(cfg.records);
+    auto fill = [&](unsigned t) {
+        std::vector<Record> block_records;
+        for (uint64_t block = t; block < num_blocks(); block += num_threads) {
+            generate_block(block, block_records);
+            std::copy(block_records.begin(), block_records.end(), records.begin() + block * BLOCK_RECORDS);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < num_threads; ++t) threads.emplace_back(fill, t);
+    fill(0);
+    for (auto& thread: threads) thread.join();
+    return records;
+}
+
+
+ZipfStream::ZipfStream(const ZipfGenerator& generator, unsigned num_threads)
+        : generator(generator) {
+    if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = static_cast<unsigned>(std::min<uint64_t>(num_threads, std::max<uint64_t>(1, generator.num_blocks())));
+
+    workers = std::vector<Worker>(num_threads);
+    for (unsigned t = 0; t < num_threads; ++t) {
+        for (int i = 0; i < 3; ++i) {
+            std::vector<Record> buffer;
+            buffer.reserve(ZipfGenerator::BLOCK_RECORDS);
+            workers[t].free.push(std::move(buffer));
+        }
+        workers[t].thread = std::thread(&ZipfStream::produce, this, t);
+    }
+}
+
+
+ZipfStream::~ZipfStream() {
+    // unblocks the workers if the consumer stopped early
+    for (auto& worker: workers) {
+        worker.full.close();
+        worker.free.close();
+    }
+    for (auto& worker: workers) {
+        if (worker.thread.joinable()) worker.thread.join();
+    }
+}
+
+
+void ZipfStream::produce(unsigned index) {
+    Worker& worker = workers[index];
+    for (uint64_t block = index; block < generator.num_blocks(); block += workers.size()) {
+        std::vector<Record> buffer;
+        if (!worker.free.pop(buffer)) return;
+        generator.generate_block(block, buffer);
+        if (!worker.full.push(std::move(buffer))) return;
+    }
+    worker.full.close();
+}
+
+
+bool ZipfStream::next(std::vector<Record>& chunk) {
+    if (next_block > 0 && chunk.capacity() > 0) {
+        chunk.clear();
+        workers[(next_block - 1) % workers.size()].free.push(std::move(chunk));
+    }
+    if (next_block >= generator.num_blocks()) return false;
+    if (!workers[next_block % workers.size()].full.pop(chunk)) return false;
+    ++next_block;
+    return true;
+}
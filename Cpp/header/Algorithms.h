@@ -0,0 +1,34 @@
+
+#ifndef ALGORITHMS_H
+#define ALGORITHMS_H
+
+#include <string>
+#include <vector>
+#include "Loaders.h"
+#include "Pipeline.h"
+#include "SketchDriver.h"
+#include "TraceStream.h"
+
+
+// Run-time table of the sketch types, for drivers that choose algorithms by name.
+// Each entry holds the driver templates instantiated for one type.
+struct Algorithm {
+    const char* name;  // Sketch::name(), e.g. "2D-MG"
+
+    RunResult (*run)(float memory_kb, const std::vector<Record>& dataset, const RunConfig& config);
+
+    RunResult (*stream)(float memory_kb, const std::vector<std::string>& file_paths, TraceFormat format,
+                        float phi_1, const RunConfig& config, const StreamConfig& stream_config);
+
+    PipelineResult (*pipeline)(float memory_kb, const std::vector<std::string>& file_paths, TraceFormat format,
+                               const RunConfig& config, const PipelineConfig& pipeline_config);
+};
+
+// DualSketch, DUET, GlobalHH, 2D-MG, CSSCHH
+const std::vector<Algorithm>& all_algorithms();
+
+// Case-insensitive lookup by name; "2dmg" and "mg" also match 2D-MG. nullptr if unknown.
+const Algorithm* find_algorithm(const std::string& name);
+
+
+#endif // ALGORITHMS_H
@@ -0,0 +1,96 @@
+
+#ifndef ALIGNEDBUFFER_H
+#define ALIGNEDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "TrackingAllocator.h"
+
+
+// A fixed-capacity, zero-initialized array of trivially copyable cells,
+// aligned to a cache line. Sketch tables are allocated once in the
+// constructor through this buffer and never grow afterwards. A buffer given a
+// MemoryTracker reports its block to it; a copy is not tracked.
+template <typename T, size_t Alignment = 64>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer holds plain table cells only");
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+private:
+    T* cells = nullptr;
+    size_t length = 0;
+    MemoryTracker* tracker = nullptr;
+
+    // std::aligned_alloc requires the size to be a multiple of the alignment
+    static size_t block_bytes(size_t n) { return (n * sizeof(T) + Alignment - 1) / Alignment * Alignment; }
+
+    void release() {
+        if (cells != nullptr && tracker != nullptr) tracker->remove(heap_block_bytes(cells, block_bytes(length)));
+        std::free(cells);
+    }
+
+public:
+    AlignedBuffer() = default;
+
+    explicit AlignedBuffer(size_t n, MemoryTracker* tracker = nullptr) : length(n), tracker(tracker) {
+        if (n == 0) return;
+        size_t bytes = block_bytes(n);
+        cells = static_cast<T*>(std::aligned_alloc(Alignment, bytes));
+        if (cells == nullptr) throw std::bad_alloc();
+        if (tracker != nullptr) tracker->add(heap_block_bytes(cells, bytes));
+        std::memset(static_cast<void*>(cells), 0, bytes);
+    }
+
+    ~AlignedBuffer() { release(); }
+
+    // deep copies, so that a whole sketch can be snapshotted
+    AlignedBuffer(const AlignedBuffer& other) : AlignedBuffer(other.length) {
+        if (length != 0) std::memcpy(static_cast<void*>(cells), other.cells, length * sizeof(T));
+    }
+
+    // keeps reporting to this buffer's tracker, like the standard containers
+    AlignedBuffer& operator=(const AlignedBuffer& other) {
+        if (this != &other) {
+            AlignedBuffer copy(other.length, tracker);
+            if (copy.length != 0) std::memcpy(static_cast<void*>(copy.cells), other.cells, copy.length * sizeof(T));
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+            : cells(std::exchange(other.cells, nullptr)), length(std::exchange(other.length, 0)),
+              tracker(other.tracker) {}
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            cells = std::exchange(other.cells, nullptr);
+            length = std::exchange(other.length, 0);
+            tracker = other.tracker;
+        }
+        return *this;
+    }
+
+    T& operator[](size_t i) { return cells[i]; }
+    const T& operator[](size_t i) const { return cells[i]; }
+
+    T* data() { return cells; }
+    const T* data() const { return cells; }
+
+    size_t size() const { return length; }
+    size_t bytes() const { return length * sizeof(T); }
+
+    // reset every cell to all-zero bits
+    void clear() {
+        if (cells != nullptr) std::memset(static_cast<void*>(cells), 0, length * sizeof(T));
+    }
+};
+
+
+#endif // ALIGNEDBUFFER_H
@@ -0,0 +1,149 @@
+
+#ifndef BLOCKREADER_H
+#define BLOCKREADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AlignedBuffer.h"
+
+
+struct BlockReaderConfig {
+    size_t block_bytes = 1 << 20;  // bytes per read
+    size_t headroom = 64 << 10;    // writable bytes in front of each block, see Block
+    unsigned queue_depth = 16;     // reads in flight (io_uring)
+    unsigned buffers = 32;         // blocks in flight plus blocks held by the consumer
+    bool use_io_uring = true;      // false: always use pread
+};
+
+
+// One block of a file. The 'headroom' bytes in front of data belong to the block too,
+// so a consumer can prepend the unfinished last line of the previous block in place.
+struct Block {
+    char* data = nullptr;
+    size_t size = 0;
+    uint32_t file = 0;     // index into the file list
+    uint64_t offset = 0;   // of data within the file
+    bool last = false;     // last block of its file
+    uint32_t buffer = 0;
+};
+
+
+/*
+ * Reads a list of files front to back in fixed-size blocks, with several reads in flight
+ * through io_uring (registered buffers and files, raw system calls, no liburing), and
+ * returns the blocks in file order. The reads of the next file are issued while the
+ * current one is still being consumed. Falls back to blocking pread() when io_uring is
+ * unavailable (old kernel, seccomp) or disabled.
+ *
+ * Blocks are handed out by next() on one thread and may be released on any thread.
+ */
+class BlockReader {
+private:
+    struct Pending {
+        uint32_t buffer;
+        uint32_t file;
+        uint64_t offset;
+        size_t length;   // bytes requested
+        size_t done;     // bytes read so far
+        bool complete;
+        int error;
+    };
+
+    struct Uring;
+
+    BlockReaderConfig config;
+    std::vector<int> fds;             // -1 for files that could not be opened
+    std::vector<uint64_t> sizes;
+
+    AlignedBuffer<char, 4096> memory; // 'buffers' slots of headroom + block_bytes
+    size_t slot_bytes = 0;
+    uint32_t buffer_count = 0;
+    std::vector<uint32_t> free_buffers;
+    std::mutex free_mutex;
+    std::condition_variable buffer_freed;
+
+    std::deque<Pending> in_flight;    // in file order
+    uint32_t next_file = 0;           // next block to schedule
+    uint64_t next_offset = 0;
+    int read_error = 0;
+
+    Uring* uring = nullptr;
+
+    bool schedule_next(uint32_t& file, uint64_t& offset, size_t& length);
+    bool take_free_buffer(uint32_t& buffer, bool wait);
+    char* block_data(uint32_t buffer) { return memory.data() + static_cast<size_t>(buffer) * slot_bytes + config.headroom; }
+
+    void submit_reads();
+    bool wait_front();
+    void submit(Pending& read);
+    void close_files();
+
+public:
+    explicit BlockReader(BlockReaderConfig config = {});
+    ~BlockReader();
+
+    BlockReader(const BlockReader&) = delete;
+    BlockReader& operator=(const BlockReader&) = delete;
+
+    // Opens every file of the list; files that cannot be opened are skipped (see is_open()).
+    void open(const std::vector<std::string>& file_paths);
+
+    bool is_open(uint32_t file) const { return fds[file] >= 0; }
+    uint64_t file_size(uint32_t file) const { return sizes[file]; }
+    bool using_io_uring() const { return uring != nullptr; }
+
+    // The next block in file order. An empty file yields one empty last block.
+    // Returns false after the last block, or on a read error (see error()).
+    bool next(Block& block);
+
+    // Gives a block's buffer back for further reads.
+    void release(const Block& block);
+
+    // errno of the first failed read, 0 if none
+    int error() const { return read_error; }
+};
+
+
+// A run of whole lines taken from one block: [begin, end) starts at 'offset' of its file.
+// The piece owns 'block' until it is released to the reader.
+struct LinePiece {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    uint64_t offset = 0;
+    Block block;
+};
+
+
+/*
+ * Cuts the blocks of a BlockReader at line boundaries. A piece ends after the last newline
+ * of its block, and the unfinished line is copied into the headroom of the next block of
+ * the same file, so no line is split across pieces. Optionally drops the first line of
+ * every file (CSV header). Must be used on the thread that calls BlockReader::next().
+ */
+class LineSplitter {
+private:
+    BlockReader& reader;
+    size_t headroom;
+    bool skip_header;
+    std::string carry;
+    bool skip_to_newline = false;  // the header line, or the rest of a dropped line, is still ahead
+    uint64_t dropped = 0;
+
+public:
+    LineSplitter(BlockReader& reader, size_t headroom, bool skip_header)
+            : reader(reader), headroom(headroom), skip_header(skip_header) {}
+
+    // The next non-empty piece; false at the end of the last file.
+    bool next(LinePiece& piece);
+
+    // lines longer than the headroom, which are dropped whole
+    uint64_t dropped_lines() const { return dropped; }
+};
+
+
+#endif // BLOCKREADER_H
@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <map>
 #include "utils.h"
+#include "Sketch.h"
+#include "TrackingAllocator.h"
 
 // An approximate implementation of the following paper's method:
 // “Fast and accurate mining of correlated heavy hitters”
@@ -27,24 +29,26 @@ struct STEntry {
     uint32_t counter;
 };
 
-class CSSCHH {
+class CSSCHH : public SketchBase<CSSCHH> {
 private:
 
     float ss1_hh_ratio;
 
-    uint32_t N;
+    uint32_t N; // number of updates so far
+
+    MemoryTracker memory; // every table below allocates through it
 
     // an approximate implementation of space-saving for heavy hitter
-    std::vector<SPEntry> ss1_heavy_hitter;
+    TrackedVector<SPEntry> ss1_heavy_hitter{memory.allocator()};
 
     // an approximate implementation of space-saving for quadratic elements
-    std::vector<STEntry> ss2_quad_ele;
+    TrackedVector<STEntry> ss2_quad_ele{memory.allocator()};
 
     // fast index for entry in ss1_heavy_hitter
-    std::unordered_map<uint32_t, uint32_t> key_to_index_ss1;
+    TrackedHashMap<uint32_t, uint32_t> key_to_index_ss1{memory.allocator()};
 
     // fast index for entry in ss2_quad_ele
-    std::unordered_map<uint64_t, uint32_t> key_to_index_ss2;
+    TrackedHashMap<uint64_t, uint32_t> key_to_index_ss2{memory.allocator()};
 
     uint32_t max_num_ss1; // parameter k1
 
@@ -65,11 +69,11 @@ public:
     std::pair<std::map<uint32_t, uint32_t>,
             std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th, float phi);
 
-    void evaluation(const std::vector<std::pair<uint32_t, uint32_t>>& dataset,
-                    const std::map<uint32_t, uint32_t>& flows,
-                    std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                    uint32_t heavy_hitter_th, float phi);
+    size_t memory_bytes() const;
+
+    void reset();
 
+    static const char* name() { return "CSSCHH"; }
 
 };
 
@@ -0,0 +1,60 @@
+
+#ifndef CONFIGRUNNER_H
+#define CONFIGRUNNER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Algorithms.h"
+#include "SketchDriver.h"
+
+
+/*
+ * Runs independent (algorithm, memory, RunConfig) jobs against one shared, read-only
+ * dataset. Every worker thread is pinned to its own core and takes the next job from a
+ * shared counter, so a sweep finishes in about (total run time / workers).
+ *
+ * Runs that share the machine disturb each other's caches and memory bandwidth, so the
+ * throughput of parallel runs is only indicative; accuracy is unaffected. With a single
+ * worker the jobs run one after the other on the calling thread, pinned to the first of
+ * the given cores (unpinned if none were given).
+ */
+
+struct RunJob {
+    const Algorithm* algorithm;
+    float memory_kb;
+    RunConfig config;
+};
+
+
+// Parses a CPU list such as "2-5,8". Returns false on malformed input.
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus);
+
+// The CPUs this process may run on
+std::vector<int> available_cpus();
+
+// Restricts the calling thread to 'cpu'. Returns false if the kernel refuses.
+bool pin_current_thread(int cpu);
+
+
+class ConfigRunner {
+private:
+    const std::vector<Record>& dataset;
+    bool pin;
+    std::vector<int> cpus;
+    unsigned workers;
+
+public:
+    // workers == 0 uses one worker per CPU; 'cpus' empty uses available_cpus().
+    // The dataset is referenced and must outlive the runner.
+    ConfigRunner(const std::vector<Record>& dataset, unsigned workers, std::vector<int> cpus = {});
+
+    unsigned worker_count() const { return workers; }
+    const std::vector<int>& cpu_list() const { return cpus; }
+
+    // Runs every job and returns the results in job order.
+    std::vector<RunResult> run(const std::vector<RunJob>& jobs) const;
+};
+
+
+#endif // CONFIGRUNNER_H
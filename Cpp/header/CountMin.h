@@ -9,24 +9,39 @@
 #include <unordered_set>
 #include <cmath>
 #include "MurmurHash3.h"
+#include "SketchKernels.h"
+#include "TrackingAllocator.h"
 #include <random>
 #include <vector>
 
 
 class CountMin {
     private:
-        int depth;
-        int width;
-        uint32_t counter_bits;
-        std::vector<std::vector<uint32_t>> counters;
+        int depth = 0;
+        int width = 0;
+        uint32_t counter_bits = 32;
+        TrackedVector<uint32_t> counters;  // depth rows of width counters, row-major
+        const SketchKernels* kernels = &sketch_kernels();
 
     public:
-        CountMin(float memory_kb);
+        CountMin() = default;
+
+        // the counters are reported to 'memory', the tracker of the sketch embedding it
+        explicit CountMin(float memory_kb, MemoryTracker* memory = nullptr);
 
         void update(const uint32_t flow_label, uint32_t weight= 1);
 
         uint32_t query(const uint32_t flow_label);
 
+        // query() before the update, for one pass over the rows instead of two
+        uint32_t query_update(const uint32_t flow_label, uint32_t weight = 1);
+
+        // query_update() of keys[0, n) in order, estimates[i] for keys[i]. Rows are
+        // independent, so each row is hashed for the whole batch at once.
+        void query_update_batch(const uint32_t* keys, size_t n, uint32_t* estimates);
+
+        void reset();
+
 };
 
 
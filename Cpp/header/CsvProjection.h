@@ -0,0 +1,46 @@
+
+#ifndef CSVPROJECTION_H
+#define CSVPROJECTION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KeySpec.h"
+
+
+/*
+ * A CSV line parser specialized for a set of key specs. compile() maps the header's
+ * column names to fields and keeps a parse function only for the columns some spec
+ * reads; parse_line() then splits each line only up to the last of those columns,
+ * parses the needed fields in place and skips the others, and projects the line once
+ * per spec. One pass over a file can thus feed several key projections.
+ */
+class CsvProjection {
+public:
+    using FieldParser = bool (*)(const char* begin, const char* end, uint64_t& value);
+
+private:
+    struct Column {
+        FieldParser parse;   // nullptr for columns no spec reads
+        Field field;
+    };
+
+    std::vector<Column> columns;  // up to and including the last needed column
+    std::vector<KeySpec> specs;
+    std::vector<uint32_t> spec_fields;  // used_fields() of each spec
+
+public:
+    // Returns false (and describes the problem in 'error') if a field some spec reads
+    // has no column in the header line [begin, end).
+    bool compile(const char* begin, const char* end, std::vector<KeySpec> key_specs, std::string* error = nullptr);
+
+    size_t num_outputs() const { return specs.size(); }
+
+    // Parses one line (without '\n') and appends its record to outs[i] for every spec i
+    // that accepts it. An empty field only drops the line for the specs reading it.
+    // Returns false if the line is malformed.
+    bool parse_line(const char* begin, const char* end, std::vector<Record>* outs) const;
+};
+
+
+#endif // CSVPROJECTION_H
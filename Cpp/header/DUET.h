@@ -7,51 +7,67 @@
 #include <cmath>
 #include <map>
 #include "utils.h"
+#include "AlignedBuffer.h"
+#include "CountMin.h"
+#include "Sketch.h"
+#include "SketchKernels.h"
+#include "TrackingAllocator.h"
 
 
-class CountMin;
-
-class DUET {
+class DUET : public SketchBase<DUET> {
 private:
 
     uint32_t Nth; // threshold for hot item/flow (i.e., heavy hitter)
 
-    struct Bucket {
-        uint64_t element; // identifier for (x, y)
-        uint32_t count;
-    };
+    MemoryTracker memory; // every table below allocates through it
+
+    CountMin count_min;
 
-    CountMin* count_min;
+    // Buckets are stored column-wise: identifiers for (x, y) and counts live in
+    // separate flat arrays, so a bucket costs exactly 64 + 32 bits and a row
+    // can be searched with vector loads.
 
-    // Filter
-    std::vector<std::vector<Bucket>> filter;
+    // Filter, row-major d_filter x w_filter
+    AlignedBuffer<uint64_t> filter_keys;
+    AlignedBuffer<uint32_t> filter_counts;
     int d_filter; // d rows
     int w_filter; // w columns
 
-    // STable
-    std::vector<std::vector<Bucket>> stable;
+    // STable, row-major l_stable x r_stride, where only the first r_stable columns are used
+    AlignedBuffer<uint64_t> stable_keys;
+    AlignedBuffer<uint32_t> stable_counts;
     int l_stable; // l rows
     int r_stable; // r columns
+    int r_stride; // r_stable rounded up, so that every row starts on a cache line
 
-    std::vector<uint32_t> rand_seeds; // random seeds
+    TrackedVector<uint32_t> rand_seeds{memory.allocator()}; // random seeds
+
+    const SketchKernels* kernels = &sketch_kernels(); // STable row scans
 
 public:
     explicit DUET(float memory_kb);
-    ~DUET();
 
     void update(uint32_t x, uint32_t y);
 
-    std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> query(uint32_t heavy_hitter_th, float phi);
+    // CountMin of a group first, then the filter and table per record
+    void update_batch(const Record* records, size_t n);
+
+    // hot quadratic elements keyed by combine_xy(x, y)
+    std::pair<std::map<uint32_t, uint32_t>, std::map<uint64_t, uint32_t>> query_combined(uint32_t heavy_hitter_th, float phi);
 
-    std::pair<std::map<uint32_t, uint32_t>, std::map<uint32_t, std::map<uint32_t, uint32_t>>> getHHAndHotQuadEle(uint32_t heavy_hitter_th, float phi);
+    std::pair<std::map<uint32_t, uint32_t>, std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th, float phi);
+
+    // update() once CountMin has counted x; cm_es is its estimate before
+    void update_estimated(uint32_t x, uint32_t y, uint32_t cm_es);
 
     void Insert2Filter(uint32_t x, uint32_t y);
     void Insert2Table(uint32_t x, uint32_t y, uint32_t count);
 
-    void evaluation(const std::vector<std::pair<uint32_t, uint32_t>>& dataset,
-                    const std::map<uint32_t, uint32_t>& flows,
-                    std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                    uint32_t heavy_hitter_th, float phi);
+    size_t memory_bytes() const;
+
+    void reset();
+
+    static const char* name() { return "DUET"; }
 
 };
 
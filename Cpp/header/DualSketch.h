@@ -1,11 +1,16 @@
 #ifndef DUALSKETCH_H
 #define DUALSKETCH_H
 
+#include <memory>
 #include <vector>
 #include <cstdint>
 #include <map>
 #include "utils.h"
 #include "MurmurHash3.h"
+#include "Sketch.h"
+#include "SketchKernels.h"
+#include "DualSketchStats.h"
+#include "TrackingAllocator.h"
 
 // Bucket in HeavyTable
 struct HTBucket {
@@ -27,12 +32,16 @@ struct QTCell {
     QTCell() : E(0), R(0), P(0) {}
 };
 
+static_assert(sizeof(QTCell) == 3 * sizeof(uint32_t), "the QT window kernels read cells as 3 words");
 
-class DualSketch {
+
+class DualSketch : public SketchBase<DualSketch> {
 private:
-    std::vector<HTBucket> heavy_table;
-    std::vector<QTCell> quad_table;
+    MemoryTracker memory; // both tables allocate through it
+    TrackedVector<HTBucket> heavy_table{memory.allocator()};
+    TrackedVector<QTCell> quad_table{memory.allocator()};
 
+    float memo_kb;
     uint32_t m1;
     uint32_t m2;
     uint32_t k;
@@ -41,22 +50,61 @@ private:
 
     uint32_t rand_seed;
 
+    const SketchKernels* kernels = &sketch_kernels(); // batch hashing and QT window scans
+
+    // the k cells of a window as the {E, R, P} words the kernels scan
+    uint32_t* qt_cells(uint32_t j_start) { return &quad_table[j_start].E; }
+
+    // update() once hash(x) is known; returns how the update ended
+    DualSketchEvent update_hashed(uint32_t x, uint32_t y, uint32_t hash_val);
+
 public:
 
-    DualSketch(float memory_kb);
+    static constexpr uint32_t DEFAULT_WINDOW = 32;
+
+    // 'window' is k, the QT cells a flow may use (4, 8, 16, 32, 64). It must be at least 1 and
+    // at most the number of QT cells; otherwise valid() is false and the sketch must not be updated.
+    DualSketch(float memory_kb, uint32_t window = DEFAULT_WINDOW);
 
     ~DualSketch();
 
     // x is flow label, y is element label, (x, y) equals (f, e)
     void update(uint32_t x, uint32_t y);
 
+    // update() that also returns how it ended (e.g. OwnerHit, OtherEvict), for latency by case
+    DualSketchEvent update_case(uint32_t x, uint32_t y);
+
+    // hashes a group of records ahead and prefetches their HT buckets and QT windows
+    void update_batch(const Record* records, size_t n);
+
     std::pair<std::map<uint32_t, uint32_t>,
-    std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th);
+    std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th, float phi) const;
+
+    // Adds the counts of a sketch of the same size, e.g. of another link or thread;
+    // false (and no change) if the sizes differ
+    bool merge(const DualSketch& other);
+
+    // A byte image of the tables, little-endian, for storing or shipping a sketch
+    size_t serialized_size() const;
+    void serialize(uint8_t* out) const;
+
+    // nullptr if 'data' is not a complete image written by serialize()
+    static std::unique_ptr<DualSketch> deserialize(const uint8_t* data, size_t size);
+
+    size_t memory_bytes() const;
+
+    void reset();
+
+    static const char* name() { return "DualSketch"; }
+
+    // table geometry and hash seed, for workloads that target given buckets or windows
+    uint32_t heavy_buckets() const { return m1; }
+    uint32_t quad_cells() const { return m2; }
+    uint32_t window_cells() const { return k; }
 
-    void evaluation(const std::vector<std::pair<uint32_t, uint32_t>>& dataset,
-                    const std::map<uint32_t, uint32_t>& flows,
-                    std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                    uint32_t heavy_hitter_th, float phi);
+    // whether the tables are usable: m1 > 0 and 1 <= k <= m2
+    bool valid() const { return m1 > 0 && k > 0 && m2 >= k; }
+    uint32_t hash_seed() const { return rand_seed; }
 
 };
 
@@ -0,0 +1,119 @@
+
+#ifndef DUALSKETCHSTATS_H
+#define DUALSKETCHSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+/*
+ * Event counters of the DualSketch update path, for tuning k and m_ht_frac to a link:
+ * how often each case fires and how it ends, how often a QT cell that decays to zero
+ * belonged to another flow and whether that flow then loses its HT entry, and at which
+ * window offset a Case 2 update finds its element.
+ *
+ * Compiled out unless DUALSKETCH_STATS is defined (cmake -DDUALSKETCH_STATS=ON); then
+ * count_event() is an empty inline function. When enabled, every thread bumps its own
+ * block of relaxed atomics (a plain load and store, no lock prefix, no shared cache
+ * lines), and dualsketch_stats() sums the blocks of all threads, including finished
+ * ones, at any time without stopping the updating threads.
+ */
+
+#ifdef DUALSKETCH_STATS
+constexpr bool dualsketch_stats_enabled = true;
+#else
+constexpr bool dualsketch_stats_enabled = false;
+#endif
+
+
+enum class DualSketchEvent {
+    Update,
+
+    EmptyBucket,    // Case 1: the HT bucket is empty
+    EmptyInsert,    //   a free QT cell took the element
+    EmptyDecay,     //   window full: its minimum cell decayed and survived
+    EmptyReplace,   //   window full: its minimum cell decayed to zero and took the element
+
+    OwnerUpdate,    // Case 2: the HT bucket holds x
+    OwnerHit,       //   y was found in the window
+    OwnerInsert,    //   a free QT cell took the element
+    OwnerDecay,     //   window full: its minimum cell decayed and survived
+    OwnerReplace,   //   window full: its minimum cell decayed to zero and took the element
+
+    OtherUpdate,    // Case 3: the HT bucket holds another flow
+    OtherDecay,     //   its count stayed positive; the record is dropped
+    OtherEvict,     //   its count reached zero; the flow is evicted from HT
+    ClearedCells,   //   QT cells of evicted flows that were cleared
+
+    CellSteal,      // Case 1/2 replace: the zeroed cell belonged to another flow x_clear
+    RescanFound,    //   x_clear still has a cell in its window and keeps its HT entry
+    RescanEvict,    //   x_clear has none left and is evicted from HT
+};
+
+constexpr size_t DUALSKETCH_EVENT_COUNT = 17;
+
+// window offsets are counted up to the largest supported k
+constexpr size_t DUALSKETCH_MAX_WINDOW = 64;
+
+const char* dualsketch_event_name(DualSketchEvent event);
+
+
+struct DualSketchStats {
+    std::array<uint64_t, DUALSKETCH_EVENT_COUNT> events{};
+    std::array<uint64_t, DUALSKETCH_MAX_WINDOW> hit_offsets{};  // Case 2 hits by window offset
+
+    uint64_t operator[](DualSketchEvent event) const { return events[static_cast<size_t>(event)]; }
+
+    // The events between an earlier reading and this one
+    DualSketchStats& operator-=(const DualSketchStats& earlier);
+};
+
+// The sum over all threads so far; all zero unless DUALSKETCH_STATS is defined.
+DualSketchStats dualsketch_stats();
+
+// Case mix, outcomes, steal / rescan rates and hit offset percentiles.
+void print_dualsketch_stats(const DualSketchStats& stats, std::ostream& out);
+
+
+namespace dualsketch_stats_detail {
+
+struct ThreadCounters {
+    std::array<std::atomic<uint64_t>, DUALSKETCH_EVENT_COUNT> events{};
+    std::array<std::atomic<uint64_t>, DUALSKETCH_MAX_WINDOW> hit_offsets{};
+
+    // register with, and on thread exit fold into, the process-wide sum
+    ThreadCounters();
+    ~ThreadCounters();
+};
+
+inline ThreadCounters& local() {
+    static thread_local ThreadCounters counters;
+    return counters;
+}
+
+// only the owning thread writes, so no read-modify-write is needed
+inline void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace dualsketch_stats_detail
+
+
+inline void count_event(DualSketchEvent event, uint64_t n = 1) {
+    if constexpr (dualsketch_stats_enabled) {
+        dualsketch_stats_detail::bump(dualsketch_stats_detail::local().events[static_cast<size_t>(event)], n);
+    }
+}
+
+inline void count_hit_offset(uint32_t offset) {
+    if constexpr (dualsketch_stats_enabled) {
+        size_t slot = offset < DUALSKETCH_MAX_WINDOW ? offset : DUALSKETCH_MAX_WINDOW - 1;
+        dualsketch_stats_detail::bump(dualsketch_stats_detail::local().hit_offsets[slot]);
+    }
+}
+
+
+#endif // DUALSKETCHSTATS_H
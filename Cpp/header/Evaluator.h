@@ -0,0 +1,58 @@
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "Sketch.h"
+#include "SketchDriver.h"
+#include "ExactCounter.h"
+
+
+// The exact answer for one (phi_1, phi_2) setting, stored as sorted flat arrays
+struct GroundTruth {
+    uint32_t heavy_hitter_th;
+    float phi;
+    std::vector<FlowCount> heavy_hitters;   // sorted by flow
+    std::vector<ElementCount> hot_elements; // sorted by (flow, element)
+};
+
+
+struct AccuracyMetrics {
+    float hh_are;
+    float hh_precision;
+    float hh_recall;
+    float hh_f1;
+
+    float ele_are;
+    float ele_precision;
+    float ele_recall;
+    float ele_f1;
+};
+
+
+// Scores sketch answers against the exact counts of the loaded dataset.
+// The true heavy hitters and hot elements are derived once per (heavy_hitter_th, phi),
+// and every answer is scored with a single merge-join over sorted arrays.
+class Evaluator {
+private:
+    const ExactCounts& counts;
+
+    std::map<std::pair<uint32_t, float>, GroundTruth> truths;
+
+public:
+    // The counts are referenced, not copied, and must outlive the evaluator
+    explicit Evaluator(const ExactCounts& counts);
+
+    const GroundTruth& truth(uint32_t heavy_hitter_th, float phi);
+
+    static AccuracyMetrics score(const GroundTruth& truth, const QueryResult& answer);
+
+    // Scores every run in parallel, one thread per run
+    static std::vector<AccuracyMetrics> score_all(const GroundTruth& truth, const std::vector<RunResult>& runs);
+};
+
+
+#endif // EVALUATOR_H
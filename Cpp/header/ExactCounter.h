@@ -0,0 +1,46 @@
+
+#ifndef EXACTCOUNTER_H
+#define EXACTCOUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Sketch.h"
+
+
+struct FlowCount {
+    uint32_t flow;
+    uint32_t count;
+};
+
+struct ElementCount {
+    uint32_t flow;
+    uint32_t element;
+    uint32_t count;
+};
+
+
+// Exact per-flow and per-(flow, element) counts of a dataset, as flat sorted arrays
+struct ExactCounts {
+    uint64_t total = 0;                 // number of records counted
+
+    std::vector<FlowCount> flows;       // sorted by flow
+    std::vector<ElementCount> elements; // sorted by (flow, element)
+
+    // elements of flows[i] are elements[flow_offsets[i], flow_offsets[i + 1])
+    std::vector<uint64_t> flow_offsets;
+};
+
+
+// Counts 'records' exactly: the (x, y) pairs are radix-sorted as 64-bit keys and
+// run-length encoded, all on 'num_threads' threads (0 for all hardware threads).
+ExactCounts count_exact(const std::vector<Record>& records, unsigned num_threads = 0);
+
+
+// Returns a description of the first difference between 'counts' and a
+// reference computed with std::map over 'records', or an empty string.
+std::string verify_exact(const std::vector<Record>& records, const ExactCounts& counts);
+
+
+#endif // EXACTCOUNTER_H
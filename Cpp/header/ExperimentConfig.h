@@ -0,0 +1,66 @@
+
+#ifndef EXPERIMENTCONFIG_H
+#define EXPERIMENTCONFIG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Algorithms.h"
+#include "ConfigRunner.h"
+#include "KeySpec.h"
+#include "Loaders.h"
+#include "SketchKernels.h"
+
+
+enum class ExperimentMode {
+    Batch,     // load once with ground truth, then run every configuration (default)
+    Stream,    // read the trace in chunks per run, no ground truth
+    Pipeline,  // concurrent read / parse / [count] / update stages per run
+};
+
+
+// Everything HH_QuadraticEle takes from its command line; the defaults reproduce the
+// experiment that main() used to hard-code.
+struct ExperimentConfig {
+    ExperimentMode mode = ExperimentMode::Batch;
+
+    TraceFormat format = TraceFormat::CAIDA;
+    std::vector<std::string> files;        // empty: the loader's default files
+    bool has_key_spec = false;
+    KeySpec key_spec;                      // MAWI and pcap only
+    IoBackend io_backend = IoBackend::Mmap;
+    bool use_cache = true;
+    bool verify_cache = false;             // also compare source checksums with the caches
+
+    std::vector<const Algorithm*> algorithms;    // default: all_algorithms()
+    std::vector<float> memory_kb = {100, 200, 300, 400};
+    std::vector<float> phi_1 = {0.0001};         // heavy hitter threshold, fraction of N
+    std::vector<float> phi_2 = {0.1};            // hot element threshold, fraction of the heavy hitter
+    size_t batch_size = 1024;                    // records per update_batch() call, 0 for update()
+    unsigned threads = 0;                        // loading and exact counting, 0 for all hardware threads
+    unsigned repeat = 1;                         // runs per configuration
+    uint32_t latency_sample = 0;                 // batch mode: time one update in this many, 0 for none
+    unsigned parallel = 1;                       // concurrent runs in batch mode, 0 for one per core
+    std::vector<int> cores;                      // cores to pin runs to, empty for any
+    bool has_isa = false;
+    Isa isa = Isa::Baseline;                     // sketch kernel level, default detected (header/SketchKernels.h)
+
+    // pipeline mode
+    bool exact_count = false;
+    double report_interval_s = 0;
+
+    // machine-readable results (header/ResultLog.h), empty for none
+    std::string json_path;
+    std::string csv_path;
+};
+
+
+// Parses argv into 'config'. On failure returns false with a message in 'error';
+// '--help' also returns false, with an empty error.
+bool parse_experiment_args(int argc, char** argv, ExperimentConfig& config, std::string& error);
+
+void print_experiment_usage(const char* program);
+
+
+#endif // EXPERIMENTCONFIG_H
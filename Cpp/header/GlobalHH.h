@@ -9,6 +9,8 @@
 #include <map>
 #include "CountMin.h"
 #include "utils.h"
+#include "Sketch.h"
+#include "TrackingAllocator.h"
 
 
 struct Entry {
@@ -17,17 +19,19 @@ struct Entry {
 
 };
 
-class GlobalHH {
+class GlobalHH : public SketchBase<GlobalHH> {
 private:
 
     float cm_ratio;
 
-    CountMin* count_min; // use a count-min for flow size estimation, as did in DUET
+    MemoryTracker memory; // every table below allocates through it
+
+    CountMin count_min; // use a count-min for flow size estimation, as did in DUET
 
     // an approximate implementation of space-saving
-    std::vector<Entry> space_saving;
+    TrackedVector<Entry> space_saving{memory.allocator()};
 
-    std::unordered_map<uint64_t, uint32_t> key_to_index;
+    TrackedHashMap<uint64_t, uint32_t> key_to_index{memory.allocator()};
 
     uint32_t max_num; // max number for stored (x, y)
 
@@ -43,11 +47,11 @@ public:
     std::pair<std::map<uint32_t, uint32_t>,
             std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th, float phi);
 
-    void evaluation(const std::vector<std::pair<uint32_t, uint32_t>>& dataset,
-                    const std::map<uint32_t, uint32_t>& flows,
-                    std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                    uint32_t heavy_hitter_th, float phi);
+    size_t memory_bytes() const;
+
+    void reset();
 
+    static const char* name() { return "GlobalHH"; }
 
 };
 
@@ -0,0 +1,74 @@
+
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Just enough JSON for the result files (header/ResultLog.h): a streaming writer with
+// two-space indentation, and a parser into a plain value tree for reading them back.
+
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& out) : out(out) {}
+
+    JsonWriter& begin_object() { return open('{'); }
+    JsonWriter& end_object() { return close('}'); }
+    JsonWriter& begin_array() { return open('['); }
+    JsonWriter& end_array() { return close(']'); }
+
+    // the key of the next value inside an object
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const std::string& text);
+    JsonWriter& value(const char* text) { return value(std::string(text)); }
+    JsonWriter& value(double number);  // NaN and infinities are written as null
+    JsonWriter& value(float number);   // ... with the digits of a float, 0.1f as 0.1
+    JsonWriter& value(uint64_t number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+    // Arrays of numbers are written on one line
+    JsonWriter& value(const std::vector<double>& numbers);
+
+private:
+    std::ostream& out;
+    std::vector<bool> has_items;  // per open container
+    bool after_key = false;
+
+    void separate();
+    JsonWriter& open(char bracket);
+    JsonWriter& close(char bracket);
+    void newline();
+};
+
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;  // in file order
+
+    // The member 'name' of an object, nullptr if absent or not an object
+    const JsonValue* find(const std::string& name) const;
+
+    double number_or(const std::string& name, double fallback) const;
+    std::string string_or(const std::string& name, const std::string& fallback) const;
+};
+
+// On failure returns false with the reason and byte offset in 'error'.
+bool parse_json(const std::string& text, JsonValue& value, std::string& error);
+
+// 'text' with the escapes a JSON string needs, without the quotes
+std::string json_escape(const std::string& text);
+
+
+#endif // JSON_H
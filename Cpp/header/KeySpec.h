@@ -0,0 +1,76 @@
+
+#ifndef KEYSPEC_H
+#define KEYSPEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Sketch.h"
+
+
+// Packet header fields a (flow, element) key can be built from.
+// Shared by every reader that sees more than two columns per packet.
+enum class Field : uint8_t {
+    SrcIp, DstIp, Protocol, SrcPort, DstPort, Timestamp, Length, Ttl, Flags,
+};
+
+constexpr size_t FIELD_COUNT = 9;
+
+// "src_ip", "dst_ip", "protocol", "src_port", "dst_port", "timestamp", "length", "ttl", "flags"
+const char* field_name(Field field);
+bool parse_field_name(const std::string& name, Field& field);
+
+
+// One packet's field values; timestamp is in nanoseconds, IPv4 addresses in host order.
+struct FieldValues {
+    uint64_t value[FIELD_COUNT];
+
+    uint64_t& operator[](Field f) { return value[static_cast<size_t>(f)]; }
+    uint64_t operator[](Field f) const { return value[static_cast<size_t>(f)]; }
+};
+
+
+struct FieldFilter {
+    enum class Op : uint8_t { Eq, Ne, Lt, Le, Gt, Ge };
+    Field field;
+    Op op;
+    uint64_t operand;
+};
+
+
+/*
+ * Which fields form the flow key and the element key, and which packets are kept.
+ * Written as ';'-separated clauses, e.g.
+ *
+ *   flow=src_ip;element=dst_port;protocol==tcp
+ *   flow=dst_ip;element=src_ip
+ *   flow=src_ip+protocol;element=dst_ip+dst_port;ttl<64
+ *
+ * A key made of one field is that field's value (truncated to 32 bits); a key made of
+ * several is a hash of their values. Filters compare a field with ==, !=, <, <=, > or >=
+ * ('=' is ==) against a number, a dotted quad, or tcp/udp/icmp/icmpv6 in any case.
+ * Packets whose flow or element key is 0 are rejected, as in the plain loaders.
+ */
+struct KeySpec {
+    std::vector<Field> flow;
+    std::vector<Field> element;
+    std::vector<FieldFilter> filters;
+
+    // The fields read by the spec, as a bitmask of 1 << Field
+    uint32_t used_fields() const;
+
+    bool accepts(const FieldValues& values) const;
+
+    // Appends the (flow, element) record of an accepted packet to 'out'; returns false otherwise.
+    bool project(const FieldValues& values, std::vector<Record>& out) const;
+};
+
+// Parses the clause syntax above. On failure returns false and describes the problem in 'error'.
+bool parse_key_spec(const std::string& text, KeySpec& spec, std::string* error = nullptr);
+
+// flow=src_ip;element=dst_ip, the key of the original loaders
+KeySpec default_key_spec();
+
+
+#endif // KEYSPEC_H
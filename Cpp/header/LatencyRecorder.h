@@ -0,0 +1,133 @@
+
+#ifndef LATENCYRECORDER_H
+#define LATENCYRECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+
+/*
+ * Per-operation latency with little overhead: operations are timed with the time-stamp
+ * counter (rdtsc, fenced so the timed work cannot drift across it) and recorded into a
+ * log-bucketed histogram in the style of HdrHistogram: 16 linear sub-buckets per power
+ * of two, so every value is kept within 6.25% at a fixed 7.8 KB, whatever the count.
+ *
+ * A LatencySampler picks which operations to time, one in 'rate' on average with random
+ * gaps so that periodic patterns in the input are not aliased. The cost of reading the
+ * counter twice is measured once and subtracted from every sample.
+ */
+
+// Fenced time-stamp counter reads around a timed operation (steady_clock ns elsewhere)
+inline uint64_t latency_ticks_begin() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline uint64_t latency_ticks_end() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    uint64_t ticks = __rdtscp(&aux);
+    _mm_lfence();
+    return ticks;
+#else
+    return latency_ticks_begin();
+#endif
+}
+
+// Counter ticks per nanosecond, calibrated against steady_clock on first use
+double latency_ticks_per_ns();
+
+// Median ticks of an empty begin / end pair, measured on first use
+uint64_t latency_tick_overhead();
+
+
+struct LatencyStats {
+    uint64_t samples;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+};
+
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+    LatencyHistogram() : counts(BUCKETS, 0) {}
+
+    // Adds a sample of 'ticks' (begin to end), less the measurement overhead
+    void record(uint64_t ticks) {
+        uint64_t overhead = latency_tick_overhead();
+        uint64_t value = ticks > overhead ? ticks - overhead : 0;
+        counts[bucket(value)]++;
+        total++;
+        if (value > max_value) max_value = value;
+    }
+
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total; }
+
+    // The value (in ticks) at quantile q: the midpoint of the bucket holding it
+    uint64_t value_at(double q) const;
+
+    LatencyStats stats() const;
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+
+    static size_t bucket(uint64_t value) {
+        if (value < (1u << SUB_BITS)) return static_cast<size_t>(value);
+        unsigned shift = 63 - __builtin_clzll(value) - SUB_BITS;
+        return ((static_cast<size_t>(shift) + 1) << SUB_BITS) + ((value >> shift) & ((1u << SUB_BITS) - 1));
+    }
+};
+
+
+// Chooses the operations to time: one in 'rate' on average (every one if rate <= 1)
+class LatencySampler {
+private:
+    uint32_t rate;
+    uint64_t state;
+    uint64_t countdown;
+
+    uint64_t next_gap() {
+        if (rate <= 1) return 1;
+        // xorshift64; gaps uniform in [1, 2 * rate - 1]
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return 1 + state % (2 * static_cast<uint64_t>(rate) - 1);
+    }
+
+public:
+    explicit LatencySampler(uint32_t rate, uint64_t seed = 0x9e3779b97f4a7c15ULL)
+            : rate(rate), state(seed | 1) {
+        countdown = next_gap();
+    }
+
+    // true if the next operation should be timed
+    bool sample() {
+        if (--countdown > 0) return false;
+        countdown = next_gap();
+        return true;
+    }
+};
+
+
+#endif // LATENCYRECORDER_H
@@ -0,0 +1,82 @@
+
+#ifndef LIVECAPTURE_H
+#define LIVECAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KeySpec.h"
+#include "Sketch.h"
+
+
+// Linux only: packets are taken from an AF_PACKET socket with a TPACKET_V3 receive ring.
+
+struct LiveCaptureConfig {
+    std::string interface;          // e.g. "eth0", "lo", "veth0"
+    uint32_t block_size = 1 << 22;  // bytes per ring block, a multiple of the page size
+    uint32_t block_count = 64;
+    uint32_t frame_size = 2048;     // minimum frame slot, only used to size the ring
+    uint32_t block_timeout_ms = 10; // the kernel retires a partly filled block after this time
+    int fanout_group = -1;          // >= 0: join this PACKET_FANOUT group (hash mode)
+};
+
+
+/*
+ * One capture socket and its memory-mapped ring. The kernel fills ring blocks with
+ * packets; next_block() waits for a retired block, decodes every packet in place
+ * (see decode_packet() in PcapReader.h) into records, and hands the block back.
+ *
+ * With fanout_group set, several LiveCapture objects (typically one per thread)
+ * share the interface's traffic, split by flow hash.
+ */
+class LiveCapture {
+public:
+    struct Stats {
+        uint64_t blocks = 0;
+        uint64_t packets = 0;         // packets seen in the ring
+        uint64_t decoded = 0;         // packets with an IP header
+        uint64_t bytes = 0;           // wire length of the packets seen
+        uint64_t kernel_packets = 0;  // PACKET_STATISTICS, accumulated
+        uint64_t kernel_drops = 0;
+        uint64_t freeze_count = 0;    // times the ring was full
+        uint64_t block_ns_total = 0;  // time spent decoding blocks
+        uint64_t block_ns_max = 0;
+    };
+
+private:
+    int fd = -1;
+    uint8_t* ring = nullptr;
+    size_t ring_bytes = 0;
+    uint32_t block_size = 0;
+    uint32_t block_count = 0;
+    uint32_t next_index = 0;  // ring block to wait for next
+    uint32_t linktype = 0;
+    Stats counters;
+
+public:
+    LiveCapture() = default;
+    ~LiveCapture();
+
+    LiveCapture(const LiveCapture&) = delete;
+    LiveCapture& operator=(const LiveCapture&) = delete;
+
+    // Opens the socket, maps the ring and binds to the interface (needs CAP_NET_RAW).
+    // On failure returns false with a reason in 'error'.
+    bool open(const LiveCaptureConfig& config, std::string* error = nullptr);
+
+    void close();
+
+    // Waits up to 'timeout_ms' for the next block and appends the records of its packets
+    // that 'spec' accepts. Returns the number of packets in the block, 0 on timeout,
+    // or -1 if the socket failed.
+    int next_block(const KeySpec& spec, std::vector<Record>& out, int timeout_ms);
+
+    // Reads (and resets) the kernel's packet and drop counters into stats()
+    void update_kernel_stats();
+
+    const Stats& stats() const { return counters; }
+};
+
+
+#endif // LIVECAPTURE_H
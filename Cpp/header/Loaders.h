@@ -0,0 +1,134 @@
+
+#ifndef LOADERS_H
+#define LOADERS_H
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Sketch.h"
+#include "ExactCounter.h"
+#include "KeySpec.h"
+
+
+// Each loader reads (flow, element) records from its files and counts them exactly.
+// A text file "<file>" is read from its binary conversion "<file>.bin" when that is
+// up to date (same source size and mtime, same format and parser version), and
+// converted on first use otherwise.
+
+enum class TraceFormat { CAIDA, MAWI, FIMI, Synthetic, Pcap, Binary };
+
+// "caida", "mawi", "fimi", "synthetic", "pcap" or "bin"
+bool parse_trace_format(const std::string &name, TraceFormat &format);
+const char* trace_format_name(TraceFormat format);
+
+// Parses one file of the given format into 'records' (appending), ignoring any cache.
+bool parse_trace_file(const std::string &file_path, TraceFormat format,
+                      std::vector<Record> &records, uint64_t &skipped_lines);
+
+// How the loaders read text files: one mmap per file (default), or fixed-size blocks
+// read with io_uring (falling back to pread where io_uring is unavailable), or pread.
+enum class IoBackend { Mmap, IoUring, Pread };
+
+// "mmap", "uring" or "pread"
+bool parse_io_backend(const std::string &name, IoBackend &backend);
+void set_io_backend(IoBackend backend);
+
+// Threads the loaders use for parsing and exact counting, 0 (default) for all hardware threads
+void set_loader_threads(unsigned num_threads);
+
+// Parses the files in order through the given backend, appending to 'records', ignoring any cache.
+// Returns false if a file could not be read.
+bool parse_trace_files(const std::vector<std::string> &file_paths, TraceFormat format, IoBackend backend,
+                       std::vector<Record> &records, uint64_t &skipped_lines);
+
+// Where the binary cache of 'source_path' lives
+std::string trace_cache_path(const std::string &source_path);
+
+// Turns the automatic .bin cache on (default) or off for the loaders
+void set_trace_cache_enabled(bool enabled);
+bool trace_cache_enabled();
+
+// Also compares a checksum of the whole source with the one a cache recorded (default off)
+void set_trace_cache_verify(bool verify);
+
+// Recorded in a cache, which is only used by the same format at the same parser version.
+// A parser's version is raised whenever it changes the records it produces.
+uint16_t trace_format_id(TraceFormat format);
+uint32_t trace_parser_version(TraceFormat format);
+
+// True if the cache of 'source_path' is up to date and was parsed as 'format' by this parser
+bool trace_cache_current(const std::string &source_path, TraceFormat format);
+
+// Parser of one text line (without '\n') at byte 'offset' of its file; appends the
+// line's record to 'out' and returns true, or returns false if the line is invalid.
+using LineParser = bool (*)(const char *begin, const char *end, uint64_t offset, std::vector<Record> &out);
+
+// The line parser of a text format, nullptr for TraceFormat::Pcap and TraceFormat::Binary
+LineParser line_parser(TraceFormat format);
+
+// True if files of this format start with a header line to skip
+bool has_header_line(TraceFormat format);
+
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetCAIDA(
+        const std::vector<std::string> &file_paths = {
+                "./dataset/CAIDA2019/file1.txt",
+                "./dataset/CAIDA2019/file2.txt",
+                // your dataset file list
+        });
+
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetMAWI(
+        const std::vector<std::string> &file_paths = {
+                // your dataset file list
+                "./dataset/MAWI2024/parsed_mawi_2024.csv",
+        });
+
+// MAWI with a key spec such as "flow=src_ip;element=dst_port;protocol==tcp" (see KeySpec.h)
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetMAWI(const std::vector<std::string> &file_paths,
+                                                             const KeySpec &spec);
+
+// One pass over the MAWI files for several key specs; result i holds the records of specs[i]
+std::vector<std::vector<Record>> projectDataSetMAWI(const std::vector<std::string> &file_paths,
+                                                    const std::vector<KeySpec> &specs);
+
+std::tuple<std::vector<Record>, ExactCounts> loadDatasetFreqItemMining(
+        const std::vector<std::string> &file_paths = {
+                "./dataset/Frequent Itemset Mining Dataset Repository/kosarak.dat",
+                "./dataset/Frequent Itemset Mining Dataset Repository/pumsb.dat",
+                "./dataset/Frequent Itemset Mining Dataset Repository/pumsb_star.dat",
+                "./dataset/Frequent Itemset Mining Dataset Repository/T10I4D100K.dat",
+                "./dataset/Frequent Itemset Mining Dataset Repository/T40I10D100K.dat",
+                "./dataset/Frequent Itemset Mining Dataset Repository/webdocs.dat",
+        });
+
+std::tuple<std::vector<Record>, ExactCounts> loadSyntheticDataset(
+        const std::vector<std::string> &file_paths = {
+                "./dataset/SyntheticDataset/skewed_dataset_zipf01.txt"
+        });
+
+
+// Packet captures (pcap or pcapng), keyed by (src_ip, dst_ip) or by 'spec'.
+// Only the default key is cached as .bin.
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetPcap(const std::vector<std::string> &file_paths);
+
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetPcap(const std::vector<std::string> &file_paths,
+                                                             const KeySpec &spec);
+
+
+// Binary traces, see TraceFile.h
+std::tuple<std::vector<Record>, ExactCounts> loadDataSetBinary(const std::vector<std::string> &file_paths);
+
+
+// The loader of 'format'
+std::tuple<std::vector<Record>, ExactCounts> loadDataSet(const std::vector<std::string> &file_paths,
+                                                         TraceFormat format);
+
+// Key specs select the keys of MAWI and pcap input only
+bool key_spec_applies(TraceFormat format);
+
+// The loader of 'format' with the keys of 'spec'; other formats are an error (no records)
+std::tuple<std::vector<Record>, ExactCounts> loadDataSet(const std::vector<std::string> &file_paths,
+                                                         TraceFormat format, const KeySpec &spec);
+
+
+#endif // LOADERS_H
@@ -0,0 +1,42 @@
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+
+// Read-only memory mapping of a whole file. Empty files map to (nullptr, 0).
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    int fd = -1;
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false (and leaves the object closed) if the file cannot be opened or mapped
+    bool open(const std::string& path);
+
+    void close();
+
+    bool is_open() const { return fd >= 0; }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Hints the kernel that the mapping is read front to back
+    void advise_sequential() const;
+
+    // Drops the resident pages fully inside [offset, offset + len) from the mapping,
+    // so a front-to-back reader of a large file keeps a bounded footprint
+    void release(size_t offset, size_t len) const;
+};
+
+
+#endif // MAPPEDFILE_H
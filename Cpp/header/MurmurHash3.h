@@ -24,6 +24,8 @@ typedef unsigned __int64 uint64_t;
 
 #endif // !defined(_MSC_VER)
 
+#include <stddef.h>
+
 //-----------------------------------------------------------------------------
 
 void MurmurHash3_x86_32  ( const void * key, int len, uint32_t seed, void * out );
@@ -32,6 +34,10 @@ void MurmurHash3_x86_128 ( const void * key, int len, uint32_t seed, void * out
 
 void MurmurHash3_x64_128 ( const void * key, int len, uint32_t seed, void * out );
 
+// MurmurHash3_x86_32 of 'count' 4-byte keys with one seed: out[i] is the hash of keys[i],
+// bit for bit. 16 keys per step with AVX-512, 8 with AVX2, one without (header/SketchKernels.h).
+void MurmurHash3_x86_32_keys ( const uint32_t * keys, size_t count, uint32_t seed, uint32_t * out );
+
 //-----------------------------------------------------------------------------
 
 #endif // _MURMURHASH3_H_
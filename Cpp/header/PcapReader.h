@@ -0,0 +1,88 @@
+
+#ifndef PCAPREADER_H
+#define PCAPREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "KeySpec.h"
+#include "MappedFile.h"
+#include "Sketch.h"
+#include "TraceFile.h"
+
+
+/*
+ * Reads classic pcap (microsecond or nanosecond, either byte order) and pcapng captures
+ * straight from a read-only mapping. Packets are decoded in place, down to the IPv4/IPv6
+ * and TCP/UDP/SCTP headers, into FieldValues, and projected to records by a KeySpec.
+ *
+ * Link types: Ethernet (with any number of 802.1Q/802.1ad tags), raw IP, Linux cooked
+ * capture (v1 and v2) and BSD loopback. IPv6 addresses are folded to 32 bits by hashing,
+ * since records hold 32-bit keys. Non-IP packets and packets truncated before the IP
+ * addresses are skipped; ports and TCP flags of non-first fragments or of packets
+ * truncated before them count as missing, which drops the packet for specs that read them.
+ */
+class PcapReader {
+public:
+    struct Stats {
+        uint64_t packets = 0;   // packet records in the file
+        uint64_t decoded = 0;   // packets with an IP header
+        uint64_t non_ip = 0;    // other or truncated packets
+    };
+
+private:
+    struct Interface {
+        uint32_t linktype;
+        bool ts_pow2;       // if_tsresol: units are 2^-ts_exp s, else 10^-ts_exp s
+        uint8_t ts_exp;
+    };
+
+    MappedFile file;
+    const uint8_t* begin = nullptr;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    size_t released = 0;
+
+    bool pcapng = false;
+    bool swapped = false;               // file byte order differs from the host
+    std::vector<Interface> interfaces;  // pcap: the single link type; pcapng: per section
+    Stats counters;
+
+    uint16_t rd16(const uint8_t* p) const;
+    uint32_t rd32(const uint8_t* p) const;
+
+    // Next packet of the capture, still undecoded; false at the end or on a damaged record
+    bool next_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                     uint64_t& timestamp_ns, const Interface*& iface);
+    bool next_pcap_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                          uint64_t& timestamp_ns, const Interface*& iface);
+    bool next_pcapng_packet(const uint8_t*& data, uint32_t& caplen, uint32_t& origlen,
+                            uint64_t& timestamp_ns, const Interface*& iface);
+    void release_consumed();
+
+public:
+    // Maps the capture and reads its file header. On failure returns false with a reason in 'error'.
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    // Decodes the next IP packet into 'values'; sets the bits of fields the packet lacks in 'missing'.
+    // Returns false at the end of the capture.
+    bool next(FieldValues& values, uint32_t& missing);
+
+    // Appends the records of the following packets (and, if 'extras' is given, their
+    // timestamps and IP lengths) until 'max_records' were appended or the capture ends.
+    // Returns the number appended; 0 means the capture is exhausted.
+    size_t read_batch(const KeySpec& spec, std::vector<Record>& out, size_t max_records,
+                      TraceExtras* extras = nullptr);
+
+    const Stats& stats() const { return counters; }
+    size_t bytes() const { return file.size(); }
+};
+
+
+// Decodes one link-layer frame of the given pcap LINKTYPE_* into 'values'.
+// Returns false for non-IP frames and frames truncated before the IP addresses.
+bool decode_packet(uint32_t linktype, const uint8_t* data, uint32_t caplen, FieldValues& values, uint32_t& missing);
+
+
+#endif // PCAPREADER_H
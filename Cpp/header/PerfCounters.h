@@ -0,0 +1,75 @@
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/*
+ * Hardware performance counters of the calling thread, read through perf_event_open(2):
+ * cycles, instructions, L1d read misses, last-level cache misses, dTLB read misses and
+ * branch misses, plus page faults (a software event, so also available in most VMs).
+ *
+ * Every event is opened on its own rather than as one group, so a PMU with fewer counters
+ * than events multiplexes them instead of refusing the group; counts are scaled by
+ * time_enabled / time_running. Events the kernel refuses (no PMU, perf_event_paranoid,
+ * seccomp) are simply missing, and a benchmark falls back to reporting time only.
+ * User-space events only, so perf_event_paranoid <= 2 suffices.
+ */
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    DtlbMisses,
+    BranchMisses,
+    PageFaults,
+};
+
+constexpr size_t PERF_EVENT_COUNT = 7;
+
+// Short column name, e.g. "LLC miss"
+const char* perf_event_name(PerfEvent event);
+
+
+struct PerfSample {
+    std::array<double, PERF_EVENT_COUNT> values{};
+    std::array<bool, PERF_EVENT_COUNT> valid{};
+
+    double operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+    bool has(PerfEvent event) const { return valid[static_cast<size_t>(event)]; }
+};
+
+
+class PerfCounters {
+private:
+    std::array<int, PERF_EVENT_COUNT> fds;
+    std::string error;  // why the first refused event was refused
+
+public:
+    // Opens every event it can; never fails.
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool has(PerfEvent event) const { return fds[static_cast<size_t>(event)] >= 0; }
+    bool has_hardware() const { return has(PerfEvent::Cycles) || has(PerfEvent::Instructions); }
+
+    // Empty if every event opened
+    const std::string& status() const { return error; }
+
+    // Zeroes and enables the counters
+    void start();
+
+    // Disables the counters and returns their counts since start()
+    PerfSample stop();
+};
+
+
+#endif // PERFCOUNTERS_H
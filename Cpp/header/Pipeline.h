@@ -0,0 +1,297 @@
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DualSketchStats.h"
+#include "ExactCounter.h"
+#include "Loaders.h"
+#include "Sketch.h"
+#include "SketchDriver.h"
+#include "SpscQueue.h"
+
+
+/*
+ * Thread-per-stage ingest pipeline:
+ *
+ *   read -> parse -> [exact count] -> sketch update -> [periodic report]
+ *
+ * Text traces are read in blocks (BlockReader, io_uring or pread) on one thread and parsed
+ * on the next; binary traces and captures are read and parsed by a single stage. Stages are
+ * linked by SpscQueues of record batches, and emptied batches flow back to their producer,
+ * so memory is bounded by the queue depths. Every stage counts its busy time and the time
+ * it waits for input and for room in its output; every queue records its mean occupancy.
+ * The stage that is busy for most of the wall time limits end-to-end throughput.
+ *
+ * The report stage queries copies of the sketch taken every report_interval_s, so the
+ * update stage is never held up by a query (a copy is skipped if the reporter lags).
+ */
+
+struct PipelineConfig {
+    size_t batch_records = 1 << 16;  // records per batch
+    size_t queue_depth = 8;          // batches (or blocks) per queue
+    bool use_io_uring = true;        // read stage for text traces; pread otherwise
+    bool exact_count = false;        // count the ground truth next to the sketch
+    double report_interval_s = 0;    // query a snapshot every interval, 0 for none
+    float phi_1 = 0.0001;            // heavy hitter threshold of the queries, as a fraction of N
+};
+
+
+struct StageStats {
+    std::string name;
+    uint64_t batches;
+    uint64_t records;
+    uint64_t bytes;
+    double busy_s;
+    double input_wait_s;
+    double output_wait_s;
+};
+
+struct QueueStats {
+    std::string name;
+    size_t capacity;
+    double mean_occupancy;
+    uint64_t full_waits;   // pushes that found the queue full
+    uint64_t empty_waits;  // pops that found it empty
+};
+
+struct PipelineReport {
+    double seconds = 0;
+    uint64_t records = 0;
+    uint64_t skipped = 0;
+    std::vector<StageStats> stages;
+    std::vector<QueueStats> queues;
+};
+
+// Prints the stage and queue tables and names the busiest stage.
+void print_pipeline_report(const PipelineReport& report);
+
+
+inline uint64_t pipeline_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Counters of one stage, written only by the stage's own thread
+struct StageCounters {
+    std::string name;
+    uint64_t batches = 0;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t busy_ns = 0;
+    uint64_t input_wait_ns = 0;
+    uint64_t output_wait_ns = 0;
+
+    explicit StageCounters(std::string name) : name(std::move(name)) {}
+    StageStats stats() const;
+};
+
+template <typename T>
+QueueStats queue_stats(const std::string& name, const SpscQueue<T>& queue) {
+    return {name, queue.capacity(), queue.mean_occupancy(), queue.full_wait_count(), queue.empty_wait_count()};
+}
+
+
+// Record batches from one stage to the next, with the emptied buffers flowing back.
+// At most depth + 2 batches exist per channel.
+class BatchChannel {
+private:
+    SpscQueue<std::vector<Record>> full;
+    SpscQueue<std::vector<Record>> empty;
+
+public:
+    BatchChannel(size_t depth, size_t batch_records);
+
+    // producer side
+    bool acquire(std::vector<Record>& batch, StageCounters& counters);
+    bool send(std::vector<Record>& batch, StageCounters& counters);
+    void close() { full.close(); }
+
+    // consumer side: recycles 'batch' and replaces it with the next one
+    bool receive(std::vector<Record>& batch, StageCounters& counters);
+
+    // unblocks both sides, for a consumer that stops early
+    void abort();
+
+    QueueStats stats(const std::string& name) const { return queue_stats(name, full); }
+};
+
+
+// The read and parse stages, started by the constructor. Batches come out of output().
+class IngestStages {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    IngestStages(const std::vector<std::string>& file_paths, TraceFormat format, const PipelineConfig& config);
+    ~IngestStages();
+
+    BatchChannel& output();
+
+    // Joins the stages and appends their counters to 'report'.
+    void finish(PipelineReport& report);
+};
+
+
+// The optional exact-count stage: forwards every batch and keeps a copy of the records,
+// which are counted with count_exact() once the input ends.
+class CountStage {
+private:
+    BatchChannel& input;
+    BatchChannel channel;
+    StageCounters counters{"count"};
+    ExactCounts exact_counts;
+    std::thread thread;
+
+    void run();
+
+public:
+    CountStage(BatchChannel& input, const PipelineConfig& config);
+    ~CountStage();
+
+    BatchChannel& output() { return channel; }
+
+    // Joins the stage; the counts are complete afterwards.
+    void finish(PipelineReport& report);
+    ExactCounts& counts() { return exact_counts; }
+};
+
+
+struct PipelineResult {
+    RunResult run;
+    PipelineReport report;
+    ExactCounts counts;  // filled if PipelineConfig::exact_count
+};
+
+
+// Runs 'file_paths' through the pipeline into a new sketch, which is updated on the calling
+// thread. As in stream_sketch, the final query uses heavy_hitter_th = phi_1 * N.
+// run.update_seconds ends with the last update; report.seconds also covers the exact count.
+template <typename Sketch>
+PipelineResult run_pipeline(float memory_kb, const std::vector<std::string>& file_paths, TraceFormat format,
+                            const RunConfig& config, const PipelineConfig& pipeline_config) {
+    static_assert(is_sketch<Sketch>::value, "run_pipeline requires the interface described in Sketch.h");
+
+    struct Snapshot {
+        uint64_t records = 0;
+        double seconds = 0;
+        std::unique_ptr<Sketch> sketch;
+    };
+
+    PipelineResult result{};
+    result.run.name = Sketch::name();
+    result.run.memory_kb = memory_kb;
+
+    Sketch sketch(memory_kb);
+    DualSketchStats stats_at_start = dualsketch_stats();
+    uint64_t start = pipeline_clock_ns();
+
+    IngestStages ingest(file_paths, format, pipeline_config);
+    std::unique_ptr<CountStage> count;
+    if (pipeline_config.exact_count) count.reset(new CountStage(ingest.output(), pipeline_config));
+    BatchChannel& input = count ? count->output() : ingest.output();
+
+    // report stage
+    bool reporting = pipeline_config.report_interval_s > 0;
+    SpscQueue<Snapshot> snapshots(2);
+    StageCounters report_counters("report");
+    std::thread reporter;
+    if (reporting) {
+        reporter = std::thread([&]() {
+            Snapshot snapshot;
+            uint64_t wait_start = pipeline_clock_ns();
+            while (snapshots.pop(snapshot)) {
+                uint64_t busy_start = pipeline_clock_ns();
+                report_counters.input_wait_ns += busy_start - wait_start;
+                auto th = static_cast<uint32_t>(pipeline_config.phi_1 * snapshot.records);
+                QueryResult answer = snapshot.sketch->query(th, config.phi);
+                size_t hot = 0;
+                for (const auto& flow: answer.second) hot += flow.second.size();
+                std::cout << "[" << Sketch::name() << " @ " << snapshot.seconds << " s] records: "
+                          << snapshot.records << ", heavy hitters: " << answer.first.size()
+                          << ", hot quadratic elements: " << hot << std::endl;
+                if (dualsketch_stats_enabled) {
+                    // read while the sketch stage keeps updating
+                    DualSketchStats stats = dualsketch_stats();
+                    stats -= stats_at_start;
+                    if (stats[DualSketchEvent::Update] > 0) print_dualsketch_stats(stats, std::cout);
+                }
+                report_counters.batches++;
+                wait_start = pipeline_clock_ns();
+                report_counters.busy_ns += wait_start - busy_start;
+            }
+        });
+    }
+
+    // sketch update stage
+    StageCounters sketch_counters("sketch");
+    uint64_t interval_ns = static_cast<uint64_t>(pipeline_config.report_interval_s * 1e9);
+    uint64_t next_report = start + interval_ns;
+    std::vector<Record> batch;
+    while (input.receive(batch, sketch_counters)) {
+        uint64_t busy_start = pipeline_clock_ns();
+        if (config.batch_size == 0) {
+            for (const auto &[x, y]: batch) {
+                sketch.update(x, y);
+            }
+        } else {
+            for (size_t i = 0; i < batch.size(); i += config.batch_size) {
+                sketch.update_batch(batch.data() + i, std::min(config.batch_size, batch.size() - i));
+            }
+        }
+        sketch_counters.batches++;
+        sketch_counters.records += batch.size();
+
+        uint64_t now = pipeline_clock_ns();
+        if (reporting && now >= next_report) {
+            Snapshot snapshot{sketch_counters.records, (now - start) / 1e9, std::unique_ptr<Sketch>(new Sketch(sketch))};
+            snapshots.try_push(snapshot);
+            next_report = now + interval_ns;
+            now = pipeline_clock_ns();
+        }
+        sketch_counters.busy_ns += now - busy_start;
+    }
+    uint64_t end_update = pipeline_clock_ns();
+
+    snapshots.close();
+    if (reporter.joinable()) reporter.join();
+
+    ingest.finish(result.report);
+    if (count) {
+        count->finish(result.report);
+        result.report.queues.push_back(input.stats("count->sketch"));
+        result.counts = std::move(count->counts());
+    }
+    uint64_t end = pipeline_clock_ns();
+    result.report.stages.push_back(sketch_counters.stats());
+    if (reporting) {
+        result.report.stages.push_back(report_counters.stats());
+        result.report.queues.push_back(queue_stats("sketch->report", snapshots));
+    }
+    result.report.seconds = (end - start) / 1e9;
+    result.report.records = sketch_counters.records;
+
+    result.run.num_updates = sketch_counters.records;
+    result.run.update_seconds = (end_update - start) / 1e9;
+    result.run.update_throughput_Mdps = (result.run.num_updates / 1e6) / result.run.update_seconds;
+
+    auto heavy_hitter_th = static_cast<uint32_t>(pipeline_config.phi_1 * result.run.num_updates);
+    auto start_query = std::chrono::high_resolution_clock::now();
+    result.run.answer = sketch.query(heavy_hitter_th, config.phi);
+    auto end_query = std::chrono::high_resolution_clock::now();
+    result.run.query_ms = std::chrono::duration<double, std::milli>(end_query - start_query).count();
+    result.run.memory_bytes = sketch.memory_bytes();
+    return result;
+}
+
+
+#endif // PIPELINE_H
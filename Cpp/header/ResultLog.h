@@ -0,0 +1,116 @@
+
+#ifndef RESULTLOG_H
+#define RESULTLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Evaluator.h"
+#include "LatencyRecorder.h"
+#include "SketchDriver.h"
+
+
+/*
+ * Machine-readable results, so runs can be diffed across builds and machines. A
+ * ResultLog collects one ResultRow per configuration (algorithm, memory, thresholds,
+ * workload) with the throughput of every repeat, and is written as JSON or CSV together
+ * with the environment it ran in. JSON logs can be read back: HH_Regress compares the
+ * throughput samples of two logs configuration by configuration with Welch's t-test.
+ */
+
+// Where and how a log was produced
+struct RunEnvironment {
+    std::string host;
+    std::string cpu_model;
+    unsigned hardware_threads = 0;
+    std::string os;
+    std::string compiler;
+    std::string build_flags;
+    std::string sketch_isa;         // level of the dispatched sketch kernels, e.g. "avx2"
+    bool dualsketch_stats = false;  // DUALSKETCH_STATS build, slower update path
+    std::string timestamp;          // UTC, ISO 8601
+    std::string command;
+};
+
+// The current process; 'command' is argv joined by spaces
+RunEnvironment current_environment(int argc, char** argv);
+
+
+struct SampleSummary {
+    size_t count = 0;
+    double mean = 0;
+    double stddev = 0;     // sample standard deviation
+    double median = 0;
+    double min = 0;
+    double max = 0;
+    double ci95_low = 0;   // 95% confidence interval of the mean (Student's t)
+    double ci95_high = 0;
+};
+
+SampleSummary summarize(const std::vector<double>& samples);
+
+
+// Welch's unequal-variance t-test of mean(b) against mean(a)
+struct WelchTest {
+    double t = 0;
+    double dof = 0;
+    double p_value = 1;  // two-sided; 1 if either side has fewer than two samples
+};
+
+WelchTest welch_t_test(const std::vector<double>& a, const std::vector<double>& b);
+
+
+struct ResultRow {
+    std::string mode;       // "batch", "stream", "pipeline", or the generated workload
+    std::string dataset;    // trace files, or the generator and its parameters
+    std::string algorithm;
+    float memory_kb = 0;
+    float phi_1 = 0;
+    float phi_2 = 0;
+    size_t batch_size = 0;
+    uint64_t records = 0;
+
+    std::vector<double> throughput_mdps;  // one sample per repeat
+    double query_ms = 0;                  // median over the repeats
+    uint64_t memory_bytes = 0;            // measured footprint
+
+    // latency of the first run, if it was measured
+    LatencyStats update_latency{};
+    LatencyStats query_latency{};
+    std::vector<std::pair<std::string, LatencyStats>> update_latency_by_case;
+
+    bool has_accuracy = false;
+    AccuracyMetrics accuracy{};
+
+    // Identifies the configuration across logs: everything but the measurements
+    std::string key() const;
+};
+
+// The measurements of the repeats 'runs' of one configuration; the caller fills in
+// mode, dataset, thresholds, batch size and accuracy.
+ResultRow result_row(const std::vector<RunResult>& runs);
+
+
+class ResultLog {
+public:
+    RunEnvironment environment;
+
+    void add(ResultRow row) { results.push_back(std::move(row)); }
+    const std::vector<ResultRow>& rows() const { return results; }
+    bool empty() const { return results.empty(); }
+
+    // Print the reason to std::cerr and return false if the file cannot be written.
+    bool write_json(const std::string& path) const;
+    bool write_csv(const std::string& path) const;  // per-case latencies are JSON only
+
+private:
+    std::vector<ResultRow> results;
+};
+
+// Reads a log written by write_json.
+bool read_result_log(const std::string& path, ResultLog& log, std::string& error);
+
+
+#endif // RESULTLOG_H
@@ -0,0 +1,68 @@
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <utility>
+
+// One stream item: x is flow label, y is element label, (x, y) equals (f, e)
+using Record = std::pair<uint32_t, uint32_t>;
+
+// heavy hitter ID -> estimated frequency
+using HeavyHitterMap = std::map<uint32_t, uint32_t>;
+
+// heavy hitter ID -> (hot quadratic element ID -> estimated frequency)
+using QuadElementMap = std::map<uint32_t, std::map<uint32_t, uint32_t>>;
+
+using QueryResult = std::pair<HeavyHitterMap, QuadElementMap>;
+
+
+/*
+ * The interface shared by every algorithm, checked at compile time by is_sketch<T>:
+ *
+ *   void update(uint32_t x, uint32_t y);
+ *   void update_batch(const Record* records, size_t n);
+ *   QueryResult query(uint32_t heavy_hitter_th, float phi);
+ *   size_t memory_bytes() const;   // heap bytes held, measured by a MemoryTracker
+ *   void reset();
+ *   static const char* name();
+ *
+ * query() returns the heavy hitters whose estimated size is >= heavy_hitter_th,
+ * and for each of them the elements whose estimated size is >= phi * its size.
+ *
+ * The driver is instantiated per sketch type, so all calls are resolved statically.
+ */
+
+
+// CRTP base: supplies update_batch() on top of the derived update().
+// Sketches with a faster batched path define their own update_batch().
+template <typename Derived>
+class SketchBase {
+public:
+    void update_batch(const Record* records, size_t n) {
+        Derived& self = static_cast<Derived&>(*this);
+        for (size_t i = 0; i < n; ++i) {
+            self.update(records[i].first, records[i].second);
+        }
+    }
+};
+
+
+template <typename T, typename = void>
+struct is_sketch : std::false_type {};
+
+template <typename T>
+struct is_sketch<T, std::void_t<
+        decltype(std::declval<T&>().update(uint32_t{}, uint32_t{})),
+        decltype(std::declval<T&>().update_batch(std::declval<const Record*>(), size_t{})),
+        decltype(std::declval<T&>().reset()),
+        std::enable_if_t<std::is_same<decltype(std::declval<T&>().query(uint32_t{}, float{})), QueryResult>::value>,
+        std::enable_if_t<std::is_same<decltype(std::declval<const T&>().memory_bytes()), size_t>::value>,
+        std::enable_if_t<std::is_convertible<decltype(T::name()), const char*>::value>
+>> : std::true_type {};
+
+
+#endif // SKETCH_H
@@ -0,0 +1,252 @@
+
+#ifndef SKETCHDRIVER_H
+#define SKETCHDRIVER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <vector>
+#include "DualSketchStats.h"
+#include "LatencyRecorder.h"
+#include "Sketch.h"
+#include "TraceStream.h"
+
+
+struct RunConfig {
+    uint32_t heavy_hitter_th; // N * phi_1
+    float phi;                // phi_2
+    size_t batch_size;        // records per update_batch() call, 0 for per-record update()
+    uint32_t latency_sample = 0;  // time one update() in this many in an extra pass, 0 for none
+};
+
+
+struct CaseLatency {
+    const char* name;
+    LatencyStats latency;
+};
+
+
+struct RunResult {
+    const char* name;
+    float memory_kb;
+    size_t memory_bytes;  // measured heap footprint of the sketch after the run
+    uint64_t num_updates;
+    double update_seconds;
+    double update_throughput_Mdps;
+    double query_ms;
+    QueryResult answer;
+
+    // filled if RunConfig::latency_sample > 0
+    LatencyStats update_latency;
+    LatencyStats query_latency;
+    std::vector<CaseLatency> update_latency_by_case;  // sketches with update_case(), e.g. DualSketch
+};
+
+
+template <typename T, typename = void>
+struct has_update_case : std::false_type {};
+
+template <typename T>
+struct has_update_case<T, std::void_t<
+        std::enable_if_t<std::is_same<decltype(std::declval<T&>().update_case(uint32_t{}, uint32_t{})),
+                                      DualSketchEvent>::value>
+>> : std::true_type {};
+
+
+// Per-update and per-query latency of a fresh sketch over 'dataset', in a pass of its own so
+// that the throughput pass is not disturbed: one update() in config.latency_sample is timed,
+// and a query (at phi_1 of the records so far) after every 1/LATENCY_QUERIES of the dataset.
+// Sketches with update_case() are also timed per update outcome.
+constexpr size_t LATENCY_QUERIES = 32;
+
+template <typename Sketch>
+void measure_latency(float memory_kb, const std::vector<Record>& dataset, const RunConfig& config, RunResult& result) {
+    Sketch sketch(memory_kb);
+    LatencySampler sampler(config.latency_sample);
+    LatencyHistogram updates;
+    LatencyHistogram queries;
+    std::vector<LatencyHistogram> by_case(has_update_case<Sketch>::value ? DUALSKETCH_EVENT_COUNT : 0);
+
+    size_t query_every = std::max<size_t>(1, dataset.size() / LATENCY_QUERIES);
+    for (size_t i = 0; i < dataset.size(); ++i) {
+        const auto &[x, y] = dataset[i];
+        if (!sampler.sample()) {
+            sketch.update(x, y);
+        } else if constexpr (has_update_case<Sketch>::value) {
+            uint64_t start = latency_ticks_begin();
+            DualSketchEvent outcome = sketch.update_case(x, y);
+            uint64_t ticks = latency_ticks_end() - start;
+            updates.record(ticks);
+            by_case[static_cast<size_t>(outcome)].record(ticks);
+        } else {
+            uint64_t start = latency_ticks_begin();
+            sketch.update(x, y);
+            updates.record(latency_ticks_end() - start);
+        }
+
+        if ((i + 1) % query_every == 0) {
+            auto heavy_hitter_th = static_cast<uint32_t>(static_cast<double>(config.heavy_hitter_th) * (i + 1) / dataset.size());
+            uint64_t start = latency_ticks_begin();
+            QueryResult answer = sketch.query(heavy_hitter_th, config.phi);
+            queries.record(latency_ticks_end() - start);
+        }
+    }
+
+    result.update_latency = updates.stats();
+    result.query_latency = queries.stats();
+    for (size_t c = 0; c < by_case.size(); ++c) {
+        if (by_case[c].count() > 0) {
+            result.update_latency_by_case.push_back({dualsketch_event_name(static_cast<DualSketchEvent>(c)),
+                                                     by_case[c].stats()});
+        }
+    }
+}
+
+
+// Feeds the whole dataset into 'sketch', then queries it.
+template <typename Sketch>
+RunResult run_sketch(Sketch& sketch, float memory_kb, const std::vector<Record>& dataset, const RunConfig& config) {
+    static_assert(is_sketch<Sketch>::value, "run_sketch requires the interface described in Sketch.h");
+
+    RunResult result{};
+    result.name = Sketch::name();
+    result.memory_kb = memory_kb;
+    result.num_updates = dataset.size();
+
+    // Process the entire dataset
+    auto start_update = std::chrono::high_resolution_clock::now();
+    if (config.batch_size == 0) {
+        for (const auto &[x, y]: dataset) {
+            sketch.update(x, y);
+        }
+    } else {
+        for (size_t i = 0; i < dataset.size(); i += config.batch_size) {
+            sketch.update_batch(dataset.data() + i, std::min(config.batch_size, dataset.size() - i));
+        }
+    }
+    auto end_update = std::chrono::high_resolution_clock::now();
+    result.update_seconds = std::chrono::duration<double>(end_update - start_update).count();
+    result.update_throughput_Mdps = (dataset.size() / 1e6) / result.update_seconds;
+
+    // Query the sketch for results
+    auto start_query = std::chrono::high_resolution_clock::now();
+    result.answer = sketch.query(config.heavy_hitter_th, config.phi);
+    auto end_query = std::chrono::high_resolution_clock::now();
+    result.query_ms = std::chrono::duration<double, std::milli>(end_query - start_query).count();
+
+    result.memory_bytes = sketch.memory_bytes();
+    return result;
+}
+
+
+template <typename Sketch>
+RunResult run_sketch(float memory_kb, const std::vector<Record>& dataset, const RunConfig& config) {
+    RunResult result;
+    {
+        Sketch sketch(memory_kb);
+        result = run_sketch(sketch, memory_kb, dataset, config);
+    }
+    if (config.latency_sample > 0) measure_latency<Sketch>(memory_kb, dataset, config, result);
+    return result;
+}
+
+
+// Runs every sketch type in 'Sketches' at the same memory budget.
+// In parallel mode each sketch gets its own thread; use it for accuracy sweeps only,
+// since concurrent runs disturb each other's throughput.
+template <typename... Sketches>
+std::vector<RunResult> run_all(float memory_kb, const std::vector<Record>& dataset, const RunConfig& config,
+                               bool parallel = false) {
+    std::vector<RunResult> results;
+    if (parallel) {
+        std::vector<std::future<RunResult>> pending;
+        (pending.push_back(std::async(std::launch::async, [&]() {
+            return run_sketch<Sketches>(memory_kb, dataset, config);
+        })), ...);
+        for (auto& run : pending) {
+            results.push_back(run.get());
+        }
+    } else {
+        (results.push_back(run_sketch<Sketches>(memory_kb, dataset, config)), ...);
+    }
+    return results;
+}
+
+
+// Feeds every chunk of 'source' (any type with bool next(std::vector<Record>&), e.g. a
+// TraceStream) into a new sketch. The timing covers producing and updating end to end.
+// Since N is only known at the end, the query uses heavy_hitter_th = phi_1 * N in place
+// of config.heavy_hitter_th.
+template <typename Sketch, typename Source>
+RunResult stream_source(float memory_kb, Source& source, float phi_1, const RunConfig& config) {
+    static_assert(is_sketch<Sketch>::value, "stream_source requires the interface described in Sketch.h");
+
+    Sketch sketch(memory_kb);
+    RunResult result{};
+    result.name = Sketch::name();
+    result.memory_kb = memory_kb;
+
+    auto start_update = std::chrono::high_resolution_clock::now();
+    std::vector<Record> chunk;
+    while (source.next(chunk)) {
+        if (config.batch_size == 0) {
+            for (const auto &[x, y]: chunk) {
+                sketch.update(x, y);
+            }
+        } else {
+            for (size_t i = 0; i < chunk.size(); i += config.batch_size) {
+                sketch.update_batch(chunk.data() + i, std::min(config.batch_size, chunk.size() - i));
+            }
+        }
+        result.num_updates += chunk.size();
+    }
+    auto end_update = std::chrono::high_resolution_clock::now();
+    result.update_seconds = std::chrono::duration<double>(end_update - start_update).count();
+    result.update_throughput_Mdps = (result.num_updates / 1e6) / result.update_seconds;
+
+    auto heavy_hitter_th = static_cast<uint32_t>(phi_1 * result.num_updates);
+    auto start_query = std::chrono::high_resolution_clock::now();
+    result.answer = sketch.query(heavy_hitter_th, config.phi);
+    auto end_query = std::chrono::high_resolution_clock::now();
+    result.query_ms = std::chrono::duration<double, std::milli>(end_query - start_query).count();
+
+    result.memory_bytes = sketch.memory_bytes();
+    return result;
+}
+
+
+// Streams 'file_paths' through a new sketch: a background reader parses fixed-size chunks
+// while this thread updates, so memory stays constant in the trace length.
+template <typename Sketch>
+RunResult stream_sketch(float memory_kb, const std::vector<std::string>& file_paths, TraceFormat format,
+                        float phi_1, const RunConfig& config, const StreamConfig& stream_config = {}) {
+    TraceStream stream(file_paths, format, stream_config);
+    return stream_source<Sketch>(memory_kb, stream, phi_1, config);
+}
+
+
+// One streaming pass over the files per sketch type, one after another.
+template <typename... Sketches>
+std::vector<RunResult> stream_all(float memory_kb, const std::vector<std::string>& file_paths, TraceFormat format,
+                                  float phi_1, const RunConfig& config, const StreamConfig& stream_config = {}) {
+    std::vector<RunResult> results;
+    (results.push_back(stream_sketch<Sketches>(memory_kb, file_paths, format, phi_1, config, stream_config)), ...);
+    return results;
+}
+
+
+struct AccuracyMetrics;
+
+// Prints throughput, query time and the accuracy computed by the Evaluator.
+void report_run(const RunResult& run, const AccuracyMetrics& metrics);
+
+// Prints the update (overall and per outcome) and query latency percentiles, if measured.
+void report_latencies(const RunResult& run);
+
+// Prints end-to-end throughput and answer sizes of a streaming run, which has no ground truth.
+void report_stream_run(const RunResult& run);
+
+
+#endif // SKETCHDRIVER_H
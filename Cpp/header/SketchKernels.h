@@ -0,0 +1,88 @@
+
+#ifndef SKETCHKERNELS_H
+#define SKETCHKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+/*
+ * Hot kernels of the sketch update paths, built for several x86 ISA levels and chosen
+ * at startup, so one binary runs on every collector and still uses the widest vectors
+ * each has. The sketches hold a pointer to the active table and call through it; each
+ * kernel does enough work per call (a group of hashes, a whole row) to amortize the
+ * indirect call.
+ *
+ * The kernels live in SketchKernels*.cpp, one translation unit per level, compiled with
+ * that level's -m flags from header/SketchKernelsImpl.h. Nothing else is built above
+ * baseline x86-64 unless CMake is configured with -DHH_MARCH=<cpu> (e.g. native).
+ */
+
+enum class Isa {
+    Baseline,  // x86-64 (SSE2), or any other architecture
+    Avx2,      // AVX2 + BMI2 + FMA (Haswell, Zen)
+    Avx512,    // AVX-512 F/BW/DQ/VL (Skylake-SP, Ice Lake, Zen 4)
+};
+
+const char* isa_name(Isa isa);
+
+// "baseline", "avx2" or "avx512"
+bool parse_isa(const std::string& name, Isa& isa);
+
+// Whether this CPU runs, and this binary contains, the kernels of 'isa'
+bool isa_supported(Isa isa);
+
+// The widest supported level
+Isa detected_isa();
+
+
+struct SketchKernels {
+    Isa isa;
+
+    // out[i] = MurmurHash3_x86_32 of the 4-byte key keys[i] with 'seed'
+    void (*hash_u32)(const uint32_t* keys, size_t n, uint32_t seed, uint32_t* out);
+
+    // Count-Min over 'depth' rows of 'width' counters, row i hashed with seed i.
+    // countmin_add adds 'weight' to the key's counters and returns its estimate before.
+    uint32_t (*countmin_add)(uint32_t* counters, uint32_t depth, uint32_t width, uint32_t key, uint32_t weight);
+    uint32_t (*countmin_query)(const uint32_t* counters, uint32_t depth, uint32_t width, uint32_t key);
+
+    // Scans keys[0, n) for 'key'. Returns the index of the first match, or -1. When
+    // there is no match, 'first_empty' receives the index of the first zero key, or n.
+    int64_t (*probe_row_u64)(const uint64_t* keys, uint32_t n, uint64_t key, uint32_t& first_empty);
+
+    // Index of the first minimum of vals[0, n), n > 0
+    uint32_t (*argmin_u32)(const uint32_t* vals, uint32_t n);
+
+    // Misra-Gries step on a list of up to 8 entries: counts 'key' if it is among the
+    // first 'size', else appends it if there is room, else decrements every entry and
+    // compacts out those reaching 0. Returns the new size.
+    uint32_t (*misra_gries_u32x8)(uint32_t* keys, uint32_t* freqs, uint32_t size, uint32_t key);
+
+    // DualSketch QT windows: n cells of 3 words {E, R, P}.
+    // qt_window_scan returns the index of the first cell with E == y and P == x, or -1.
+    // 'first_empty' receives the first cell with E == 0 before that index (n if none), and
+    // on -1 'min_r' the first cell of least R (< UINT32_MAX) among those with E != 0 (n if none).
+    int64_t (*qt_window_scan)(const uint32_t* cells, uint32_t n, uint32_t x, uint32_t y,
+                              uint32_t& first_empty, uint32_t& min_r);
+    // Index of the first cell with P == x, or -1
+    int64_t (*qt_window_find)(const uint32_t* cells, uint32_t n, uint32_t x);
+    // Empties the cells with P == x; returns how many there were
+    uint32_t (*qt_window_clear)(uint32_t* cells, uint32_t n, uint32_t x);
+};
+
+// The kernels in use: those of detected_isa(), or of a lower level requested with the
+// HH_ISA environment variable or set_sketch_isa(). Chosen on first use.
+const SketchKernels& sketch_kernels();
+
+// Switches the level of the sketches created afterwards, e.g. to compare the levels in
+// one process; false (and no change) if the level is not supported. Not thread-safe.
+bool set_sketch_isa(Isa isa);
+
+// One line naming the chosen level and the detected one
+void print_sketch_dispatch(std::ostream& out);
+
+
+#endif // SKETCHKERNELS_H
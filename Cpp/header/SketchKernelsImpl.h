@@ -0,0 +1,459 @@
+// Kernel bodies of header/SketchKernels.h, included once by each SketchKernels<Level>.cpp
+// with HH_KERNEL_NAMESPACE and HH_KERNEL_ISA defined, and compiled with that level's -m
+// flags; the code paths below are selected by the resulting __AVX2__ / __AVX512F__.
+//
+// Every copy lives in its own namespace, so the linker never merges two of them. For the
+// same reason only raw pointers and intrinsics are used here: an inline standard library
+// function compiled with AVX flags could become the one copy the whole program uses.
+//
+// No include guard: each level's translation unit includes this file once.
+
+#if !defined(HH_KERNEL_NAMESPACE) || !defined(HH_KERNEL_ISA)
+#error "define HH_KERNEL_NAMESPACE and HH_KERNEL_ISA before including SketchKernelsImpl.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include "SketchKernels.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+namespace HH_KERNEL_NAMESPACE {
+
+inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// MurmurHash3_x86_32 of one 4-byte key: a single body block, no tail
+inline uint32_t murmur3_u32(uint32_t key, uint32_t seed) {
+    uint32_t k1 = key * 0xcc9e2d51;
+    k1 = rotl32(k1, 15);
+    k1 *= 0x1b873593;
+
+    uint32_t h1 = seed ^ k1;
+    h1 = rotl32(h1, 13);
+    h1 = h1 * 5 + 0xe6546b64;
+
+    h1 ^= 4;
+    h1 ^= h1 >> 16;
+    h1 *= 0x85ebca6b;
+    h1 ^= h1 >> 13;
+    h1 *= 0xc2b2ae35;
+    h1 ^= h1 >> 16;
+    return h1;
+}
+
+
+#if defined(__AVX512F__)
+// murmur3_u32 in 16 lanes; AVX-512 has a vector rotate
+inline __m512i murmur3_u32x16(__m512i k1, __m512i seed) {
+    k1 = _mm512_mullo_epi32(k1, _mm512_set1_epi32(static_cast<int>(0xcc9e2d51)));
+    k1 = _mm512_rol_epi32(k1, 15);
+    k1 = _mm512_mullo_epi32(k1, _mm512_set1_epi32(0x1b873593));
+
+    __m512i h1 = _mm512_xor_si512(seed, k1);
+    h1 = _mm512_rol_epi32(h1, 13);
+    h1 = _mm512_add_epi32(_mm512_mullo_epi32(h1, _mm512_set1_epi32(5)), _mm512_set1_epi32(static_cast<int>(0xe6546b64)));
+
+    h1 = _mm512_xor_si512(h1, _mm512_set1_epi32(4));
+    h1 = _mm512_xor_si512(h1, _mm512_srli_epi32(h1, 16));
+    h1 = _mm512_mullo_epi32(h1, _mm512_set1_epi32(static_cast<int>(0x85ebca6b)));
+    h1 = _mm512_xor_si512(h1, _mm512_srli_epi32(h1, 13));
+    h1 = _mm512_mullo_epi32(h1, _mm512_set1_epi32(static_cast<int>(0xc2b2ae35)));
+    h1 = _mm512_xor_si512(h1, _mm512_srli_epi32(h1, 16));
+    return h1;
+}
+#elif defined(__AVX2__)
+inline __m256i rotl32x8(__m256i x, int r) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, r), _mm256_srli_epi32(x, 32 - r));
+}
+
+// murmur3_u32 in 8 lanes
+inline __m256i murmur3_u32x8(__m256i k1, __m256i seed) {
+    k1 = _mm256_mullo_epi32(k1, _mm256_set1_epi32(static_cast<int>(0xcc9e2d51)));
+    k1 = rotl32x8(k1, 15);
+    k1 = _mm256_mullo_epi32(k1, _mm256_set1_epi32(0x1b873593));
+
+    __m256i h1 = _mm256_xor_si256(seed, k1);
+    h1 = rotl32x8(h1, 13);
+    h1 = _mm256_add_epi32(_mm256_mullo_epi32(h1, _mm256_set1_epi32(5)), _mm256_set1_epi32(static_cast<int>(0xe6546b64)));
+
+    h1 = _mm256_xor_si256(h1, _mm256_set1_epi32(4));
+    h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 16));
+    h1 = _mm256_mullo_epi32(h1, _mm256_set1_epi32(static_cast<int>(0x85ebca6b)));
+    h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 13));
+    h1 = _mm256_mullo_epi32(h1, _mm256_set1_epi32(static_cast<int>(0xc2b2ae35)));
+    h1 = _mm256_xor_si256(h1, _mm256_srli_epi32(h1, 16));
+    return h1;
+}
+#endif
+
+
+void hash_u32(const uint32_t* keys, size_t n, uint32_t seed, uint32_t* out) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    // 16 keys per step; the tail is masked, so no scalar loop is left
+    const __m512i seeds = _mm512_set1_epi32(static_cast<int>(seed));
+    for (; i + 16 <= n; i += 16) {
+        __m512i k = _mm512_loadu_si512(keys + i);
+        _mm512_storeu_si512(out + i, murmur3_u32x16(k, seeds));
+    }
+    if (i < n) {
+        __mmask16 lanes = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512i k = _mm512_maskz_loadu_epi32(lanes, keys + i);
+        _mm512_mask_storeu_epi32(out + i, lanes, murmur3_u32x16(k, seeds));
+    }
+    return;
+#elif defined(__AVX2__)
+    const __m256i seeds = _mm256_set1_epi32(static_cast<int>(seed));
+    for (; i + 8 <= n; i += 8) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), murmur3_u32x8(k, seeds));
+    }
+#endif
+    for (; i < n; ++i) out[i] = murmur3_u32(keys[i], seed);
+}
+
+
+uint32_t countmin_add(uint32_t* counters, uint32_t depth, uint32_t width, uint32_t key, uint32_t weight) {
+    uint32_t estimate = UINT32_MAX;
+    for (uint32_t i = 0; i < depth; ++i) {
+        uint32_t& counter = counters[static_cast<size_t>(i) * width + murmur3_u32(key, i) % width];
+        if (counter < estimate) estimate = counter;
+        counter += weight;
+    }
+    return estimate;
+}
+
+
+uint32_t countmin_query(const uint32_t* counters, uint32_t depth, uint32_t width, uint32_t key) {
+    uint32_t estimate = UINT32_MAX;
+    for (uint32_t i = 0; i < depth; ++i) {
+        uint32_t counter = counters[static_cast<size_t>(i) * width + murmur3_u32(key, i) % width];
+        if (counter < estimate) estimate = counter;
+    }
+    return estimate;
+}
+
+
+int64_t probe_row_u64(const uint64_t* keys, uint32_t n, uint64_t key, uint32_t& first_empty) {
+    first_empty = n;
+    uint32_t i = 0;
+#if defined(__AVX512F__)
+    // 8 keys per compare; the tail is a masked load, so no scalar loop is left
+    const __m512i needle = _mm512_set1_epi64(static_cast<long long>(key));
+    const __m512i zero = _mm512_setzero_si512();
+    for (; i < n; i += 8) {
+        __mmask8 lanes = n - i >= 8 ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512i block = _mm512_maskz_loadu_epi64(lanes, keys + i);
+        uint32_t hit = _mm512_mask_cmpeq_epi64_mask(lanes, block, needle);
+        if (first_empty == n) {
+            uint32_t empty = _mm512_mask_cmpeq_epi64_mask(lanes, block, zero);
+            if (empty != 0) first_empty = i + __builtin_ctz(empty);
+        }
+        if (hit != 0) return i + __builtin_ctz(hit);
+    }
+    return -1;
+#else
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(key));
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i + 4));
+        uint32_t hit = static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, needle))))
+                       | (static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(b, needle)))) << 4);
+        if (first_empty == n) {
+            uint32_t empty = static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, zero))))
+                             | (static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(b, zero)))) << 4);
+            if (empty != 0) first_empty = i + __builtin_ctz(empty);
+        }
+        if (hit != 0) return i + __builtin_ctz(hit);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (keys[i] == key) return i;
+        if (keys[i] == 0 && first_empty == n) first_empty = i;
+    }
+    return -1;
+#endif
+}
+
+
+uint32_t argmin_u32(const uint32_t* vals, uint32_t n) {
+#if defined(__AVX512F__)
+    // minimum over 16 lanes, then the first lane holding it; tails are masked
+    __m512i vmin = _mm512_set1_epi32(-1);
+    for (uint32_t i = 0; i < n; i += 16) {
+        __mmask16 lanes = n - i >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+        vmin = _mm512_mask_min_epu32(vmin, lanes, vmin, _mm512_maskz_loadu_epi32(lanes, vals + i));
+    }
+    const __m512i target = _mm512_set1_epi32(static_cast<int>(_mm512_reduce_min_epu32(vmin)));
+    for (uint32_t i = 0; i < n; i += 16) {
+        __mmask16 lanes = n - i >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+        uint32_t eq = _mm512_mask_cmpeq_epi32_mask(lanes, _mm512_maskz_loadu_epi32(lanes, vals + i), target);
+        if (eq != 0) return i + __builtin_ctz(eq);
+    }
+    return 0;
+#else
+    uint32_t min_val = UINT32_MAX;
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    if (n >= 8) {
+        __m256i vmin = _mm256_set1_epi32(-1);
+        for (; i + 8 <= n; i += 8) {
+            vmin = _mm256_min_epu32(vmin, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vals + i)));
+        }
+        __m128i m = _mm_min_epu32(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+        m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        min_val = static_cast<uint32_t>(_mm_cvtsi128_si32(m));
+    }
+#endif
+    for (uint32_t j = i; j < n; ++j) {
+        if (vals[j] < min_val) min_val = vals[j];
+    }
+
+    // second pass: locate the first lane holding the minimum
+    i = 0;
+#if defined(__AVX2__)
+    const __m256i target = _mm256_set1_epi32(static_cast<int>(min_val));
+    for (; i + 8 <= n; i += 8) {
+        __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vals + i));
+        uint32_t eq = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, target))));
+        if (eq != 0) return i + __builtin_ctz(eq);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (vals[i] == min_val) return i;
+    }
+    return 0;
+#endif
+}
+
+
+uint32_t misra_gries_u32x8(uint32_t* keys, uint32_t* freqs, uint32_t size, uint32_t key) {
+    uint32_t valid_lanes = (1u << size) - 1;
+#if defined(__AVX512F__)
+    const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+    uint32_t hit = _mm256_mask_cmpeq_epi32_mask(static_cast<__mmask8>(valid_lanes), lanes,
+                                                _mm256_set1_epi32(static_cast<int>(key)));
+#elif defined(__AVX2__)
+    const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+    __m256i eq = _mm256_cmpeq_epi32(lanes, _mm256_set1_epi32(static_cast<int>(key)));
+    uint32_t hit = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq))) & valid_lanes;
+#elif defined(__SSE2__)
+    __m128i needle = _mm_set1_epi32(static_cast<int>(key));
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 4));
+    uint32_t mask_lo = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, needle)));
+    uint32_t mask_hi = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, needle)));
+    uint32_t hit = (mask_lo | (mask_hi << 4)) & valid_lanes;
+#else
+    uint32_t hit = 0;
+    for (uint32_t i = 0; i < size; ++i) hit |= static_cast<uint32_t>(keys[i] == key) << i;
+#endif
+    if (hit != 0) {
+        freqs[__builtin_ctz(hit)]++;
+        return size;
+    }
+    if (size < 8) {
+        keys[size] = key;
+        freqs[size] = 1;
+        return size + 1;
+    }
+
+    // full: decrement all entries and compact out those reaching 0
+#if defined(__AVX512F__)
+    __m256i decremented = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(freqs)),
+                                           _mm256_set1_epi32(1));
+    __mmask8 kept = _mm256_test_epi32_mask(decremented, decremented);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys), _mm256_maskz_compress_epi32(kept, lanes));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(freqs), _mm256_maskz_compress_epi32(kept, decremented));
+    return static_cast<uint32_t>(__builtin_popcount(kept));
+#else
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+        uint32_t freq = freqs[i] - 1;
+        keys[kept] = keys[i];
+        freqs[kept] = freq;
+        kept += (freq != 0);
+    }
+    return kept;
+#endif
+}
+
+
+#if defined(__AVX512F__)
+// Field f (0: E, 1: R, 2: P) of 16 QT cells held in 48 consecutive words a | b | c.
+// Lane i takes word 3i + f: from a or b by a two-table permute, or from c for 3i + f >= 32.
+inline __m512i qt_field_x16(__m512i a, __m512i b, __m512i c, int f) {
+    const __m512i index = _mm512_add_epi32(
+            _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45), _mm512_set1_epi32(f));
+    const __mmask16 from_c = f == 2 ? 0xFC00 : 0xF800;
+    return _mm512_mask_permutexvar_epi32(_mm512_permutex2var_epi32(a, index, b), from_c, index, c);
+}
+
+// Loads 'count' <= 16 cells starting at 'cells' as three vectors; the words past them are 0
+inline void qt_load_x16(const uint32_t* cells, uint32_t count, __m512i& a, __m512i& b, __m512i& c) {
+    uint32_t words = 3 * count;
+    auto part = [](uint32_t w) { return static_cast<__mmask16>(w >= 16 ? 0xFFFF : (1u << w) - 1); };
+    a = _mm512_maskz_loadu_epi32(part(words), cells);
+    b = _mm512_maskz_loadu_epi32(part(words > 16 ? words - 16 : 0), cells + 16);
+    c = _mm512_maskz_loadu_epi32(part(words > 32 ? words - 32 : 0), cells + 32);
+}
+#elif defined(__AVX2__)
+// Field f (0: E, 1: R, 2: P) of 8 QT cells, by one gather from L1
+inline __m256i qt_field_x8(const uint32_t* cells, int f) {
+    const __m256i index = _mm256_setr_epi32(f, 3 + f, 6 + f, 9 + f, 12 + f, 15 + f, 18 + f, 21 + f);
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(cells), index, 4);
+}
+
+inline uint32_t lane_mask_x8(__m256i eq) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+}
+
+inline uint32_t reduce_min_u32x8(__m256i v) {
+    __m128i m = _mm_min_epu32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(m));
+}
+#endif
+
+
+int64_t qt_window_scan(const uint32_t* cells, uint32_t n, uint32_t x, uint32_t y,
+                       uint32_t& first_empty, uint32_t& min_r) {
+    first_empty = n;
+    min_r = n;
+    uint32_t least = UINT32_MAX;
+    uint32_t i = 0;
+#if defined(__AVX512F__)
+    // 16 cells per step; the tail is masked, so no scalar loop is left
+    const __m512i xs = _mm512_set1_epi32(static_cast<int>(x));
+    const __m512i ys = _mm512_set1_epi32(static_cast<int>(y));
+    for (; i < n; i += 16) {
+        uint32_t count = n - i >= 16 ? 16 : n - i;
+        __mmask16 lanes = static_cast<__mmask16>(count == 16 ? 0xFFFF : (1u << count) - 1);
+        __m512i a, b, c;
+        qt_load_x16(cells + 3 * static_cast<size_t>(i), count, a, b, c);
+        __m512i e = qt_field_x16(a, b, c, 0);
+        __m512i r = qt_field_x16(a, b, c, 1);
+        __m512i p = qt_field_x16(a, b, c, 2);
+
+        uint32_t hit = _mm512_mask_cmpeq_epi32_mask(_mm512_mask_cmpeq_epi32_mask(lanes, e, ys), p, xs);
+        __mmask16 empty = _mm512_mask_cmpeq_epi32_mask(lanes, e, _mm512_setzero_si512());
+        uint32_t empty_before = hit != 0 ? empty & ((hit & -hit) - 1) : empty;
+        if (empty_before != 0 && first_empty == n) first_empty = i + __builtin_ctz(empty_before);
+        if (hit != 0) return i + __builtin_ctz(hit);
+
+        __mmask16 used = lanes & static_cast<__mmask16>(~empty);
+        uint32_t step_min = _mm512_reduce_min_epu32(_mm512_mask_mov_epi32(_mm512_set1_epi32(-1), used, r));
+        if (step_min < least) {
+            least = step_min;
+            min_r = i + __builtin_ctz(_mm512_mask_cmpeq_epi32_mask(used, r, _mm512_set1_epi32(static_cast<int>(step_min))));
+        }
+    }
+    return -1;
+#else
+#if defined(__AVX2__)
+    const __m256i xs = _mm256_set1_epi32(static_cast<int>(x));
+    const __m256i ys = _mm256_set1_epi32(static_cast<int>(y));
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        const uint32_t* group = cells + 3 * static_cast<size_t>(i);
+        __m256i e = qt_field_x8(group, 0);
+        __m256i p = qt_field_x8(group, 2);
+        uint32_t hit = lane_mask_x8(_mm256_and_si256(_mm256_cmpeq_epi32(e, ys), _mm256_cmpeq_epi32(p, xs)));
+        __m256i empty = _mm256_cmpeq_epi32(e, zero);
+        uint32_t empty_lanes = lane_mask_x8(empty);
+        uint32_t empty_before = hit != 0 ? empty_lanes & ((hit & -hit) - 1) : empty_lanes;
+        if (empty_before != 0 && first_empty == n) first_empty = i + __builtin_ctz(empty_before);
+        if (hit != 0) return i + __builtin_ctz(hit);
+
+        __m256i r = _mm256_or_si256(qt_field_x8(group, 1), empty); // empty cells as UINT32_MAX
+        uint32_t step_min = reduce_min_u32x8(r);
+        if (step_min < least) {
+            least = step_min;
+            uint32_t at = lane_mask_x8(_mm256_cmpeq_epi32(r, _mm256_set1_epi32(static_cast<int>(step_min)))) & ~empty_lanes;
+            min_r = i + __builtin_ctz(at);
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        const uint32_t* cell = cells + 3 * static_cast<size_t>(i);
+        if (cell[0] == y && cell[2] == x) return i;
+        if (cell[0] == 0) {
+            if (first_empty == n) first_empty = i;
+        } else if (cell[1] < least) {
+            least = cell[1];
+            min_r = i;
+        }
+    }
+    return -1;
+#endif
+}
+
+
+int64_t qt_window_find(const uint32_t* cells, uint32_t n, uint32_t x) {
+    uint32_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i xs = _mm512_set1_epi32(static_cast<int>(x));
+    for (; i < n; i += 16) {
+        uint32_t count = n - i >= 16 ? 16 : n - i;
+        __mmask16 lanes = static_cast<__mmask16>(count == 16 ? 0xFFFF : (1u << count) - 1);
+        __m512i a, b, c;
+        qt_load_x16(cells + 3 * static_cast<size_t>(i), count, a, b, c);
+        uint32_t hit = _mm512_mask_cmpeq_epi32_mask(lanes, qt_field_x16(a, b, c, 2), xs);
+        if (hit != 0) return i + __builtin_ctz(hit);
+    }
+    return -1;
+#else
+#if defined(__AVX2__)
+    const __m256i xs = _mm256_set1_epi32(static_cast<int>(x));
+    for (; i + 8 <= n; i += 8) {
+        uint32_t hit = lane_mask_x8(_mm256_cmpeq_epi32(qt_field_x8(cells + 3 * static_cast<size_t>(i), 2), xs));
+        if (hit != 0) return i + __builtin_ctz(hit);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (cells[3 * static_cast<size_t>(i) + 2] == x) return i;
+    }
+    return -1;
+#endif
+}
+
+
+uint32_t qt_window_clear(uint32_t* cells, uint32_t n, uint32_t x) {
+    uint32_t cleared = 0;
+    for (int64_t j = qt_window_find(cells, n, x); j >= 0;) {
+        uint32_t* cell = cells + 3 * static_cast<size_t>(j);
+        cell[0] = cell[1] = cell[2] = 0;
+        ++cleared;
+        uint32_t next = static_cast<uint32_t>(j) + 1;
+        int64_t more = qt_window_find(cells + 3 * static_cast<size_t>(next), n - next, x);
+        j = more >= 0 ? next + more : -1;
+    }
+    return cleared;
+}
+
+
+extern const SketchKernels table;
+
+const SketchKernels table = {
+        HH_KERNEL_ISA,
+        &hash_u32,
+        &countmin_add,
+        &countmin_query,
+        &probe_row_u64,
+        &argmin_u32,
+        &misra_gries_u32x8,
+        &qt_window_scan,
+        &qt_window_find,
+        &qt_window_clear,
+};
+
+} // namespace HH_KERNEL_NAMESPACE
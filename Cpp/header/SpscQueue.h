@@ -0,0 +1,116 @@
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+/*
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread:
+ * a power-of-two ring indexed by two monotonically increasing counters. try_push() and
+ * try_pop() never block; push() and pop() spin, then yield, then sleep until they succeed.
+ * After close(), push() fails and pop() drains what is left, then fails.
+ *
+ * Each side keeps its own counters (occupancy seen at push, waits on a full or empty ring),
+ * readable once both threads are done.
+ */
+template <typename T>
+class SpscQueue {
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> head{0}; // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push, written by the producer
+    alignas(64) std::atomic<bool> closed{false};
+
+    // producer side
+    alignas(64) uint64_t pushes = 0;
+    uint64_t occupancy_sum = 0;
+    uint64_t full_waits = 0;
+
+    // consumer side
+    alignas(64) uint64_t empty_waits = 0;
+
+    static size_t round_up(size_t n) {
+        size_t capacity = 1;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    static void backoff(uint32_t& round) {
+        if (round < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else if (round < 1024) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        round++;
+    }
+
+public:
+    explicit SpscQueue(size_t capacity) : slots(round_up(capacity)), mask(slots.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool try_push(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t occupied = t - head.load(std::memory_order_acquire);
+        if (occupied == slots.size()) return false;
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        pushes++;
+        occupancy_sum += occupied + 1;
+        return true;
+    }
+
+    bool try_pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(T item) {
+        uint32_t round = 0;
+        while (!closed.load(std::memory_order_acquire)) {
+            if (try_push(item)) return true;
+            if (round == 0) full_waits++;
+            backoff(round);
+        }
+        return false;
+    }
+
+    bool pop(T& item) {
+        uint32_t round = 0;
+        while (true) {
+            if (try_pop(item)) return true;
+            if (closed.load(std::memory_order_acquire)) return try_pop(item);
+            if (round == 0) empty_waits++;
+            backoff(round);
+        }
+    }
+
+    void close() { closed.store(true, std::memory_order_release); }
+
+    size_t capacity() const { return slots.size(); }
+    size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+    uint64_t push_count() const { return pushes; }
+    double mean_occupancy() const { return pushes == 0 ? 0.0 : static_cast<double>(occupancy_sum) / pushes; }
+    uint64_t full_wait_count() const { return full_waits; }
+    uint64_t empty_wait_count() const { return empty_waits; }
+};
+
+
+#endif // SPSCQUEUE_H
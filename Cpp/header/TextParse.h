@@ -0,0 +1,95 @@
+
+#ifndef TEXTPARSE_H
+#define TEXTPARSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+// Scanners for the text trace formats, working directly on mapped bytes.
+// A field is a [p, end) range; nothing is copied into std::string.
+
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p)) ++p;
+    return p;
+}
+
+inline const char* skip_token(const char* p, const char* end) {
+    while (p < end && !is_blank(*p)) ++p;
+    return p;
+}
+
+// End of the line starting at p (position of '\n', or end). memchr is vectorized by libc.
+inline const char* find_line_end(const char* p, const char* end) {
+    const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return nl != nullptr ? static_cast<const char*>(nl) : end;
+}
+
+
+// Parses a dotted quad that spans exactly [p, end).
+// Rejects missing or extra octets, octets over 255, and trailing characters.
+inline bool parse_ipv4(const char* p, const char* end, uint32_t& out) {
+    uint32_t ip = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char* octet_begin = p;
+        uint32_t octet = 0;
+        while (p < end && is_digit(*p)) {
+            octet = octet * 10 + static_cast<uint32_t>(*p - '0');
+            if (octet > 255) return false;
+            ++p;
+        }
+        if (p == octet_begin) return false;
+        ip = (ip << 8) | octet;
+        if (i < 3) {
+            if (p == end || *p != '.') return false;
+            ++p;
+        }
+    }
+    if (p != end) return false;
+    out = ip;
+    return true;
+}
+
+
+// Parses the leading decimal digits of [p, end) like std::stoul, truncated to 32 bits.
+// Returns false if the field does not start with a digit.
+inline bool parse_u32(const char* p, const char* end, uint32_t& out) {
+    if (p == end || !is_digit(*p)) return false;
+    uint64_t value = 0;
+    while (p < end && is_digit(*p)) {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+
+// Splits [0, size) into at most 'parts' ranges whose boundaries fall right after a '\n'.
+// Returns the boundaries, starting with 0 and ending with size.
+inline std::vector<size_t> split_at_lines(const char* data, size_t size, size_t parts) {
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < parts; ++i) {
+        size_t target = size * i / parts;
+        if (target <= bounds.back()) continue;
+        const char* line_end = find_line_end(data + target, data + size);
+        size_t b = (line_end == data + size) ? size : static_cast<size_t>(line_end - data) + 1;
+        if (b > bounds.back() && b < size) bounds.push_back(b);
+    }
+    bounds.push_back(size);
+    return bounds;
+}
+
+
+#endif // TEXTPARSE_H
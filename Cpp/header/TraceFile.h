@@ -0,0 +1,107 @@
+
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Sketch.h"
+
+
+/*
+ * Binary trace format (little-endian):
+ *
+ *   TraceHeader                          64 bytes
+ *   (x, y) records                       record_count * 8 bytes, packed uint32 pairs
+ *   timestamps (TRACE_COL_TIMESTAMP)     record_count * 8 bytes, uint64 nanoseconds
+ *   weights    (TRACE_COL_WEIGHT)        record_count * 4 bytes, uint32
+ *
+ * A trace converted from a text file records the size, modification time and
+ * checksum of its source, and the format and parser version it was parsed with,
+ * so that a cached "<source>.bin" can be validated.
+ */
+
+enum TraceColumns : uint32_t {
+    TRACE_COL_TIMESTAMP = 1u << 0,
+    TRACE_COL_WEIGHT = 1u << 1,
+};
+
+struct TraceHeader {
+    char magic[8];            // "DSTRACE1"
+    uint32_t version;
+    uint32_t header_bytes;    // sizeof(TraceHeader)
+    uint64_t record_count;
+    uint8_t key_width_x;      // bytes per flow key
+    uint8_t key_width_y;      // bytes per element key
+    uint16_t source_format;   // format the source was parsed as (trace_format_id), 0 if none
+    uint32_t columns;         // TraceColumns present after the records
+    uint64_t source_size;     // 0 if not converted from a file
+    int64_t source_mtime_ns;
+    uint64_t source_checksum;
+    uint32_t parser_version;  // version of that format's parser (trace_parser_version)
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(TraceHeader) == 64, "TraceHeader must stay 64 bytes");
+
+
+// The optional per-record columns
+struct TraceExtras {
+    std::vector<uint64_t> timestamps;
+    std::vector<uint32_t> weights;
+};
+
+
+// Fills size, mtime and (if with_checksum) checksum of 'source_path' into 'header'.
+bool describe_source(const std::string& source_path, TraceHeader& header, bool with_checksum);
+
+// 64-bit checksum of a byte range, as stored in source_checksum
+uint64_t trace_checksum(const char* data, size_t size);
+
+// Writes 'records' (and the non-empty extra columns) to 'path' via a temporary file and rename.
+// 'source' supplies the source_* fields and parser_version; pass nullptr for generated traces.
+bool write_trace(const std::string& path, const std::vector<Record>& records,
+                 const TraceHeader* source = nullptr, const TraceExtras* extras = nullptr);
+
+// Writes a trace of a known number of records piece by piece, without holding it in memory.
+// Like write_trace, the target only appears once close() has succeeded.
+class TraceWriter {
+private:
+    std::FILE* out = nullptr;
+    std::string path;
+    std::string tmp_path;
+    uint64_t expected = 0;
+    uint64_t written = 0;
+    bool ok = false;
+
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool open(const std::string& path, uint64_t record_count);
+    bool append(const Record* records, size_t n);
+
+    // Fails (and removes the partial file) if the number of records differs from record_count.
+    bool close();
+};
+
+// Reads a whole trace with one sequential mmap. Appends to 'records'.
+bool read_trace(const std::string& path, std::vector<Record>& records,
+                TraceHeader* header = nullptr, TraceExtras* extras = nullptr);
+
+// Reads and checks only the header (magic, version, key widths and file size).
+bool read_trace_header(const std::string& path, TraceHeader& header);
+
+// True if 'cache_path' is a trace converted from the current version of 'source_path' by the
+// given format's parser at the given version. Size and mtime are always compared; the
+// checksum only when verify_checksum is set, since it requires reading the whole source.
+bool trace_cache_valid(const std::string& cache_path, const std::string& source_path,
+                       uint16_t source_format, uint32_t parser_version, bool verify_checksum = false);
+
+
+#endif // TRACEFILE_H
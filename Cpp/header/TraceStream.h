@@ -0,0 +1,72 @@
+
+#ifndef TRACESTREAM_H
+#define TRACESTREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+#include "Loaders.h"
+#include "Sketch.h"
+
+
+struct StreamConfig {
+    size_t chunk_records = 1 << 16; // records per chunk handed to the consumer
+    size_t queue_depth = 4;         // chunks that may wait between reader and consumer
+};
+
+
+/*
+ * Reads trace files front to back on a background thread and hands the records
+ * over in fixed-size chunks, so a trace is never held in memory as a whole.
+ * At most queue_depth + 2 chunks exist at any time: the chunk buffers circulate
+ * between the reader and the consumer, and the reader blocks while all of them
+ * are full. Text files with a valid .bin cache are read from the cache.
+ *
+ *   TraceStream stream(files, TraceFormat::CAIDA);
+ *   std::vector<Record> chunk;
+ *   while (stream.next(chunk)) { ... }
+ */
+class TraceStream {
+private:
+    std::vector<std::string> file_paths;
+    TraceFormat format;
+    StreamConfig config;
+
+    BoundedQueue<std::vector<Record>> full_chunks;
+    BoundedQueue<std::vector<Record>> free_chunks;
+    std::thread reader;
+
+    std::atomic<uint64_t> records_read{0};
+    std::atomic<uint64_t> bytes_read{0};
+    std::atomic<uint64_t> skipped_lines{0};
+    std::atomic<uint32_t> failed_files{0};
+
+    void read_all();
+    bool read_binary(const std::string& path, std::vector<Record>& chunk);
+    bool read_text(const std::string& path, TraceFormat text_format, std::vector<Record>& chunk);
+    bool read_capture(const std::string& path, std::vector<Record>& chunk);
+    bool emit(std::vector<Record>& chunk);
+
+public:
+    TraceStream(std::vector<std::string> file_paths, TraceFormat format, StreamConfig config = {});
+    ~TraceStream();
+
+    TraceStream(const TraceStream&) = delete;
+    TraceStream& operator=(const TraceStream&) = delete;
+
+    // Replaces 'chunk' with the next chunk of records, recycling the old buffer.
+    // Returns false once every file has been read.
+    bool next(std::vector<Record>& chunk);
+
+    uint64_t records() const { return records_read; }
+    uint64_t bytes() const { return bytes_read; }
+    uint64_t skipped() const { return skipped_lines; }
+    uint32_t failed() const { return failed_files; }
+};
+
+
+#endif // TRACESTREAM_H
@@ -0,0 +1,135 @@
+
+#ifndef TRACKINGALLOCATOR_H
+#define TRACKINGALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+
+/*
+ * Measured memory footprint of a sketch. Every table of a sketch allocates through an
+ * allocator bound to the sketch's MemoryTracker, which adds up the heap bytes actually
+ * reserved for each block (malloc_usable_size: the request rounded up to its malloc size
+ * class), so spare vector capacity, hash-map nodes and bucket arrays, and alignment
+ * padding all count, unlike a size computed from the nominal table dimensions.
+ *
+ * A copied sketch (a pipeline snapshot) reports the footprint of its source at the time
+ * of the copy: the copied tracker keeps the totals, while the copied containers get an
+ * unbound allocator, so that no copy ever reports into another sketch's tracker.
+ */
+
+// Heap bytes reserved for a block returned by malloc / aligned_alloc
+inline size_t heap_block_bytes(void* block, size_t requested) {
+#if defined(__GLIBC__)
+    (void)requested;
+    return malloc_usable_size(block);
+#else
+    (void)block;
+    return requested;
+#endif
+}
+
+
+template <typename T>
+class TrackingAllocator;
+
+class MemoryTracker {
+private:
+    size_t current = 0;
+    size_t peak = 0;
+    uint64_t allocations = 0;
+
+public:
+    MemoryTracker() = default;
+
+    // Copies keep the totals of the source; see above. Assigning a sketch leaves its own
+    // tracker alone, since its containers keep their allocators and report the change.
+    MemoryTracker(const MemoryTracker&) = default;
+    MemoryTracker& operator=(const MemoryTracker&) { return *this; }
+
+    void add(size_t bytes) {
+        current += bytes;
+        allocations++;
+        if (current > peak) peak = current;
+    }
+
+    void remove(size_t bytes) { current -= bytes; }
+
+    // heap bytes held right now, at most, and the number of allocations made
+    size_t bytes() const { return current; }
+    size_t peak_bytes() const { return peak; }
+    uint64_t allocation_count() const { return allocations; }
+
+    // An allocator reporting to this tracker, convertible to any value type
+    TrackingAllocator<char> allocator();
+};
+
+
+template <typename T>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    // containers take their allocator along when moved or swapped
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    MemoryTracker* tracker = nullptr;  // nullptr: not tracked
+
+    TrackingAllocator() noexcept = default;
+    explicit TrackingAllocator(MemoryTracker* tracker) noexcept : tracker(tracker) {}
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U>& other) noexcept : tracker(other.tracker) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        void* block;
+        if constexpr (alignof(T) > alignof(std::max_align_t)) {
+            block = std::aligned_alloc(alignof(T), (bytes + alignof(T) - 1) / alignof(T) * alignof(T));
+        } else {
+            block = std::malloc(bytes);
+        }
+        if (block == nullptr) throw std::bad_alloc();
+        if (tracker != nullptr) tracker->add(heap_block_bytes(block, bytes));
+        return static_cast<T*>(block);
+    }
+
+    void deallocate(T* block, size_t n) noexcept {
+        if (tracker != nullptr) tracker->remove(heap_block_bytes(block, n * sizeof(T)));
+        std::free(block);
+    }
+
+    // a copied container is not tracked
+    TrackingAllocator select_on_container_copy_construction() const { return TrackingAllocator(); }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U>& other) const { return tracker == other.tracker; }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U>& other) const { return tracker != other.tracker; }
+};
+
+
+inline TrackingAllocator<char> MemoryTracker::allocator() {
+    return TrackingAllocator<char>(this);
+}
+
+
+template <typename T>
+using TrackedVector = std::vector<T, TrackingAllocator<T>>;
+
+template <typename K, typename V>
+using TrackedHashMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
+        TrackingAllocator<std::pair<const K, V>>>;
+
+
+#endif // TRACKINGALLOCATOR_H
@@ -1,42 +1,75 @@
 
-
 #ifndef TWODMISRAGRIES_H
 #define TWODMISRAGRIES_H
 
 #include <iostream>
 #include <vector>
 #include <cstdint>
-#include <unordered_map>
+#include <random>
 #include <algorithm>
 #include <map>
+#include "AlignedBuffer.h"
+#include "Sketch.h"
+#include "SketchKernels.h"
+
 
+// length of inner_list, fixed at compile time so that it can live inline in a slot
+constexpr uint32_t MG_INNER_LEN = 8;
 
-struct InnerStruct {
-    uint32_t key_inner;
-    uint32_t freq_inner;
 
-    InnerStruct() : key_inner(0), freq_inner(0){}
+// One flow in the arena: heavy hitter key, its frequency and an inline inner list.
+// 80 bytes, so an update touches at most two cache lines of the arena.
+struct alignas(16) OuterSlot {
+    uint32_t key_outer;
+    uint32_t freq_outer;
+    uint32_t inner_size; // number of valid entries in the inner list
+    uint32_t reserved;
+    uint32_t key_inner[MG_INNER_LEN];
+    uint32_t freq_inner[MG_INNER_LEN];
 };
 
 
-struct OuterStruct {
-    uint32_t freq_outer;
-    std::vector<InnerStruct> inner_list;
+// Open-addressing index entry: flow key -> slot position in the arena
+struct SlotIndexEntry {
+    uint32_t key;
+    uint32_t slot; // EMPTY_SLOT if the entry is unused
 };
 
 
-class TwoDMisraGries {
+class TwoDMisraGries : public SketchBase<TwoDMisraGries> {
 
 private:
 
-    size_t s1; // length of outer_map
-    size_t s2; // length of inner_list
+    static constexpr uint32_t s2 = MG_INNER_LEN; // length of inner_list
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    size_t s1; // length of outer list
+
+    MemoryTracker memory; // both tables allocate through it
+
+    // Arena of s1 slots; live slots are kept dense in [0, num_slots)
+    AlignedBuffer<OuterSlot> slots;
+    uint32_t num_slots;
 
-    // Use a map (rather than a list) to store flow info,
-    // to avoid traversal when looking up a flow in update process
-    std::unordered_map<uint32_t, OuterStruct> outer_map;
+    // Use a hash index (rather than a list scan) to locate a flow in update process.
+    // Linear probing with backward-shift deletion, capacity is a power of two >= 2 * s1.
+    AlignedBuffer<SlotIndexEntry> index;
+    uint32_t index_mask;
+    uint32_t index_shift; // 32 - log2(capacity): positions are the top bits of the hash
 
-    void update_inner_list(std::vector<InnerStruct>& list, uint32_t key_inner);
+    std::mt19937 gen; // picks the inner entry to decay
+
+    const SketchKernels* kernels = &sketch_kernels(); // inner list updates
+
+    uint32_t index_pos(uint32_t x) const;
+    uint32_t find_slot(uint32_t x) const;
+    void index_insert(uint32_t x, uint32_t slot);
+    void index_erase(uint32_t x);
+    void index_relocate(uint32_t x, uint32_t slot);
+
+    void update_inner_list(OuterSlot& outer, uint32_t key_inner);
+
+    void decrement_all();
 
 public:
     TwoDMisraGries(float memory_kb);
@@ -46,10 +79,15 @@ public:
     std::pair<std::map<uint32_t, uint32_t>,
             std::map<uint32_t, std::map<uint32_t, uint32_t>>> query(uint32_t heavy_hitter_th, float phi);
 
-    void evaluation(const std::vector<std::pair<uint32_t, uint32_t>>& dataset,
-                    const std::map<uint32_t, uint32_t>& flows,
-                    std::map<uint32_t, std::map<uint32_t, uint32_t>> quadratic_eles,
-                    uint32_t heavy_hitter_th, float phi);
+    size_t memory_bytes() const;
+
+    void reset();
+
+    static const char* name() { return "2D-MG"; }
+
+    // index entries a lookup of flow x reads (1 if x sits at its home position), to check how
+    // the index spreads a set of keys
+    uint32_t index_probes(uint32_t x) const;
 
 };
 
@@ -0,0 +1,45 @@
+
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Sketch.h"
+
+
+/*
+ * Adversarial and stress inputs for the sketch update paths:
+ *
+ *   distinct          every record is a new flow and a new element; in DualSketch this
+ *                     keeps hitting Case 3 and the QT clearing loop
+ *   bucket-collision  flows that all hash to the same DualSketch HT bucket (hash % m1)
+ *   window-collision  flows in different HT buckets sharing one QT window (hash % (m2 - k + 1)),
+ *                     each with a stream of new elements
+ *   single-flow       one flow with all-distinct elements; exercises the Space-Saving
+ *                     eviction scans of GlobalHH and CSSCHH
+ *   churn             a small set of heavy flows over background noise, replaced by a
+ *                     fresh set in every phase
+ *
+ * The colliding keys are found by hashing candidates with the geometry and seed of a
+ * DualSketch of the given memory, so they only collide at that memory budget.
+ */
+enum class Workload { Distinct, BucketCollision, WindowCollision, SingleFlow, Churn };
+
+struct WorkloadConfig {
+    uint64_t records = 1 << 18;  // small by default: the Space-Saving baselines run at ~0.03 Mdps here
+    float memory_kb = 400;       // DualSketch memory the collisions are crafted for
+    uint32_t colliding_flows = 64;
+    uint32_t churn_phases = 16;
+    uint32_t churn_heavy_flows = 32;
+    uint64_t seed = 1;
+};
+
+const std::vector<Workload>& all_workloads();
+const char* workload_name(Workload workload);
+bool parse_workload(const std::string& name, Workload& workload);
+
+std::vector<Record> make_workload(Workload workload, const WorkloadConfig& config);
+
+
+#endif // WORKLOADS_H
@@ -0,0 +1,122 @@
+
+#ifndef ZIPFGENERATOR_H
+#define ZIPFGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+#include "Sketch.h"
+
+
+// How ranks beyond the key space are handled
+enum class ZipfTail {
+    Clip,     // unbounded Zipf(alpha), ranks above the maximum become the maximum (numpy.random.zipf + np.clip)
+    Truncate, // Zipf restricted to [1, maximum]; also valid for alpha <= 1
+};
+
+
+// Defaults reproduce the distribution of dataset/genSyntheticDataset.py
+struct ZipfConfig {
+    uint64_t records = 127001730;
+    double flow_alpha = 1.1;
+    double element_alpha = 1.4;
+    uint32_t max_flow = 149197297;
+    uint32_t max_element = 87963297;
+    ZipfTail tail = ZipfTail::Clip;
+    uint64_t seed = 1;
+};
+
+
+/*
+ * Synthetic (flow, element) stream with independent Zipf-distributed flow and element ranks.
+ * The ranks (>= 1) are the keys, as the synthetic text loader reads genSyntheticDataset.py's.
+ *
+ * The stream is cut into blocks of BLOCK_RECORDS records, and block b is drawn from its
+ * own generator seeded with (seed, b). Any block can therefore be produced on any thread,
+ * and the stream for a given configuration is the same for every thread count.
+ */
+class ZipfGenerator {
+public:
+    static constexpr size_t BLOCK_RECORDS = 1 << 20;
+
+    explicit ZipfGenerator(const ZipfConfig& config);
+
+    // Empty if the configuration can be sampled, otherwise the reason it cannot.
+    std::string validate() const;
+
+    const ZipfConfig& config() const { return cfg; }
+    uint64_t num_blocks() const { return (cfg.records + BLOCK_RECORDS - 1) / BLOCK_RECORDS; }
+
+    // Replaces 'out' with the records of 'block'.
+    void generate_block(uint64_t block, std::vector<Record>& out) const;
+
+    // The whole stream, generated on 'num_threads' threads (0 for all hardware threads).
+    std::vector<Record> generate(unsigned num_threads = 0) const;
+
+private:
+    // Sampler for one key dimension. A clipped tail is sampled as the mixture of the
+    // point mass at the maximum and the truncated distribution below it.
+    struct Dimension {
+        double alpha;
+        uint32_t maximum;
+        ZipfTail tail;
+
+        // probability of the clipped tail
+        double p_clip;
+
+        // rejection-inversion (Hoermann and Derflinger), ranks in [1, maximum]
+        double h_integral_x1;
+        double h_integral_n;
+        double s;
+
+        void init(double alpha, uint32_t maximum, ZipfTail tail);
+        template <typename Rng>
+        uint32_t sample(Rng& rng) const;
+    };
+
+    ZipfConfig cfg;
+    Dimension flow;
+    Dimension element;
+};
+
+
+/*
+ * Generates a ZipfGenerator stream ahead of the consumer on a set of worker threads and
+ * hands it over block by block, in stream order. Worker t produces blocks t, t + T, ...;
+ * each worker can be at most two blocks ahead.
+ *
+ *   ZipfStream stream(generator, 8);
+ *   std::vector<Record> chunk;
+ *   while (stream.next(chunk)) { ... }
+ */
+class ZipfStream {
+public:
+    ZipfStream(const ZipfGenerator& generator, unsigned num_threads = 0);
+    ~ZipfStream();
+
+    ZipfStream(const ZipfStream&) = delete;
+    ZipfStream& operator=(const ZipfStream&) = delete;
+
+    // Replaces 'chunk' with the next block, recycling the old buffer.
+    // Returns false at the end of the stream.
+    bool next(std::vector<Record>& chunk);
+
+private:
+    struct Worker {
+        BoundedQueue<std::vector<Record>> full{2};
+        BoundedQueue<std::vector<Record>> free{3};
+        std::thread thread;
+    };
+
+    const ZipfGenerator& generator;
+    std::vector<Worker> workers;
+    uint64_t next_block = 0;
+
+    void produce(unsigned index);
+};
+
+
+#endif // ZIPFGENERATOR_H
@@ -0,0 +1,95 @@
+
+#ifndef DUALSKETCH_C_H
+#define DUALSKETCH_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * C interface of libdualsketch, for embedding DualSketch in other programs (and other
+ * languages). Only this header is installed; the layout of the structs and the meaning
+ * of the functions below keep their ABI, the C++ classes behind them do not.
+ *
+ * Updates are batched: one call takes any number of records, so the cost of crossing the
+ * library boundary is paid once per batch. Queries write into buffers of the caller.
+ * No function throws, and a sketch must not be used by two threads at once.
+ */
+
+// The library is built with DUALSKETCH_BUILDING. On Windows, programs that link the static
+// library define DUALSKETCH_STATIC (the CMake target does so for them).
+#if defined(_WIN32) && defined(DUALSKETCH_STATIC)
+#define DUALSKETCH_API
+#elif defined(_WIN32) && defined(DUALSKETCH_BUILDING)
+#define DUALSKETCH_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define DUALSKETCH_API __declspec(dllimport)
+#else
+#define DUALSKETCH_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct dualsketch dualsketch;
+
+typedef struct {
+    uint32_t flow;     // x, the heavy hitter key
+    uint32_t element;  // y; 0 marks an empty cell and is not counted as an element
+} dualsketch_record;
+
+typedef struct {
+    uint32_t flow;
+    uint32_t estimate;
+} dualsketch_heavy_hitter;
+
+typedef struct {
+    uint32_t flow;
+    uint32_t element;
+    uint32_t estimate;
+} dualsketch_element;
+
+enum {
+    DUALSKETCH_OK = 0,
+    DUALSKETCH_INVALID_ARGUMENT = -1,
+    DUALSKETCH_BUFFER_TOO_SMALL = -2,   // the counts hold the sizes needed
+    DUALSKETCH_INCOMPATIBLE = -3,       // merge of sketches of different memory sizes
+    DUALSKETCH_OUT_OF_MEMORY = -4,      // allocation failed; the sketches are unchanged
+};
+
+
+// A sketch of 'memory_kb' KB; NULL if the size is too small for the tables or allocation fails
+DUALSKETCH_API dualsketch* dualsketch_create(float memory_kb);
+
+DUALSKETCH_API void dualsketch_destroy(dualsketch* sketch);
+
+DUALSKETCH_API void dualsketch_update(dualsketch* sketch, const dualsketch_record* records, size_t count);
+
+// Heavy hitters with an estimate >= 'heavy_hitter_threshold' packets, and their elements with
+// an estimate >= phi * the heavy hitter's. '*hitter_count' and '*element_count' receive the
+// numbers found; if either exceeds its capacity, DUALSKETCH_BUFFER_TOO_SMALL is returned and
+// the buffers hold the first 'capacity' entries. Ordered by flow, then element.
+// DUALSKETCH_OUT_OF_MEMORY if the results could not be collected.
+DUALSKETCH_API int dualsketch_query(const dualsketch* sketch, uint32_t heavy_hitter_threshold, float phi,
+                                    dualsketch_heavy_hitter* hitters, size_t hitter_capacity, size_t* hitter_count,
+                                    dualsketch_element* elements, size_t element_capacity, size_t* element_count);
+
+// Adds the counts of 'from' to 'into'; both must have been created with the same memory size.
+// DUALSKETCH_OUT_OF_MEMORY if the merge could not allocate; 'into' is then unchanged.
+DUALSKETCH_API int dualsketch_merge(dualsketch* into, const dualsketch* from);
+
+// A byte image of the sketch, independent of the host's byte order
+DUALSKETCH_API size_t dualsketch_serialized_size(const dualsketch* sketch);
+DUALSKETCH_API int dualsketch_serialize(const dualsketch* sketch, void* buffer, size_t capacity, size_t* written);
+
+// NULL if 'data' is not a complete image written by dualsketch_serialize()
+DUALSKETCH_API dualsketch* dualsketch_deserialize(const void* data, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DUALSKETCH_C_H
@@ -12,16 +12,27 @@
 #include <map>
 #include <set>
 #include <cstdint>
+#include <optional>
+#include <algorithm>
+#include <tuple>
+#include "header/DualSketch.h"
+#include "header/DUET.h"
 #include "header/GlobalHH.h"
 #include "header/TwoDMisraGries.h"
+#include "header/CSSCHH.h"
+#include "header/SketchDriver.h"
+#include "header/Evaluator.h"
+#include "header/Loaders.h"
+#include "header/Pipeline.h"
+#include "header/Algorithms.h"
+#include "header/ExperimentConfig.h"
+#include "header/DualSketchStats.h"
+#include "header/ResultLog.h"
+#include "header/SketchKernels.h"
 
 
 #ifdef _WIN32
 //#include <winsock2.h>
-#include <optional>
-#include "header/DualSketch.h"
-#include "header/DUET.h"
-#include "header/CSSCHH.h"
 
 #pragma comment(lib, "ws2_32.lib")
 #else
@@ -29,374 +40,276 @@
 #endif
 
 
-/**
- * @brief Loads the CAIDA 2019 dataset from specified files.
- * @return A tuple containing three collections:
- * 1. std::vector<std::pair<uint32_t, uint32_t>>: The raw dataset of (source_ip, dest_ip) pairs.
- * 2. std::map<uint32_t, uint32_t>: The true count for each flow (source IP).
- * 3. std::map<uint32_t, std::map<uint32_t, uint32_t>>: The true count for each element (dest IP)
- * within each flow (source IP).
- */
-std::tuple<std::vector<std::pair<uint32_t, uint32_t>>,
-        std::map<uint32_t, uint32_t>,
-        std::map<uint32_t, std::map<uint32_t, uint32_t>>> loadDataSetCAIDA() {
-    std::vector<std::string> file_paths = {
-            "./dataset/CAIDA2019/file1.txt",
-            "./dataset/CAIDA2019/file2.txt",
-            // your dataset file list
-    };
+// The dataset of a batch experiment: the given files, or the loader's defaults
+static std::tuple<std::vector<Record>, ExactCounts> load_dataset(const ExperimentConfig &cfg) {
+    if (cfg.has_key_spec && !cfg.files.empty()) return loadDataSet(cfg.files, cfg.format, cfg.key_spec);
+    if (!cfg.files.empty()) return loadDataSet(cfg.files, cfg.format);
+
+    switch (cfg.format) {
+        case TraceFormat::CAIDA: return loadDataSetCAIDA();
+        case TraceFormat::MAWI: return cfg.has_key_spec ? loadDataSetMAWI({"./dataset/MAWI2024/parsed_mawi_2024.csv"},
+                                                                          cfg.key_spec)
+                                                        : loadDataSetMAWI();
+        case TraceFormat::FIMI: return loadDatasetFreqItemMining();
+        case TraceFormat::Synthetic: return loadSyntheticDataset();
+        default:
+            std::cerr << "This format has no default files; pass trace files on the command line." << std::endl;
+            return {};
+    }
+}
 
-    std::vector<std::pair<uint32_t, uint32_t>> data;
-    std::map<uint32_t, uint32_t> true_flow_size;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_element_size;
-    uint64_t total_data_num = 0;
 
-    for (const auto &file_path: file_paths) {
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << file_path << std::endl;
-            continue;
-        }
+// The dataset as recorded in result logs: the format and the files
+static std::string dataset_name(const ExperimentConfig &cfg) {
+    std::string name = std::string(trace_format_name(cfg.format)) + ":";
+    if (cfg.files.empty()) return name + " default files";
+    for (size_t i = 0; i < cfg.files.size(); ++i) name += (i == 0 ? " " : ",") + cfg.files[i];
+    return name;
+}
 
-        std::string line;
-        while (getline(file, line)) {
-            std::istringstream iss(line);
-            std::string source_ip, dest_ip;
-            iss >> source_ip >> dest_ip;
-            if (source_ip.empty() || dest_ip.empty()) continue;
-
-            uint32_t src_ip_int = 0, dst_ip_int = 0;
-            int part = 0;
-            char dot;
-            std::istringstream ss1(source_ip), ss2(dest_ip);
-            bool valid = true;
-
-            for (int i = 0; i < 4; i++) {
-                if (!(ss1 >> part)) {
-                    valid = false;
-                    break;
-                }
-                if (part < 0 || part > 255) {
-                    valid = false;
-                    break;
-                }
-                src_ip_int = (src_ip_int << 8) | part;
-                if (i < 3 && !(ss1 >> dot && dot == '.')) {
-                    valid = false;
-                    break;
-                }
-            }
-            if (ss1 >> dot) valid = false;
 
-            for (int i = 0; i < 4 && valid; i++) {
-                if (!(ss2 >> part)) {
-                    valid = false;
-                    break;
-                }
-                if (part < 0 || part > 255) {
-                    valid = false;
-                    break;
-                }
-                dst_ip_int = (dst_ip_int << 8) | part;
-                if (i < 3 && !(ss2 >> dot && dot == '.')) {
-                    valid = false;
-                    break;
-                }
-            }
-            if (ss2 >> dot) valid = false;
+// The result log row of the repeats of one algorithm at one setting
+static ResultRow make_row(const char *mode, const ExperimentConfig &cfg, float hh_th_ratio, float ele_th_phi,
+                          const std::vector<RunResult> &runs) {
+    ResultRow row = result_row(runs);
+    row.mode = mode;
+    row.dataset = dataset_name(cfg);
+    row.phi_1 = hh_th_ratio;
+    row.phi_2 = ele_th_phi;
+    row.batch_size = cfg.batch_size;
+    return row;
+}
 
-            if (!valid) continue;
 
-            if (src_ip_int == 0 || dst_ip_int == 0) continue;
+// With repeats, the first run is reported in full and the throughput of all runs is summarized
+static void report_repeats(const std::vector<RunResult> &runs) {
+    if (runs.size() < 2) return;
+    std::vector<double> throughput;
+    for (const auto &run: runs) throughput.push_back(run.update_throughput_Mdps);
+    std::sort(throughput.begin(), throughput.end());
+    std::cout << " - Throughput over " << runs.size() << " runs: median " << throughput[throughput.size() / 2]
+              << " Mdps, min " << throughput.front() << ", max " << throughput.back() << std::endl;
+}
 
-            data.emplace_back(src_ip_int, dst_ip_int);
-            true_flow_size[src_ip_int]++;
-            true_element_size[src_ip_int][dst_ip_int]++;
-            total_data_num++;
-        }
 
-        std::cout << file_path << " is loaded." << std::endl;
+static void print_setting(float hh_th_ratio, float ele_th_phi, float memo_kb, uint64_t num_records = 0) {
+    std::cout << "\n";
+    if (num_records > 0) {
+        std::cout << "Heavy hitter th = " << static_cast<uint32_t>(hh_th_ratio * num_records) << " (N*phi), ";
     }
-
-    std::cout << file_paths.size() << " data loaded.\n"
-              << "Totaling packets: " << total_data_num
-              << ", Unique flows (src_ip as flow label): " << true_flow_size.size() << std::endl;
-
-    return std::make_tuple(data, true_flow_size, true_element_size);
+    std::cout << "phi_1 = " << hh_th_ratio
+              << ", Quad element th (phi_2) = " << ele_th_phi
+              << ", memo_kb = " << memo_kb
+              << std::endl;
 }
 
 
-/**
- * @brief Loads the MAWI dataset from specified files.
- * @return A tuple containing three collections:
- * 1. std::vector<std::pair<uint32_t, uint32_t>>: The raw dataset of (source_ip, dest_ip) pairs.
- * 2. std::map<uint32_t, uint32_t>: The true count for each flow (source IP).
- * 3. std::map<uint32_t, std::map<uint32_t, uint32_t>>: The true count for each element (dest IP)
- * within each flow (source IP).
- */
-std::tuple<
-        std::vector<std::pair<uint32_t, uint32_t>>,
-        std::map<uint32_t, uint32_t>,
-        std::map<uint32_t, std::map<uint32_t, uint32_t>>
-> loadDataSetMAWI() {
-    std::vector<std::string> file_paths = {
-            // your dataset file list
-            "./dataset/MAWI2024/parsed_mawi_2024.csv",
-    };
-
-    std::vector<std::pair<uint32_t, uint32_t>> data;
-    std::map<uint32_t, uint32_t> true_flow_size;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> true_element_size;
-    uint64_t total_data_num = 0;
-
-    auto parse_ip = [](const std::string &ip_str) -> std::optional<uint32_t> {
-        std::stringstream ss(ip_str);
-        uint32_t result = 0;
-        int part;
-
-        for (int i = 0; i < 4; ++i) {
-            if (!(ss >> part)) return std::nullopt;
-            if (part < 0 || part > 255) return std::nullopt;
-            result = (result << 8) | part;
-            if (i < 3) {
-                if (ss.peek() != '.') return std::nullopt;
-                ss.ignore();
-            }
-        }
-
-        if (ss.rdbuf()->in_avail() != 0) return std::nullopt;
-        return result;
-    };
-
-    for (const auto &file_path: file_paths) {
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << file_path << std::endl;
-            continue;
-        }
+// One (phi_1, phi_2, memory) setting of the sweep and its runs, repeat runs per algorithm
+struct Setting {
+    float hh_th_ratio;
+    float ele_th_phi;
+    float memo_kb;
+    const GroundTruth *truth;
+    size_t first_job;
+};
+
+
+static void report_setting(const ExperimentConfig &cfg, const Setting &setting, const std::vector<RunResult> &results,
+                           uint64_t num_records, ResultLog &log) {
+    print_setting(setting.hh_th_ratio, setting.ele_th_phi, setting.memo_kb, num_records);
+    size_t job = setting.first_job;
+    for (size_t a = 0; a < cfg.algorithms.size(); ++a, job += cfg.repeat) {
+        std::vector<RunResult> runs(results.begin() + job, results.begin() + job + cfg.repeat);
+        AccuracyMetrics metrics = Evaluator::score(*setting.truth, runs[0].answer);
+        report_run(runs[0], metrics);
+        report_repeats(runs);
+
+        ResultRow row = make_row("batch", cfg, setting.hh_th_ratio, setting.ele_th_phi, runs);
+        row.has_accuracy = true;
+        row.accuracy = metrics;
+        log.add(std::move(row));
+    }
+}
 
-        std::string line;
-        if (!std::getline(file, line)) {
-            std::cerr << "Empty file: " << file_path << std::endl;
-            continue;
-        }
 
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string src_ip_str, dst_ip_str;
+// The dataset and its ground truth are loaded once, and every configuration runs against them.
+// Serially (the default) each run has the machine to itself; with --parallel, runs share the
+// read-only dataset on a pool of pinned threads and are reported once all have finished.
+static int batch_experiment(const ExperimentConfig &cfg, ResultLog &log) {
 
-            // Assumes field order is: src_ip,dst_ip,...
-            if (!std::getline(ss, src_ip_str, ',')) continue;
-            if (!std::getline(ss, dst_ip_str, ',')) continue;
+    auto [dataset, exact_counts] = load_dataset(cfg);
+    if (dataset.empty()) {
+        std::cerr << "No records loaded." << std::endl;
+        return 1;
+    }
 
-            auto src_ip_opt = parse_ip(src_ip_str);
-            auto dst_ip_opt = parse_ip(dst_ip_str);
-            if (!src_ip_opt || !dst_ip_opt) continue;
+    // true heavy hitters and hot elements are derived once per (phi_1, phi_2), before any run starts
+    Evaluator evaluator(exact_counts);
 
-            uint32_t src_ip = src_ip_opt.value();
-            uint32_t dst_ip = dst_ip_opt.value();
+    std::vector<Setting> settings;
+    std::vector<RunJob> jobs;
+    for (float hh_th_ratio: cfg.phi_1) {
+        for (float ele_th_phi: cfg.phi_2) {
 
-            if (src_ip == 0 || dst_ip == 0) continue;
+            uint32_t heavy_hitter_th = hh_th_ratio * dataset.size();
+            const GroundTruth &truth = evaluator.truth(heavy_hitter_th, ele_th_phi);
 
-            data.emplace_back(src_ip, dst_ip);
-            true_flow_size[src_ip]++;
-            true_element_size[src_ip][dst_ip]++;
-            total_data_num++;
+            for (float memo_kb: cfg.memory_kb) {
+                settings.push_back({hh_th_ratio, ele_th_phi, memo_kb, &truth, jobs.size()});
+                RunConfig config{heavy_hitter_th, ele_th_phi, cfg.batch_size, cfg.latency_sample};
+                for (const Algorithm *algorithm: cfg.algorithms) {
+                    for (unsigned r = 0; r < cfg.repeat; ++r) jobs.push_back({algorithm, memo_kb, config});
+                }
+            }
         }
-
-        std::cout << "Loaded file: " << file_path << std::endl;
     }
 
-    std::cout << "Total data: " << total_data_num;
-    std::cout << ", Unique flows (src_ip as flow ID): " << true_flow_size.size() << std::endl;
-
-    return std::make_tuple(data, true_flow_size, true_element_size);
-}
-
-
-std::tuple<std::vector<std::pair<uint32_t, uint32_t>>,
-        std::map<uint32_t, uint32_t>,
-        std::map<uint32_t, std::map<uint32_t, uint32_t>>> loadDatasetFreqItemMining() {
-
-    std::vector<std::string> file_paths = {
-            "./dataset/Frequent Itemset Mining Dataset Repository/kosarak.dat",
-            "./dataset/Frequent Itemset Mining Dataset Repository/pumsb.dat",
-            "./dataset/Frequent Itemset Mining Dataset Repository/pumsb_star.dat",
-            "./dataset/Frequent Itemset Mining Dataset Repository/T10I4D100K.dat",
-            "./dataset/Frequent Itemset Mining Dataset Repository/T40I10D100K.dat",
-            "./dataset/Frequent Itemset Mining Dataset Repository/webdocs.dat",
+    ConfigRunner runner(dataset, cfg.parallel, cfg.cores);
+    std::vector<RunResult> results(jobs.size());
+
+    // DualSketch event counters (DUALSKETCH_STATS builds), summed over the repeats of a setting
+    DualSketchStats stats_before = dualsketch_stats();
+    auto report_stats = [&]() {
+        DualSketchStats stats = dualsketch_stats();
+        DualSketchStats delta = stats;
+        delta -= stats_before;
+        stats_before = stats;
+        if (delta[DualSketchEvent::Update] > 0) print_dualsketch_stats(delta, std::cout);
     };
 
-    std::vector<std::pair<uint32_t, uint32_t>> data;
-    std::map<uint32_t, uint32_t> flow_true_count;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> flow_element_true_count;
-
-    uint64_t total_data_num = 0;
-
-    for (const auto &file_path: file_paths) {
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << file_path << std::endl;
-            continue;
+    if (runner.worker_count() <= 1) {
+        for (const Setting &setting: settings) {
+            size_t count = cfg.algorithms.size() * cfg.repeat;
+            std::vector<RunJob> setting_jobs(jobs.begin() + setting.first_job, jobs.begin() + setting.first_job + count);
+            std::vector<RunResult> runs = runner.run(setting_jobs);
+            std::move(runs.begin(), runs.end(), results.begin() + setting.first_job);
+            report_setting(cfg, setting, results, dataset.size(), log);
+            report_stats();
         }
+        return 0;
+    }
 
-        std::string line;
-        uint32_t line_count = 0;
-
-        while (getline(file, line)) {
-            line_count++;
-            if (line.empty() || line.find_first_not_of(" \t\n\r") == std::string::npos) {
-                continue;
-            }
-
-            std::istringstream iss(line);
-            std::vector<uint32_t> numbers;
-            uint32_t number;
-
-            while (iss >> number) {
-                numbers.push_back(number);
-            }
-
-            if (numbers.size() < 1) {
-                continue;
-            }
+    std::cout << "Running " << jobs.size() << " configurations on " << runner.worker_count() << " pinned threads"
+              << " (throughput is measured under interference)" << std::endl;
+    results = runner.run(jobs);
+    for (const Setting &setting: settings) report_setting(cfg, setting, results, dataset.size(), log);
+    report_stats();
+    return 0;
+}
 
-            if (numbers.size() < 2) {
-                numbers[0] = (rand() % 32767) + 1;
-            }
 
-            try {
-                uint32_t flow_id = numbers[0] + 1;
-                uint32_t ele_id = numbers[1] + 1;
+// The trace is read in chunks while the sketches update, so it may be larger than memory.
+// No ground truth is built, so only throughput and answer sizes are reported.
+static int stream_experiment(const ExperimentConfig &cfg, ResultLog &log) {
 
-                if (flow_id == 0 || ele_id == 0) continue;
+    for (float hh_th_ratio: cfg.phi_1) {
+        for (float ele_th_phi: cfg.phi_2) {
+            for (float memo_kb: cfg.memory_kb) {
 
-                data.emplace_back(flow_id, ele_id);
-                flow_true_count[flow_id]++;
-                flow_element_true_count[flow_id][ele_id]++;
+                print_setting(hh_th_ratio, ele_th_phi, memo_kb);
+                RunConfig config{0, ele_th_phi, cfg.batch_size};
 
-                total_data_num++;
-            } catch (const std::exception &e) {
-                std::cerr << "Skipping invalid line " << line_count << " in " << file_path << ": " << line << " ("
-                          << e.what() << ")" << std::endl;
-                continue;
+                for (const Algorithm *algorithm: cfg.algorithms) {
+                    std::vector<RunResult> runs;
+                    for (unsigned r = 0; r < cfg.repeat; ++r) {
+                        runs.push_back(algorithm->stream(memo_kb, cfg.files, cfg.format, hh_th_ratio, config, {}));
+                    }
+                    report_stream_run(runs[0]);
+                    report_repeats(runs);
+                    log.add(make_row("stream", cfg, hh_th_ratio, ele_th_phi, runs));
+                }
             }
         }
     }
-
-    std::cout << "All data is loaded, totaling data: " << total_data_num << std::endl;
-    std::cout << "Unique flows: " << flow_true_count.size() << std::endl;
-
-    return std::make_tuple(data, flow_true_count, flow_element_true_count);
+    return 0;
 }
 
 
-std::tuple<std::vector<std::pair<uint32_t, uint32_t>>,
-        std::map<uint32_t, uint32_t>,
-        std::map<uint32_t, std::map<uint32_t, uint32_t>>> loadSyntheticDataset() {
-
-    std::vector<std::string> file_paths = {
-            "./dataset/SyntheticDataset/skewed_dataset_zipf01.txt"
-    };
-
-    std::vector<std::pair<uint32_t, uint32_t>> data;
-    std::map<uint32_t, uint32_t> flow_true_count;
-    std::map<uint32_t, std::map<uint32_t, uint32_t>> flow_element_true_count;
-
-    uint64_t total_data_num = 0;
-
-    for (const auto &file_path: file_paths) {
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << file_path << '\n';
-            continue;
-        }
-
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string key_str, ele_str;
-            if (!(iss >> key_str >> ele_str)) continue;
-
-            try {
-                uint32_t key_int = static_cast<uint32_t>(std::stoul(key_str)) + 1;
-                uint32_t ele_int = static_cast<uint32_t>(std::stoul(ele_str)) + 1;
-
-                if (key_int == 0 || ele_int == 0) continue;
-
-                data.emplace_back(key_int, ele_int);
-
-                flow_true_count[key_int]++;
-                flow_element_true_count[key_int][ele_int]++;
-
-                ++total_data_num;
-            }
-            catch (const std::exception &e) {
-                std::cerr << "Parse error in file " << file_path
-                          << " line: \"" << line << "\" — " << e.what() << '\n';
+// Reading, parsing, optional exact counting and the sketch updates run as concurrent stages;
+// per-stage and per-queue counters show which stage limits throughput.
+static int pipeline_experiment(const ExperimentConfig &cfg, ResultLog &log) {
+
+    PipelineConfig pipeline_config;
+    pipeline_config.exact_count = cfg.exact_count;
+    pipeline_config.report_interval_s = cfg.report_interval_s;
+    pipeline_config.use_io_uring = cfg.io_backend != IoBackend::Pread;
+
+    for (float hh_th_ratio: cfg.phi_1) {
+        for (float ele_th_phi: cfg.phi_2) {
+            for (float memo_kb: cfg.memory_kb) {
+
+                print_setting(hh_th_ratio, ele_th_phi, memo_kb);
+                RunConfig config{0, ele_th_phi, cfg.batch_size};
+                pipeline_config.phi_1 = hh_th_ratio;
+
+                for (const Algorithm *algorithm: cfg.algorithms) {
+                    std::vector<RunResult> runs;
+                    bool has_accuracy = false;
+                    AccuracyMetrics metrics{};
+                    for (unsigned r = 0; r < cfg.repeat; ++r) {
+                        PipelineResult result = algorithm->pipeline(memo_kb, cfg.files, cfg.format, config,
+                                                                    pipeline_config);
+                        if (r == 0) {
+                            if (pipeline_config.exact_count) {
+                                Evaluator evaluator(result.counts);
+                                uint32_t heavy_hitter_th = hh_th_ratio * result.counts.total;
+                                metrics = Evaluator::score(evaluator.truth(heavy_hitter_th, ele_th_phi),
+                                                           result.run.answer);
+                                has_accuracy = true;
+                                report_run(result.run, metrics);
+                            } else {
+                                report_stream_run(result.run);
+                            }
+                            print_pipeline_report(result.report);
+                        }
+                        runs.push_back(std::move(result.run));
+                    }
+                    report_repeats(runs);
+
+                    ResultRow row = make_row("pipeline", cfg, hh_th_ratio, ele_th_phi, runs);
+                    row.has_accuracy = has_accuracy;
+                    row.accuracy = metrics;
+                    log.add(std::move(row));
+                }
             }
         }
-        std::cout << file_path << " is loaded.\n";
     }
+    return 0;
+}
 
-    std::cout << file_paths.size() << " files data loaded.\n"
-              << "Totaling: " << total_data_num
-              << ", Unique flows: " << flow_true_count.size() << std::endl;
 
-    return std::make_tuple(data, flow_true_count, flow_element_true_count);
-}
+int main(int argc, char **argv) {
 
+    ExperimentConfig cfg;
+    std::string error;
+    if (!parse_experiment_args(argc, argv, cfg, error)) {
+        if (!error.empty()) std::cerr << error << "\n\n";
+        print_experiment_usage(argv[0]);
+        return error.empty() ? 0 : 1;
+    }
 
-int main() {
+    set_io_backend(cfg.io_backend);
+    set_trace_cache_enabled(cfg.use_cache);
+    set_trace_cache_verify(cfg.verify_cache);
+    set_loader_threads(cfg.threads);
+    if (cfg.has_isa) set_sketch_isa(cfg.isa);
 
     std::cout << "Experiment starts ..." << std::endl;
+    print_sketch_dispatch(std::cout);
     auto start_time = std::chrono::steady_clock::now();
 
-    auto [dataset, flows, quadratic_eles] = loadDataSetCAIDA();
-//    auto [dataset, flows, quadratic_eles] = loadDataSetMAWI();
-//    auto [dataset, flows, quadratic_eles] = loadDatasetFreqItemMining();
-//    auto [dataset, flows, quadratic_eles] = loadSyntheticDataset();
-
-    std::vector<float> heavy_hitter_th_values = {0.0001}; // phi_1
-    std::vector<float> quad_ele_th_values = {0.1}; // phi_2
-    std::vector<uint32_t> memo_kb_values = {100, 200, 300, 400}; // memory in KB
-
-    for (float hh_th_ratio: heavy_hitter_th_values) {
-        for (float ele_th_phi: quad_ele_th_values) {
-            for (uint32_t memo_kb: memo_kb_values) {
+    ResultLog log;
+    log.environment = current_environment(argc, argv);
 
-                uint32_t heavy_hitter_th = hh_th_ratio * dataset.size();
-
-                std::cout << "\nHeavy hitter th = " << heavy_hitter_th
-                          << " (N*phi), phi_1 = " << hh_th_ratio
-                          << ", Quad element th (phi_2) = " << ele_th_phi
-                          << ", memo_kb = " << memo_kb
-                          << std::endl;
-
-                auto *dualSketch = new DualSketch(memo_kb);
-                dualSketch->evaluation(dataset, flows, quadratic_eles, heavy_hitter_th, ele_th_phi);
-                delete dualSketch;
-
-                auto *duet = new DUET(memo_kb);
-                duet->evaluation(dataset, flows, quadratic_eles, heavy_hitter_th, ele_th_phi);
-                delete duet;
-
-                auto *global_hh = new GlobalHH(memo_kb);
-                global_hh->evaluation(dataset, flows, quadratic_eles, heavy_hitter_th, ele_th_phi);
-                delete global_hh;
-
-                auto *twod_mg = new TwoDMisraGries(memo_kb);
-                twod_mg->evaluation(dataset, flows, quadratic_eles, heavy_hitter_th, ele_th_phi);
-                delete twod_mg;
-
-                auto *css_chh = new CSSCHH(memo_kb);
-                css_chh->evaluation(dataset, flows, quadratic_eles, heavy_hitter_th, ele_th_phi);
-                delete css_chh;
-
-            }
-        }
+    int status = 0;
+    switch (cfg.mode) {
+        case ExperimentMode::Batch: status = batch_experiment(cfg, log); break;
+        case ExperimentMode::Stream: status = stream_experiment(cfg, log); break;
+        case ExperimentMode::Pipeline: status = pipeline_experiment(cfg, log); break;
     }
 
+    if (!cfg.json_path.empty() && !log.write_json(cfg.json_path)) status = 1;
+    if (!cfg.csv_path.empty() && !log.write_csv(cfg.csv_path)) status = 1;
 
     auto end_time = std::chrono::steady_clock::now();
     auto elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time).count();
@@ -404,6 +317,5 @@ int main() {
               << elapsed_time / 3600 << "h " << (elapsed_time % 3600) / 60 << "m " << elapsed_time % 60 << "s"
               << std::endl;
 
-    return 0;
+    return status;
 }
-
@@ -0,0 +1,142 @@
+/*
+ * libdualsketch through its C interface: a sketch survives serialize -> deserialize with
+ * identical queries and updates, and truncated or malformed images are rejected.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dualsketch.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); ++failures; } } while (0)
+
+static uint32_t rng = 12345;
+static uint32_t next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* half the records on 5 heavy flows with 4 hot elements each, the rest spread out */
+static void make_records(dualsketch_record* records, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = next_random() % 1000;
+        records[i].flow = r < 500 ? 1 + r % 5 : 100 + next_random() % 100000;
+        records[i].element = r < 500 ? 1 + next_random() % 4 : 1 + next_random() % 50000;
+    }
+}
+
+static void put_u32(unsigned char* out, uint32_t value) {
+    for (int b = 0; b < 4; ++b) out[b] = (unsigned char) (value >> (8 * b));
+}
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/* both sketches answer the same query identically */
+static int same_answers(const dualsketch* a, const dualsketch* b) {
+    dualsketch_heavy_hitter ha[64], hb[64];
+    dualsketch_element ea[256], eb[256];
+    size_t nha, nea, nhb, neb;
+    int sa = dualsketch_query(a, 10000, 0.1f, ha, 64, &nha, ea, 256, &nea);
+    int sb = dualsketch_query(b, 10000, 0.1f, hb, 64, &nhb, eb, 256, &neb);
+    return sa == DUALSKETCH_OK && sb == DUALSKETCH_OK && nha > 0 && nha == nhb && nea == neb
+           && memcmp(ha, hb, nha * sizeof(ha[0])) == 0 && memcmp(ea, eb, nea * sizeof(ea[0])) == 0;
+}
+
+/* a header-only image of a sketch of 'memory_kb' claiming m1 buckets and m2 cells, tables zeroed */
+static unsigned char* forged_image(float memory_kb, uint32_t m1, uint32_t m2, size_t* size) {
+    *size = 4 * (8 + 5 * (size_t) m1 + 3 * (size_t) m2);
+    unsigned char* image = calloc(*size, 1);
+    memcpy(image, "DSK1", 4);
+    uint32_t header[] = {1, float_bits(memory_kb), 32, 171273612, 2, m1, m2};
+    for (int w = 0; w < 7; ++w) put_u32(image + 4 + 4 * w, header[w]);
+    return image;
+}
+
+int main(void) {
+    const size_t n = 1000000;
+    dualsketch_record* records = malloc(2 * n * sizeof(*records));
+    make_records(records, 2 * n);
+
+    CHECK(dualsketch_create(0.001f) == NULL);
+    CHECK(dualsketch_create(0.02f) == NULL);
+
+    dualsketch* sketch = dualsketch_create(100);
+    CHECK(sketch != NULL);
+    if (sketch == NULL) return 1;
+    dualsketch_update(sketch, records, n);
+
+    /* round trip */
+    size_t size = dualsketch_serialized_size(sketch), written = 0;
+    unsigned char* image = malloc(size + 4);
+    CHECK(dualsketch_serialize(sketch, image, size - 1, &written) == DUALSKETCH_BUFFER_TOO_SMALL && written == size);
+    CHECK(dualsketch_serialize(sketch, image, size, &written) == DUALSKETCH_OK && written == size);
+    dualsketch* copy = dualsketch_deserialize(image, size);
+    CHECK(copy != NULL);
+    if (copy == NULL) return 1;
+    CHECK(same_answers(sketch, copy));
+
+    unsigned char* again = malloc(size);
+    CHECK(dualsketch_serialize(copy, again, size, &written) == DUALSKETCH_OK && memcmp(image, again, size) == 0);
+
+    /* the copy keeps counting like the original */
+    dualsketch_update(sketch, records + n, n);
+    dualsketch_update(copy, records + n, n);
+    CHECK(same_answers(sketch, copy));
+
+    /* truncated or padded images */
+    size_t lengths[] = {0, 4, 31, 32, 33, size / 2, size - 4, size - 1};
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        CHECK(dualsketch_deserialize(image, lengths[l]) == NULL);
+    }
+    put_u32(image + size, 0);
+    CHECK(dualsketch_deserialize(image, size + 4) == NULL);
+    CHECK(dualsketch_deserialize(NULL, size) == NULL);
+
+    /* malformed headers: magic, version, memory_kb, k, seed, method, m1, m2 */
+    struct { size_t offset; uint32_t value; } corruptions[] = {
+        {0, 0x314b5344 ^ 1}, {4, 2}, {8, float_bits(200)}, {8, float_bits(100.5f)}, {8, 0x7fc00000},
+        {8, float_bits(-100)}, {12, 16}, {16, 1}, {20, 0}, {24, 0}, {28, 0},
+    };
+    for (size_t c = 0; c < sizeof(corruptions) / sizeof(corruptions[0]); ++c) {
+        unsigned char* bad = malloc(size);
+        memcpy(bad, image, size);
+        put_u32(bad + corruptions[c].offset, corruptions[c].value);
+        dualsketch* parsed = dualsketch_deserialize(bad, size);
+        if (parsed != NULL) printf("header word at %zu = 0x%x accepted\n", corruptions[c].offset, corruptions[c].value);
+        CHECK(parsed == NULL);
+        dualsketch_destroy(parsed);
+        free(bad);
+    }
+
+    /* consistent images of sketches too small to update: no buckets, or fewer cells than a window */
+    float small_kb[] = {0.001f, 0.02f, 0.5f};
+    uint32_t small_m1[] = {0, 1, 14};
+    uint32_t small_m2[] = {0, 1, 19};
+    for (int s = 0; s < 3; ++s) {
+        size_t forged_size = 0;
+        unsigned char* forged = forged_image(small_kb[s], small_m1[s], small_m2[s], &forged_size);
+        dualsketch* parsed = dualsketch_deserialize(forged, forged_size);
+        if (parsed != NULL) {
+            printf("image of a %g KB sketch accepted\n", small_kb[s]);
+            dualsketch_destroy(parsed);
+        }
+        CHECK(parsed == NULL);
+        free(forged);
+    }
+
+    dualsketch_destroy(sketch);
+    dualsketch_destroy(copy);
+    free(records);
+    free(image);
+    free(again);
+
+    if (failures == 0) printf("dualsketch C interface: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "dualsketch.h"
+
+
+// libdualsketch reports a failed allocation as DUALSKETCH_OUT_OF_MEMORY, not as a bad argument,
+// and a merge that runs out of memory leaves its target unchanged. Allocations fail on demand
+// through a replaced global operator new.
+
+static bool fail_allocations = false;
+
+void* operator new(std::size_t size) {
+    if (fail_allocations) throw std::bad_alloc();
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+static std::vector<uint8_t> image(const dualsketch* sketch) {
+    std::vector<uint8_t> bytes(dualsketch_serialized_size(sketch));
+    size_t written = 0;
+    dualsketch_serialize(sketch, bytes.data(), bytes.size(), &written);
+    return bytes;
+}
+
+
+int main() {
+    dualsketch* into = dualsketch_create(64);
+    dualsketch* from = dualsketch_create(64);
+    check(into != nullptr && from != nullptr, "sketches created");
+
+    std::vector<dualsketch_record> records;
+    for (uint32_t i = 0; i < 100000; ++i) records.push_back({1 + i % 97 * (i % 13), 1 + i % 31});
+    dualsketch_update(into, records.data(), records.size() / 2);
+    dualsketch_update(from, records.data() + records.size() / 2, records.size() - records.size() / 2);
+    std::vector<uint8_t> before = image(into);
+
+    dualsketch_heavy_hitter hitters[64];
+    dualsketch_element elements[256];
+    size_t hitter_count = 0, element_count = 0;
+
+    fail_allocations = true;
+    int merged = dualsketch_merge(into, from);
+    int queried = dualsketch_query(into, 100, 0.1f, hitters, 64, &hitter_count, elements, 256, &element_count);
+    fail_allocations = false;
+
+    check(merged == DUALSKETCH_OUT_OF_MEMORY, "merge without memory: DUALSKETCH_OUT_OF_MEMORY");
+    check(queried == DUALSKETCH_OUT_OF_MEMORY, "query without memory: DUALSKETCH_OUT_OF_MEMORY");
+    check(image(into) == before, "a failed merge leaves the sketch unchanged");
+    check(dualsketch_merge(into, from) == DUALSKETCH_OK, "merge with memory succeeds");
+    check(dualsketch_query(into, 100, 0.1f, hitters, 64, &hitter_count, elements, 256, &element_count)
+          != DUALSKETCH_OUT_OF_MEMORY, "query with memory succeeds");
+
+    dualsketch_destroy(into);
+    dualsketch_destroy(from);
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "dualsketch_oom: all checks passed" << std::endl;
+    return 0;
+}
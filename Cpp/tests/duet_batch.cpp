@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "header/DUET.h"
+
+
+// DUET::update_batch counts each group's flows in CountMin ahead of the filter and table.
+// It must leave the sketch as sequential update() calls do, also when a flow repeats within
+// a group and crosses the heavy-hitter threshold there.
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+int main() {
+    // 60 flows, the first few far above the threshold (1000), in runs that repeat a flow
+    // many times within one 64-record group
+    std::mt19937 rng(5);
+    std::vector<Record> records;
+    while (records.size() < 300000) {
+        uint32_t flow = 1 + static_cast<uint32_t>(rng() % 60 * (rng() % 60) / 60);
+        uint32_t run = 1 + rng() % 40;
+        for (uint32_t r = 0; r < run; ++r) records.push_back({flow, 1 + rng() % (flow < 5 ? 500 : 30)});
+    }
+
+    for (float memory_kb: {8.0f, 64.0f}) {
+        std::string where = "memory " + std::to_string(static_cast<int>(memory_kb)) + " KB";
+        DUET sequential(memory_kb);
+        DUET batched = sequential;  // same seeds, both empty
+
+        for (const auto& record: records) sequential.update(record.first, record.second);
+        // batches of uneven sizes, so groups start anywhere in the runs
+        for (size_t begin = 0; begin < records.size();) {
+            size_t n = std::min<size_t>(records.size() - begin, 1 + rng() % 300);
+            batched.update_batch(records.data() + begin, n);
+            begin += n;
+        }
+
+        auto expected = sequential.query(1000, 0.01f);
+        auto result = batched.query(1000, 0.01f);
+        check(!expected.first.empty(), where + ": the stream has heavy hitters");
+        check(result.first == expected.first, where + ": same heavy hitters");
+        check(result.second == expected.second, where + ": same hot quadratic elements");
+        check(batched.query_combined(1, 0.0f) == sequential.query_combined(1, 0.0f), where + ": same table contents");
+    }
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "duet_batch: all checks passed" << std::endl;
+    return 0;
+}
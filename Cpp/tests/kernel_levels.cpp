@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "header/CountMin.h"
+#include "header/DualSketch.h"
+#include "header/SketchKernels.h"
+
+
+// Every supported kernel level gives the same results as baseline: the kernels on random
+// inputs, and whole DualSketch and CountMin runs (the sketches with fixed seeds).
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+struct SketchOutputs {
+    std::vector<std::vector<uint8_t>> images;  // DualSketch image per window size
+    std::vector<std::pair<std::map<uint32_t, uint32_t>,
+            std::map<uint32_t, std::map<uint32_t, uint32_t>>>> heavy_hitters;  // query() per window size
+    std::vector<uint32_t> estimates;           // CountMin
+};
+
+
+// Skewed records over few flows, so windows fill up and flows steal and clear cells
+static std::vector<Record> workload() {
+    std::mt19937 rng(7);
+    std::vector<Record> records;
+    for (int i = 0; i < 200000; ++i) {
+        uint32_t flow = 1 + static_cast<uint32_t>(std::sqrt(static_cast<double>(rng() % 250000)));
+        uint32_t element = 1 + rng() % (flow < 40 ? 2000 : 20);
+        records.push_back({flow, element});
+    }
+    return records;
+}
+
+
+static SketchOutputs run_sketches(const std::vector<Record>& records) {
+    SketchOutputs out;
+    for (uint32_t window: {4u, 13u, 32u, 64u}) {
+        DualSketch sketch(16, window);
+        DualSketch batched(16, window);
+        size_t half = records.size() / 2;
+        for (size_t i = 0; i < half; ++i) sketch.update(records[i].first, records[i].second);
+        for (size_t i = 0; i < half; ++i) batched.update(records[i].first, records[i].second);
+        sketch.update_batch(records.data() + half, records.size() - half);
+        for (size_t i = half; i < records.size(); ++i) batched.update(records[i].first, records[i].second);
+
+        std::vector<uint8_t> image(sketch.serialized_size()), other(batched.serialized_size());
+        sketch.serialize(image.data());
+        batched.serialize(other.data());
+        check(image == other, "update_batch and update agree, window " + std::to_string(window));
+        out.images.push_back(image);
+
+        out.heavy_hitters.push_back(sketch.query(50, 0.01f));
+    }
+
+    CountMin countmin(8);
+    std::vector<uint32_t> keys;
+    for (const auto& record: records) keys.push_back(record.first * 2654435761u);
+    out.estimates.resize(keys.size());
+    countmin.query_update_batch(keys.data(), keys.size() / 2, out.estimates.data());
+    for (size_t i = keys.size() / 2; i < keys.size(); ++i) out.estimates[i] = countmin.query_update(keys[i]);
+    for (uint32_t key = 1; key < 1000; ++key) out.estimates.push_back(countmin.query(key * 2654435761u));
+    return out;
+}
+
+
+static void compare_kernels(const SketchKernels& base, const SketchKernels& level) {
+    std::string name = isa_name(level.isa);
+    std::mt19937 rng(11);
+
+    std::vector<uint32_t> keys(1000), hashes(keys.size()), other(keys.size());
+    for (auto& key: keys) key = rng();
+    for (size_t n: {size_t(1), size_t(7), size_t(8), size_t(17), keys.size()}) {
+        base.hash_u32(keys.data(), n, 42, hashes.data());
+        level.hash_u32(keys.data(), n, 42, other.data());
+        check(std::equal(hashes.begin(), hashes.begin() + n, other.begin()), name + " hash_u32 n=" + std::to_string(n));
+    }
+
+    for (uint32_t n: {1u, 5u, 8u, 16u, 23u, 64u}) {
+        for (int round = 0; round < 200; ++round) {
+            // small value ranges, so matches, ties and empty entries are common
+            std::vector<uint64_t> row(n);
+            std::vector<uint32_t> vals(n);
+            for (auto& key: row) key = rng() % 6;
+            for (auto& val: vals) val = rng() % 4;
+            uint64_t key = rng() % 6;
+            uint32_t empty_a = 0, empty_b = 0;
+            int64_t found_a = base.probe_row_u64(row.data(), n, key, empty_a);
+            int64_t found_b = level.probe_row_u64(row.data(), n, key, empty_b);
+            check(found_a == found_b && (found_a >= 0 || empty_a == empty_b), name + " probe_row_u64");
+            check(base.argmin_u32(vals.data(), n) == level.argmin_u32(vals.data(), n), name + " argmin_u32");
+
+            // {E, R, P} cells with few distinct values; empty cells are zero, but E == 0 with
+            // P != 0 (an update with element 0) also occurs
+            std::vector<uint32_t> cells(3 * n);
+            for (uint32_t j = 0; j < n; ++j) {
+                uint32_t e = rng() % 4, r = rng() % 5, p = rng() % 3;
+                if (round % 2 == 0 && e == 0) r = p = 0;
+                if (round % 7 == 0) r = UINT32_MAX - rng() % 2;
+                cells[3 * j] = e, cells[3 * j + 1] = r, cells[3 * j + 2] = p;
+            }
+            uint32_t x = rng() % 3, y = rng() % 4;
+            uint32_t first_empty_a = 0, first_empty_b = 0, min_a = 0, min_b = 0;
+            int64_t hit_a = base.qt_window_scan(cells.data(), n, x, y, first_empty_a, min_a);
+            int64_t hit_b = level.qt_window_scan(cells.data(), n, x, y, first_empty_b, min_b);
+            check(hit_a == hit_b && first_empty_a == first_empty_b && (hit_a >= 0 || min_a == min_b),
+                  name + " qt_window_scan n=" + std::to_string(n));
+            check(base.qt_window_find(cells.data(), n, x) == level.qt_window_find(cells.data(), n, x),
+                  name + " qt_window_find");
+            std::vector<uint32_t> cleared = cells;
+            uint32_t count_a = base.qt_window_clear(cells.data(), n, x);
+            uint32_t count_b = level.qt_window_clear(cleared.data(), n, x);
+            check(count_a == count_b && cells == cleared, name + " qt_window_clear");
+        }
+    }
+
+    for (int round = 0; round < 2000; ++round) {
+        uint32_t keys_a[8] = {}, freqs_a[8] = {}, keys_b[8] = {}, freqs_b[8] = {};
+        uint32_t size_a = 0, size_b = 0;
+        for (int step = 0; step < 40; ++step) {
+            uint32_t key = 1 + rng() % 12;
+            size_a = base.misra_gries_u32x8(keys_a, freqs_a, size_a, key);
+            size_b = level.misra_gries_u32x8(keys_b, freqs_b, size_b, key);
+        }
+        check(size_a == size_b && std::equal(keys_a, keys_a + size_a, keys_b)
+              && std::equal(freqs_a, freqs_a + size_a, freqs_b), name + " misra_gries_u32x8");
+    }
+}
+
+
+int main() {
+    std::vector<Record> records = workload();
+
+    check(set_sketch_isa(Isa::Baseline), "baseline is always supported");
+    const SketchKernels& base = sketch_kernels();
+    SketchOutputs expected = run_sketches(records);
+
+    for (Isa isa: {Isa::Avx2, Isa::Avx512}) {
+        if (!set_sketch_isa(isa)) {
+            std::cout << isa_name(isa) << ": not supported here, skipped" << std::endl;
+            continue;
+        }
+        const SketchKernels& level = sketch_kernels();
+        check(level.isa == isa, std::string("set_sketch_isa(") + isa_name(isa) + ")");
+        compare_kernels(base, level);
+
+        SketchOutputs outputs = run_sketches(records);
+        for (size_t i = 0; i < expected.images.size(); ++i) {
+            check(outputs.images[i] == expected.images[i], std::string(isa_name(isa)) + " DualSketch tables, case " + std::to_string(i));
+            check(outputs.heavy_hitters[i] == expected.heavy_hitters[i], std::string(isa_name(isa)) + " DualSketch query, case " + std::to_string(i));
+        }
+        check(outputs.estimates == expected.estimates, std::string(isa_name(isa)) + " CountMin estimates");
+    }
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "kernel_levels: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "header/ExperimentConfig.h"
+#include "header/KeySpec.h"
+#include "header/Loaders.h"
+
+
+// Key specs: protocol names in filters match in any case, like the protocol column of the
+// data they filter, and --key is rejected wherever it would have no effect.
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+static bool parse_args(std::vector<const char*> args, std::string& error) {
+    args.insert(args.begin(), "HH_QuadraticEle");
+    ExperimentConfig config;
+    return parse_experiment_args(static_cast<int>(args.size()), const_cast<char**>(args.data()), config, error);
+}
+
+
+int main() {
+    for (const char* text: {"protocol == TCP", "protocol==tcp", "protocol = Tcp", "protocol==6"}) {
+        KeySpec spec;
+        std::string error;
+        bool ok = parse_key_spec(std::string("flow=src_ip;element=dst_port;") + text, spec, &error);
+        check(ok && spec.filters.size() == 1 && spec.filters[0].operand == 6, std::string("filter ") + text + " " + error);
+    }
+    KeySpec spec;
+    check(parse_key_spec("flow=src_ip;element=dst_ip;protocol!=ICMPv6", spec) && spec.filters[0].operand == 58,
+          "filter protocol!=ICMPv6");
+    check(!parse_key_spec("flow=src_ip;element=dst_ip;protocol==sctp", spec), "unknown protocol name rejected");
+
+    // the filter and the CSV column agree, whatever the case of either
+    const std::string csv = "/tmp/hh_key_spec_test_" + std::to_string(getpid()) + ".csv";
+    std::ofstream(csv) << "src_ip,dst_ip,protocol,src_port,dst_port\n"
+                       << "1.1.1.1,2.2.2.2,TCP,1000,80\n"
+                       << "1.1.1.1,2.2.2.3,tcp,1001,443\n"
+                       << "1.1.1.1,2.2.2.4,UDP,1002,53\n"
+                       << "1.1.1.1,2.2.2.5,OTHER,1003,9\n"
+                       // ports beyond 64 bits are dropped, not wrapped to 80
+                       << "1.1.1.1,2.2.2.6,TCP,1004,0x10000000000000050\n"
+                       << "1.1.1.1,2.2.2.7,TCP,1005,18446744073709551696\n"
+                       << "1.1.1.1,2.2.2.8,TCP,1006,0x0000000000000016\n";
+    check(parse_key_spec("flow=src_ip;element=dst_port;protocol == TCP", spec), "MAWI spec");
+    auto [records, counts] = loadDataSet({csv}, TraceFormat::MAWI, spec);
+    check(records.size() == 3 && records[0].second == 80 && records[1].second == 443, "protocol == TCP keeps the TCP rows");
+    check(records.size() == 3 && records[2].second == 22, "16 hex digits parse, 17 and 2^64 + 80 are rejected");
+    std::remove(csv.c_str());
+
+    // --key where it has no effect
+    std::string error;
+    check(parse_args({"--format", "mawi", "--key", "flow=src_ip;element=dst_port", "x.csv"}, error), "mawi --key " + error);
+    check(parse_args({"--format", "pcap", "--key", "flow=src_ip;element=dst_port", "x.pcap"}, error), "pcap --key " + error);
+    for (const char* format: {"caida", "fimi", "synthetic", "bin"}) {
+        check(!parse_args({"--format", format, "--key", "flow=src_ip;element=dst_port", "x"}, error) && !error.empty(),
+              std::string("--key rejected for ") + format);
+    }
+    for (const char* mode: {"--stream", "--pipeline"}) {
+        check(!parse_args({mode, "--format", "mawi", "--key", "flow=src_ip;element=dst_port", "x.csv"}, error)
+              && !error.empty(), std::string("--key rejected with ") + mode);
+    }
+    std::tie(records, counts) = loadDataSet({"x.txt"}, TraceFormat::CAIDA, spec);
+    check(records.empty(), "loadDataSet with a key spec rejects caida");
+
+    if (failures == 0) std::cout << "key specs: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
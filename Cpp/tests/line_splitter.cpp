@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include "header/BlockReader.h"
+
+
+// LineSplitter hands out whole lines only: a line longer than the headroom is dropped
+// whole, and none of its remainder in the following blocks reaches the parser.
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+static void split_file(const std::string& path, const std::string& text, bool use_io_uring, bool skip_header) {
+    std::string where = std::string(use_io_uring ? "io_uring" : "pread") + (skip_header ? ", header" : "");
+
+    // every line by its offset; the first one is the header when skip_header is set
+    std::map<uint64_t, std::string> lines;
+    for (size_t begin = 0; begin < text.size();) {
+        size_t nl = text.find('\n', begin);
+        size_t end = nl == std::string::npos ? text.size() : nl;
+        lines[begin] = text.substr(begin, end - begin);
+        begin = end + 1;
+    }
+
+    BlockReaderConfig config;
+    config.block_bytes = 4096;
+    config.headroom = 512;
+    config.use_io_uring = use_io_uring;
+    BlockReader reader(config);
+    reader.open({path});
+    LineSplitter splitter(reader, config.headroom, skip_header);
+
+    size_t seen = 0;
+    bool whole = true;
+    LinePiece piece;
+    while (splitter.next(piece)) {
+        for (const char* p = piece.begin; p < piece.end;) {
+            const char* nl = p;
+            while (nl < piece.end && *nl != '\n') ++nl;
+            uint64_t offset = piece.offset + static_cast<uint64_t>(p - piece.begin);
+            auto line = lines.find(offset);
+            if (line == lines.end() || line->second != std::string(p, nl) || (skip_header && offset == 0)) {
+                std::cout << where << ": unexpected line at offset " << offset << ": "
+                          << std::string(p, nl).substr(0, 40) << std::endl;
+                whole = false;
+            }
+            ++seen;
+            p = nl + 1;
+        }
+        reader.release(piece.block);
+    }
+    check(whole, where + ": only whole lines of the file, at their offsets");
+    check(splitter.dropped_lines() >= 2, where + ": the lines longer than the headroom are dropped");
+    check(seen + splitter.dropped_lines() + (skip_header ? 1 : 0) == lines.size(),
+          where + ": every other line is handed out");
+}
+
+
+int main() {
+    const std::string path = "/tmp/hh_line_splitter_test_" + std::to_string(getpid()) + ".txt";
+
+    // short lines around two long ones: one of several blocks, and one of 1000 bytes that
+    // starts 700 bytes before a block boundary, so its 700-byte carry exceeds the headroom
+    std::string text = "src dst\n";
+    for (int i = 0; text.size() < 5000; ++i) text += std::to_string(i) + " " + std::to_string(i * 7) + "\n";
+    text += std::string(10000, 'x') + " 1\n";
+    while (text.size() % 4096 != 4096 - 700) text += "9\n";
+    text += "y" + std::string(998, '5') + "\n";
+    for (int i = 0; i < 2000; ++i) text += std::to_string(i) + " 1\n";
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+
+    for (bool use_io_uring: {true, false}) {
+        for (bool skip_header: {false, true}) split_file(path, text, use_io_uring, skip_header);
+    }
+    std::remove(path.c_str());
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "line_splitter: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "header/MurmurHash3.h"
+#include "header/SketchKernels.h"
+
+
+// MurmurHash3_x86_32_keys equals MurmurHash3_x86_32 on every supported level: the default
+// seeds, a few million sampled keys, and every batch length up to 64 at several offsets.
+// HH_VerifyHash does the same for all 2^32 keys.
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+// Every length in [0, 64] at offsets 0..15, with guard words before and after the batch
+static bool tails_match(uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<uint32_t> keys(80), expected(80), out(80);
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t n = 0; n <= 64; ++n) {
+            for (uint32_t& key: keys) key = gen();
+            for (size_t i = 0; i < n; ++i) MurmurHash3_x86_32(&keys[offset + i], 4, seed, &expected[i]);
+            std::fill(out.begin(), out.end(), 0xDEADBEEF);
+            MurmurHash3_x86_32_keys(keys.data() + offset, n, seed, out.data() + offset);
+            bool guards = out[offset + n] == 0xDEADBEEF && (offset == 0 || out[offset - 1] == 0xDEADBEEF);
+            if (!guards || std::memcmp(out.data() + offset, expected.data(), 4 * n) != 0) return false;
+        }
+    }
+    return true;
+}
+
+
+// The lowest and highest 2^20 keys, and 2^21 random ones
+static bool sample_matches(uint32_t seed) {
+    constexpr size_t block = 1 << 20;
+    std::vector<uint32_t> keys(block), expected(block), out(block);
+    std::mt19937 gen(seed ^ 0x5bd1e995u);
+    for (int part = 0; part < 4; ++part) {
+        for (size_t i = 0; i < block; ++i) {
+            if (part == 0) keys[i] = static_cast<uint32_t>(i);
+            else if (part == 1) keys[i] = static_cast<uint32_t>(UINT32_MAX - i);
+            else keys[i] = gen();
+        }
+        for (size_t i = 0; i < block; ++i) MurmurHash3_x86_32(&keys[i], 4, seed, &expected[i]);
+        MurmurHash3_x86_32_keys(keys.data(), block, seed, out.data());
+        if (out != expected) return false;
+    }
+    return true;
+}
+
+
+int main() {
+    for (Isa isa: {Isa::Baseline, Isa::Avx2, Isa::Avx512}) {
+        if (!set_sketch_isa(isa)) {
+            std::cout << isa_name(isa) << ": not supported here, skipped" << std::endl;
+            continue;
+        }
+        // CountMin row 0 and DualSketch's seed, as in HH_VerifyHash
+        for (uint32_t seed: {0u, 171273612u}) {
+            std::string where = std::string(isa_name(isa)) + ", seed " + std::to_string(seed);
+            check(tails_match(seed), where + ": every batch length and offset");
+            check(sample_matches(seed), where + ": sampled keys");
+        }
+    }
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "murmur_keys: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "header/Loaders.h"
+#include "header/TraceFile.h"
+#include "header/ZipfGenerator.h"
+
+
+// A Zipf stream loads as the same records from a binary trace (HH_GenZipf --output) and from
+// a text file of its ranks (genSyntheticDataset.py): the keys are the ranks in both.
+
+static int failures = 0;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+int main() {
+    const std::string base = "/tmp/hh_synthetic_keys_test_" + std::to_string(getpid());
+    const std::string text_path = base + ".txt";
+    const std::string trace_path = base + ".bin";
+
+    ZipfConfig config;
+    config.records = 20000;
+    config.max_flow = 5000;
+    config.max_element = 300;
+    std::vector<Record> stream = ZipfGenerator(config).generate(2);
+
+    // as np.savetxt(fmt='%u', delimiter=' ') writes them
+    {
+        std::ofstream text(text_path, std::ios::binary | std::ios::trunc);
+        for (const auto& record: stream) text << record.first << ' ' << record.second << '\n';
+    }
+    TraceWriter writer;
+    check(writer.open(trace_path, stream.size()) && writer.append(stream.data(), stream.size()) && writer.close(),
+          "binary trace written");
+
+    set_trace_cache_enabled(false);
+    auto binary = std::get<0>(loadDataSet({trace_path}, TraceFormat::Binary));
+    auto text = std::get<0>(loadDataSet({text_path}, TraceFormat::Synthetic));
+    check(binary == stream, "binary load gives the generated records");
+    check(text == binary, "text and binary loads give the same records");
+
+    for (IoBackend backend: {IoBackend::Mmap, IoBackend::IoUring, IoBackend::Pread}) {
+        std::vector<Record> records;
+        uint64_t skipped = 0;
+        check(parse_trace_files({text_path}, TraceFormat::Synthetic, backend, records, skipped)
+              && skipped == 0 && records == binary, "text parse through every I/O backend");
+    }
+
+    std::remove(text_path.c_str());
+    std::remove(trace_path.c_str());
+
+    if (failures != 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "synthetic_keys: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "header/Loaders.h"
+#include "header/TraceFile.h"
+
+
+// The <file>.bin cache is used only for the format and parser version it was written by,
+// and with set_trace_cache_verify() only while the source's checksum matches.
+
+static int failures = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+static void write_text(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+}
+
+
+// Rewrites bytes of the cache header at 'offset'
+static void patch_cache(const std::string& path, size_t offset, const void* value, size_t size) {
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    std::fwrite(value, 1, size, file);
+    std::fclose(file);
+}
+
+
+int main() {
+    const std::string source = "/tmp/hh_trace_cache_test_" + std::to_string(getpid()) + ".txt";
+    const std::string cache = trace_cache_path(source);
+    write_text(source, "10 20\n30 40\n50 60\n");
+
+    set_trace_cache_enabled(true);
+    set_trace_cache_verify(false);
+    auto [records, counts] = loadDataSet({source}, TraceFormat::Synthetic);
+    check(records.size() == 3, "three records loaded");
+
+    check(trace_cache_current(source, TraceFormat::Synthetic), "cache used by the format that wrote it");
+    check(!trace_cache_current(source, TraceFormat::FIMI), "cache not used by another format");
+    check(!trace_cache_current(source, TraceFormat::CAIDA), "cache not used by another format");
+
+    TraceHeader header{};
+    check(read_trace_header(cache, header), "cache header readable");
+    check(header.source_format == trace_format_id(TraceFormat::Synthetic)
+          && header.parser_version == trace_parser_version(TraceFormat::Synthetic), "cache records format and parser");
+
+    // another parser version, then a cache of before format ids (source_format 0)
+    uint32_t other_version = header.parser_version + 1;
+    patch_cache(cache, offsetof(TraceHeader, parser_version), &other_version, sizeof(other_version));
+    check(!trace_cache_current(source, TraceFormat::Synthetic), "cache of another parser version not used");
+    patch_cache(cache, offsetof(TraceHeader, parser_version), &header.parser_version, sizeof(header.parser_version));
+    uint16_t no_format = 0;
+    patch_cache(cache, offsetof(TraceHeader, source_format), &no_format, sizeof(no_format));
+    check(!trace_cache_current(source, TraceFormat::Synthetic), "cache without a format not used");
+
+    // a source changed in place with its size and mtime kept: only the checksum tells
+    std::tie(records, counts) = loadDataSet({source}, TraceFormat::Synthetic);
+    struct stat before{};
+    stat(source.c_str(), &before);
+    write_text(source, "10 20\n30 40\n50 61\n");
+    struct timespec times[2] = {before.st_atim, before.st_mtim};
+    utimensat(AT_FDCWD, source.c_str(), times, 0);
+    check(trace_cache_current(source, TraceFormat::Synthetic), "size and mtime alone accept the cache");
+    set_trace_cache_verify(true);
+    check(!trace_cache_current(source, TraceFormat::Synthetic), "checksum rejects the cache");
+    std::tie(records, counts) = loadDataSet({source}, TraceFormat::Synthetic);
+    check(records.size() == 3 && records[2].second == 61, "changed source parsed again");
+    check(trace_cache_current(source, TraceFormat::Synthetic), "rewritten cache verified");
+
+    // a record_count whose file size wraps around 2^64 to the real one (64 + 3 * 8 bytes)
+    TraceHeader written{};
+    check(read_trace_header(cache, written) && written.record_count == 3 && written.columns == 0, "3-record cache");
+    const uint64_t wrapping_counts[] = {3 + (1ull << 61), 2 + (1ull << 62)};
+    const uint32_t wrapping_columns[] = {0, TRACE_COL_WEIGHT};  // 8 and 12 bytes per record
+    for (int i = 0; i < 2; ++i) {
+        patch_cache(cache, offsetof(TraceHeader, record_count), &wrapping_counts[i], sizeof(uint64_t));
+        patch_cache(cache, offsetof(TraceHeader, columns), &wrapping_columns[i], sizeof(uint32_t));
+        TraceHeader wrapped{};
+        std::vector<Record> mapped;
+        check(!read_trace_header(cache, wrapped), "header with a wrapping record count rejected");
+        check(!read_trace(cache, mapped) && mapped.empty(), "trace with a wrapping record count not read");
+        check(!trace_cache_current(source, TraceFormat::Synthetic), "cache with a wrapping record count not used");
+    }
+
+    std::remove(source.c_str());
+    std::remove(cache.c_str());
+
+    if (failures == 0) std::cout << "trace cache: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <string>
+#include "header/TwoDMisraGries.h"
+
+
+// 2D-MG's flow index with keys that differ only in their upper bits (IPv4 addresses in host
+// order, ports shifted into a high field): the counts stay exact while every flow fits, and
+// such keys spread over the index as well as keys that differ in their low bits.
+// HH_Bench --algorithms 2D-MG --flow-shift 12 times them.
+
+static int failures = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        std::cout << "check failed: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+// Exact counts: 1000 flows (below the 1422 slots of 100 KB) with 5 elements each
+static void check_exact(uint32_t shift) {
+    TwoDMisraGries sketch(100);
+    for (uint32_t round = 0; round < 20; ++round) {
+        for (uint32_t i = 0; i < 1000; ++i) {
+            for (uint32_t e = 1; e <= 5; ++e) sketch.update((i << shift) | 1, e);
+        }
+    }
+    auto [heavy_hitters, quad_elements] = sketch.query(1, 0);
+    bool exact = heavy_hitters.size() == 1000;
+    for (uint32_t i = 0; i < 1000 && exact; ++i) {
+        uint32_t x = (i << shift) | 1;
+        exact = heavy_hitters[x] == 100 && quad_elements[x].size() == 5;
+        for (uint32_t e = 1; e <= 5 && exact; ++e) exact = quad_elements[x][e] == 20;
+    }
+    check(exact, shift == 12 ? "exact counts, keys (i << 12) | 1" : "exact counts, keys (i << 20) | 1");
+}
+
+
+// Mean lookup length of 1000 flows (i << shift) | 1 in the index of a 100 KB sketch (4096
+// entries for 1422 slots). A well spread index needs about 1.1; keys that all shared one
+// probe chain would need about 500.
+static double mean_probes(uint32_t shift) {
+    TwoDMisraGries sketch(100);
+    for (uint32_t i = 0; i < 1000; ++i) sketch.update((i << shift) | 1, 1);
+    uint64_t probes = 0;
+    for (uint32_t i = 0; i < 1000; ++i) probes += sketch.index_probes((i << shift) | 1);
+    return probes / 1000.0;
+}
+
+
+int main() {
+    check_exact(12);
+    check_exact(20);
+
+    for (uint32_t shift: {0u, 12u, 20u, 22u}) {
+        double probes = mean_probes(shift);
+        std::string what = "keys (i << " + std::to_string(shift) + ") | 1 spread over the index (mean "
+                           + std::to_string(probes) + " probes)";
+        check(probes < 2.0, what.c_str());
+    }
+
+    if (failures == 0) std::cout << "2D-MG: all checks passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "header/Algorithms.h"
+#include "header/CSSCHH.h"
+#include "header/DUET.h"
+#include "header/DualSketch.h"
+#include "header/GlobalHH.h"
+#include "header/Loaders.h"
+#include "header/PerfCounters.h"
+#include "header/SketchKernels.h"
+#include "header/TwoDMisraGries.h"
+#include "header/ZipfGenerator.h"
+
+
+// Per-algorithm microbenchmarks: per-record update(), update_batch() for every batch size,
+// and query() for every phi_1, at every memory size and, for DualSketch, every QT window
+// size k (--window). Each case runs 'warmup' untimed times,
+// then 'repeat' timed times on a fresh sketch (constructed outside the timed region), and
+// reports the median, mean, relative standard deviation and minimum time per operation,
+// with the median hardware counter values per operation (header/PerfCounters.h).
+//
+// usage: HH_Bench [--records N] [--seed S] [--algorithms LIST] [--memory LIST] [--window LIST]
+//                 [--batch LIST] [--phi1 LIST] [--phi2 F] [--repeat N] [--warmup N] [--no-counters]
+//                 [--flow-shift S] [--isa LEVEL] [--format F file ...]
+//
+// Without files the dataset is a Zipf stream (header/ZipfGenerator.h) of --records records.
+// --flow-shift S turns each flow key x into (x << S) | 1, keys that differ only in their
+// upper bits (like IPv4 addresses in host order), to time hash indexes on such keys.
+
+static void usage() {
+    std::cerr << "usage: HH_Bench [--records N] [--seed S] [--algorithms LIST] [--memory LIST] [--window LIST]\n"
+              << "                [--batch LIST] [--phi1 LIST] [--phi2 F] [--repeat N] [--warmup N] [--no-counters]\n"
+              << "                [--flow-shift S] [--isa baseline|avx2|avx512] [--format caida|mawi|fimi|synthetic|pcap|bin file ...]"
+              << std::endl;
+}
+
+
+struct BenchOptions {
+    uint64_t records = 1 << 22;
+    uint64_t seed = 1;
+    std::vector<std::string> algorithms;   // empty: all
+    std::vector<float> memory_kb = {100, 400};
+    std::vector<uint32_t> windows = {DualSketch::DEFAULT_WINDOW};   // DualSketch's k
+    std::vector<size_t> batch_sizes = {64, 1024};
+    std::vector<float> phi_1 = {0.0001};
+    float phi_2 = 0.1;
+    unsigned repeat = 10;
+    unsigned warmup = 1;
+    bool counters = true;
+    uint32_t flow_shift = 0;
+    TraceFormat format = TraceFormat::CAIDA;
+    std::vector<std::string> files;
+};
+
+
+// One timed run: the case calls start() and stop() around the work it measures.
+class Probe {
+private:
+    PerfCounters* counters;
+    std::chrono::steady_clock::time_point begin;
+
+public:
+    double seconds = 0;
+    PerfSample sample;
+
+    explicit Probe(PerfCounters* counters) : counters(counters) {}
+
+    void start() {
+        if (counters) counters->start();
+        begin = std::chrono::steady_clock::now();
+    }
+
+    void stop() {
+        auto end = std::chrono::steady_clock::now();
+        if (counters) sample = counters->stop();
+        seconds = std::chrono::duration<double>(end - begin).count();
+    }
+};
+
+
+struct CaseResult {
+    double median_ns;
+    double mean_ns;
+    double rsd;       // standard deviation / mean
+    double min_ns;
+    PerfSample per_op;
+};
+
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+
+// Runs 'body(probe)' warmup + repeat times; 'ops' operations happen between start() and stop().
+template <typename Body>
+static CaseResult measure(const BenchOptions& options, PerfCounters* counters, uint64_t ops, Body body) {
+    for (unsigned i = 0; i < options.warmup; ++i) {
+        Probe probe(nullptr);
+        body(probe);
+    }
+
+    std::vector<double> ns;
+    std::vector<PerfSample> samples;
+    for (unsigned i = 0; i < options.repeat; ++i) {
+        Probe probe(counters);
+        body(probe);
+        ns.push_back(probe.seconds * 1e9 / ops);
+        samples.push_back(probe.sample);
+    }
+
+    CaseResult result{};
+    result.median_ns = median(ns);
+    result.min_ns = *std::min_element(ns.begin(), ns.end());
+    for (double v: ns) result.mean_ns += v / ns.size();
+    double var = 0;
+    for (double v: ns) var += (v - result.mean_ns) * (v - result.mean_ns);
+    result.rsd = ns.size() > 1 ? std::sqrt(var / (ns.size() - 1)) / result.mean_ns : 0;
+
+    for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+        std::vector<double> values;
+        for (const auto& sample: samples) {
+            if (sample.valid[e]) values.push_back(sample.values[e] / ops);
+        }
+        // only if every repetition counted the event
+        if (!values.empty() && values.size() == samples.size()) {
+            result.per_op.values[e] = median(values);
+            result.per_op.valid[e] = true;
+        }
+    }
+    return result;
+}
+
+
+static void print_header(const PerfCounters* counters) {
+    std::cout << "  " << std::left << std::setw(18) << "case" << std::right
+              << std::setw(11) << "median ns" << std::setw(11) << "mean ns" << std::setw(8) << "rsd %"
+              << std::setw(11) << "min ns";
+    if (counters) {
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (counters->has(static_cast<PerfEvent>(e))) std::cout << std::setw(11) << perf_event_name(static_cast<PerfEvent>(e));
+        }
+        if (counters->has(PerfEvent::Cycles) && counters->has(PerfEvent::Instructions)) std::cout << std::setw(7) << "IPC";
+    }
+    std::cout << std::endl;
+}
+
+
+static void print_case(const std::string& name, const CaseResult& result, const PerfCounters* counters) {
+    std::cout << "  " << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(11) << result.median_ns << std::setw(11) << result.mean_ns
+              << std::setprecision(1) << std::setw(8) << 100 * result.rsd
+              << std::setprecision(2) << std::setw(11) << result.min_ns;
+    if (counters) {
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (!counters->has(static_cast<PerfEvent>(e))) continue;
+            if (result.per_op.valid[e]) std::cout << std::setw(11) << std::setprecision(3) << result.per_op.values[e];
+            else std::cout << std::setw(11) << "-";
+        }
+        if (counters->has(PerfEvent::Cycles) && counters->has(PerfEvent::Instructions)) {
+            if (result.per_op.has(PerfEvent::Cycles) && result.per_op.has(PerfEvent::Instructions)
+                && result.per_op[PerfEvent::Cycles] > 0) {
+                std::cout << std::setw(7) << std::setprecision(2)
+                          << result.per_op[PerfEvent::Instructions] / result.per_op[PerfEvent::Cycles];
+            } else {
+                std::cout << std::setw(7) << "-";
+            }
+        }
+    }
+    std::cout << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout.precision(6);
+}
+
+
+// The window sizes k to sweep: DualSketch's QT window; the other sketches have none (0)
+template <typename Sketch>
+static std::vector<uint32_t> window_sizes(const BenchOptions& options) {
+    if constexpr (std::is_same_v<Sketch, DualSketch>) return options.windows;
+    return {0};
+}
+
+
+template <typename Sketch>
+static std::unique_ptr<Sketch> make_sketch(float memory_kb, uint32_t window) {
+    if constexpr (std::is_same_v<Sketch, DualSketch>) return std::make_unique<DualSketch>(memory_kb, window);
+    else return std::make_unique<Sketch>(memory_kb);
+}
+
+
+// All cases of one sketch at one memory size and window size
+template <typename Sketch>
+static void bench_setting(const BenchOptions& options, const std::vector<Record>& dataset, PerfCounters* counters,
+                          float memory_kb, uint32_t window) {
+    std::cout << "\n" << Sketch::name() << ", memo_kb = " << memory_kb;
+    if (window != 0) std::cout << ", k = " << window;
+    std::cout << ":" << std::endl;
+    if constexpr (std::is_same_v<Sketch, DualSketch>) {
+        DualSketch sized(memory_kb, window);
+        if (!sized.valid()) {
+            std::cout << "  (skipped: " << sized.heavy_buckets() << " HT buckets and "
+                      << sized.quad_cells() << " QT cells)" << std::endl;
+            return;
+        }
+    }
+    print_header(counters);
+
+    // per-record update()
+    CaseResult update = measure(options, counters, dataset.size(), [&](Probe& probe) {
+        std::unique_ptr<Sketch> sketch = make_sketch<Sketch>(memory_kb, window);
+        probe.start();
+        for (const auto &[x, y]: dataset) sketch->update(x, y);
+        probe.stop();
+    });
+    print_case("update", update, counters);
+
+    // update_batch() with n records per call
+    for (size_t n: options.batch_sizes) {
+        CaseResult batch = measure(options, counters, dataset.size(), [&](Probe& probe) {
+            std::unique_ptr<Sketch> sketch = make_sketch<Sketch>(memory_kb, window);
+            probe.start();
+            for (size_t i = 0; i < dataset.size(); i += n) {
+                sketch->update_batch(dataset.data() + i, std::min(n, dataset.size() - i));
+            }
+            probe.stop();
+        });
+        print_case("batch n=" + std::to_string(n), batch, counters);
+    }
+
+    // query() of a sketch that has seen the whole dataset
+    std::unique_ptr<Sketch> filled = make_sketch<Sketch>(memory_kb, window);
+    for (size_t i = 0; i < dataset.size(); i += 1024) {
+        filled->update_batch(dataset.data() + i, std::min<size_t>(1024, dataset.size() - i));
+    }
+    for (float phi_1: options.phi_1) {
+        auto heavy_hitter_th = static_cast<uint32_t>(phi_1 * dataset.size());
+        size_t reported = 0;
+        CaseResult query = measure(options, counters, 1, [&](Probe& probe) {
+            probe.start();
+            QueryResult answer = filled->query(heavy_hitter_th, options.phi_2);
+            probe.stop();
+            reported = answer.first.size();
+        });
+        std::ostringstream name;
+        name << "query phi1=" << phi_1;
+        print_case(name.str(), query, counters);
+        if (reported == 0) std::cout << "    (no heavy hitters reported)" << std::endl;
+    }
+}
+
+
+template <typename Sketch>
+static void bench_sketch(const BenchOptions& options, const std::vector<Record>& dataset, PerfCounters* counters) {
+    if (!options.algorithms.empty()
+        && std::find(options.algorithms.begin(), options.algorithms.end(), Sketch::name()) == options.algorithms.end()) {
+        return;
+    }
+
+    for (float memory_kb: options.memory_kb) {
+        for (uint32_t window: window_sizes<Sketch>(options)) {
+            bench_setting<Sketch>(options, dataset, counters, memory_kb, window);
+        }
+    }
+}
+
+
+template <typename... Sketches>
+static void bench_all(const BenchOptions& options, const std::vector<Record>& dataset, PerfCounters* counters) {
+    (bench_sketch<Sketches>(options, dataset, counters), ...);
+}
+
+
+template <typename T, typename Convert>
+static bool parse_list(const std::string& text, std::vector<T>& values, Convert convert) {
+    values.clear();
+    std::stringstream list(text);
+    for (std::string item; std::getline(list, item, ',');) {
+        if (!item.empty()) values.push_back(convert(item));
+    }
+    return !values.empty();
+}
+
+
+int main(int argc, char **argv) {
+
+    BenchOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--no-counters") {
+                options.counters = false;
+            } else if (arg == "--records" && has_value) {
+                options.records = static_cast<uint64_t>(std::stod(argv[++i]));
+            } else if (arg == "--seed" && has_value) {
+                options.seed = std::stoull(argv[++i]);
+            } else if (arg == "--algorithms" && has_value) {
+                std::stringstream list(argv[++i]);
+                for (std::string name; std::getline(list, name, ',');) {
+                    const Algorithm* algorithm = find_algorithm(name);
+                    if (algorithm == nullptr) {
+                        std::cerr << "unknown algorithm: " << name << std::endl;
+                        return 1;
+                    }
+                    options.algorithms.push_back(algorithm->name);
+                }
+            } else if (arg == "--memory" && has_value) {
+                parse_list(argv[++i], options.memory_kb, [](const std::string& s) { return std::stof(s); });
+            } else if (arg == "--window" && has_value) {
+                parse_list(argv[++i], options.windows, [](const std::string& s) {
+                    return static_cast<uint32_t>(std::max(1ul, std::stoul(s)));
+                });
+            } else if (arg == "--batch" && has_value) {
+                parse_list(argv[++i], options.batch_sizes, [](const std::string& s) {
+                    return static_cast<size_t>(std::max(1ull, std::stoull(s)));
+                });
+            } else if (arg == "--phi1" && has_value) {
+                parse_list(argv[++i], options.phi_1, [](const std::string& s) { return std::stof(s); });
+            } else if (arg == "--phi2" && has_value) {
+                options.phi_2 = std::stof(argv[++i]);
+            } else if (arg == "--repeat" && has_value) {
+                options.repeat = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i])));
+            } else if (arg == "--warmup" && has_value) {
+                options.warmup = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--flow-shift" && has_value) {
+                options.flow_shift = static_cast<uint32_t>(std::min(31ul, std::stoul(argv[++i])));
+            } else if (arg == "--isa" && has_value) {
+                Isa isa;
+                if (!parse_isa(argv[++i], isa) || !set_sketch_isa(isa)) {
+                    std::cerr << "unknown or unsupported ISA level: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--format" && has_value) {
+                if (!parse_trace_format(argv[++i], options.format)) {
+                    std::cerr << "unknown format: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                usage();
+                return 1;
+            } else {
+                options.files.push_back(arg);
+            }
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 1;
+    }
+
+    std::vector<Record> dataset;
+    if (options.files.empty()) {
+        ZipfConfig zipf;
+        zipf.records = options.records;
+        zipf.seed = options.seed;
+        dataset = ZipfGenerator(zipf).generate();
+        std::cout << "dataset: " << dataset.size() << " Zipf records (flow alpha " << zipf.flow_alpha
+                  << ", element alpha " << zipf.element_alpha << ", seed " << zipf.seed << ")" << std::endl;
+    } else {
+        dataset = std::get<0>(loadDataSet(options.files, options.format));
+    }
+    if (dataset.empty()) {
+        std::cerr << "No records loaded." << std::endl;
+        return 1;
+    }
+    if (options.flow_shift > 0) {
+        for (Record& record: dataset) record.first = (record.first << options.flow_shift) | 1;
+        std::cout << "flow keys: (x << " << options.flow_shift << ") | 1" << std::endl;
+    }
+
+    std::unique_ptr<PerfCounters> counters;
+    if (options.counters) {
+        counters.reset(new PerfCounters());
+        if (!counters->status().empty()) {
+            std::cout << "perf counters: " << counters->status()
+                      << (counters->has_hardware() ? "; some events are missing" : "; reporting time and software events only")
+                      << std::endl;
+        }
+    }
+    print_sketch_dispatch(std::cout);
+    std::cout << "warmup = " << options.warmup << ", repeat = " << options.repeat
+              << ", counters and times are per operation (record or query)" << std::endl;
+
+    bench_all<DualSketch, DUET, GlobalHH, TwoDMisraGries, CSSCHH>(options, dataset, counters.get());
+    return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/bash
+# What the portable binary costs, per level of the sketch kernels (header/SketchKernels.h).
+# Builds HH_Regress portable (the default) and with -march for each level the CPU supports,
+# runs the suite on each level of both builds, and compares them with HH_Regress --compare:
+#
+#   baseline  portable --isa baseline  vs  -DHH_MARCH=x86-64     --isa baseline
+#   avx2      portable --isa avx2      vs  -DHH_MARCH=x86-64-v3  --isa avx2
+#   avx512    portable --isa avx512    vs  -DHH_MARCH=x86-64-v4  --isa avx512
+#   native    portable, widest level   vs  -DHH_MARCH=native
+#
+# usage: tools/compare_builds.sh [OUT_DIR] [HH_Regress options, e.g. --repeat 10 --records 1e6]
+#
+# The builds, logs (<level>.portable.json, <level>.march.json) and comparisons (<level>.txt)
+# go to OUT_DIR (default: build-compare). The exit status is 2 if the portable build regressed
+# on any level, as for HH_Regress --compare.
+
+set -e -o pipefail
+src=$(cd "$(dirname "$0")/.." && pwd)
+out=build-compare
+if [ $# -gt 0 ] && [ "${1#-}" = "$1" ]; then out=$1; shift; fi
+mkdir -p "$out"
+
+build() {  # build DIR MARCH
+    cmake -S "$src" -B "$out/$1" -DHH_MARCH="$2" > "$out/$1.cmake.log"
+    cmake --build "$out/$1" --target HH_Regress -j"$(nproc)" > "$out/$1.build.log"
+}
+
+echo "building portable"
+build portable ""
+portable=$out/portable/HH_Regress
+
+status=0
+for tier in baseline:x86-64 avx2:x86-64-v3 avx512:x86-64-v4 native:native; do
+    level=${tier%%:*}
+    march=${tier#*:}
+    isa=()
+    if [ "$level" != native ]; then
+        isa=(--isa "$level")
+        if ! "$portable" "${isa[@]}" --records 1000 --repeat 1 > /dev/null 2>&1; then
+            echo "$level: not supported here, skipped"
+            continue
+        fi
+    fi
+
+    echo "building -march=$march"
+    build "march-$march" "$march"
+    "$portable" "${isa[@]}" "$@" --json "$out/$level.portable.json" > /dev/null
+    "$out/march-$march/HH_Regress" "${isa[@]}" "$@" --json "$out/$level.march.json" > /dev/null
+
+    echo "== $level: -march=$march (baseline) vs portable (current)"
+    result=0
+    "$portable" --compare "$out/$level.march.json" "$out/$level.portable.json" | tee "$out/$level.txt" || result=$?
+    if [ "$result" = 1 ]; then exit 1; fi
+    if [ "$result" = 2 ]; then status=2; fi
+done
+exit $status
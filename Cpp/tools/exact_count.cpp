@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "header/ExactCounter.h"
+#include "header/Loaders.h"
+
+
+// Standalone exact counting of a dataset, optionally cross-checked against std::map.
+//
+// usage: HH_ExactCount <caida|mawi|fimi|synthetic|pcap> [--threads N] [--top N] [--verify] [--no-cache] [--io mmap|uring|pread] [--key SPEC] [file ...]
+
+static void usage() {
+    std::cerr << "usage: HH_ExactCount <caida|mawi|fimi|synthetic|pcap> [--threads N] [--top N] [--verify] [--no-cache] [--io mmap|uring|pread] [--key SPEC] [file ...]"
+              << std::endl;
+}
+
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    std::string format = argv[1];
+    unsigned num_threads = 0;
+    size_t top = 10;
+    bool verify = false;
+    KeySpec key_spec;
+    bool use_key_spec = false;
+    std::vector<std::string> files;
+
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (std::strcmp(argv[i], "--key") == 0 && i + 1 < argc) {
+            std::string error;
+            if (!parse_key_spec(argv[++i], key_spec, &error)) {
+                std::cerr << "Invalid key spec: " << error << std::endl;
+                return 1;
+            }
+            use_key_spec = true;
+        } else if (std::strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            IoBackend backend;
+            if (!parse_io_backend(argv[++i], backend)) {
+                usage();
+                return 1;
+            }
+            set_io_backend(backend);
+        } else if (std::strcmp(argv[i], "--no-cache") == 0) {
+            set_trace_cache_enabled(false);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (use_key_spec && format != "mawi" && format != "pcap") {
+        std::cerr << "--key applies to mawi and pcap input only, not " << format << std::endl;
+        return 1;
+    }
+
+    std::tuple<std::vector<Record>, ExactCounts> loaded;
+    if (format == "caida") {
+        loaded = files.empty() ? loadDataSetCAIDA() : loadDataSetCAIDA(files);
+    } else if (format == "mawi" && use_key_spec) {
+        loaded = loadDataSetMAWI(files.empty() ? std::vector<std::string>{"./dataset/MAWI2024/parsed_mawi_2024.csv"} : files,
+                                 key_spec);
+    } else if (format == "mawi") {
+        loaded = files.empty() ? loadDataSetMAWI() : loadDataSetMAWI(files);
+    } else if (format == "fimi") {
+        loaded = files.empty() ? loadDatasetFreqItemMining() : loadDatasetFreqItemMining(files);
+    } else if (format == "pcap" && use_key_spec) {
+        loaded = loadDataSetPcap(files, key_spec);
+    } else if (format == "pcap") {
+        loaded = loadDataSetPcap(files);
+    } else if (format == "synthetic") {
+        loaded = files.empty() ? loadSyntheticDataset() : loadSyntheticDataset(files);
+    } else {
+        usage();
+        return 1;
+    }
+    const auto &records = std::get<0>(loaded);
+
+    // count again on the requested number of threads, so the timing is not mixed with parsing
+    auto start = std::chrono::steady_clock::now();
+    ExactCounts counts = count_exact(records, num_threads);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Records: " << counts.total
+              << ", Unique flows: " << counts.flows.size()
+              << ", Unique (flow, element) pairs: " << counts.elements.size()
+              << ", Counting time: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << std::endl;
+
+    std::vector<FlowCount> largest(counts.flows);
+    top = std::min(top, largest.size());
+    std::partial_sort(largest.begin(), largest.begin() + top, largest.end(),
+                      [](const FlowCount &a, const FlowCount &b) { return a.count > b.count; });
+    for (size_t i = 0; i < top; ++i) {
+        std::cout << "  flow " << largest[i].flow << ": " << largest[i].count << std::endl;
+    }
+
+    if (verify) {
+        std::string diff = verify_exact(records, counts);
+        if (!diff.empty()) {
+            std::cout << "Verification FAILED: " << diff << std::endl;
+            return 2;
+        }
+        std::cout << "Verification passed." << std::endl;
+    }
+
+    return 0;
+}
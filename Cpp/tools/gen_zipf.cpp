@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "header/CSSCHH.h"
+#include "header/DUET.h"
+#include "header/DualSketch.h"
+#include "header/GlobalHH.h"
+#include "header/SketchDriver.h"
+#include "header/TraceFile.h"
+#include "header/TwoDMisraGries.h"
+#include "header/ZipfGenerator.h"
+
+
+// Generates a synthetic Zipf (flow, element) stream, the native replacement of
+// dataset/genSyntheticDataset.py, and either writes it as a binary trace or streams it
+// straight into the sketches. The stream only depends on the parameters and the seed,
+// not on the number of threads.
+//
+// usage: HH_GenZipf [--records N] [--flow-alpha A] [--element-alpha A] [--flows N] [--elements N]
+//                   [--tail clip|truncate] [--seed S] [--threads T]
+//                   (--output trace.bin | --stream [--memory KB] [--phi1 P] [--phi2 P])
+//
+// The defaults are those of genSyntheticDataset.py (127001730 records, alpha 1.1 / 1.4,
+// ranks clipped to 149197297 flows and 87963297 elements).
+
+static void usage() {
+    std::cerr << "usage: HH_GenZipf [--records N] [--flow-alpha A] [--element-alpha A] [--flows N] [--elements N]\n"
+              << "                  [--tail clip|truncate] [--seed S] [--threads T]\n"
+              << "                  (--output trace.bin | --stream [--memory KB] [--phi1 P] [--phi2 P])" << std::endl;
+}
+
+
+template <typename... Sketches>
+static std::vector<RunResult> stream_zipf(float memory_kb, const ZipfGenerator& generator, unsigned num_threads,
+                                          float phi_1, const RunConfig& config) {
+    std::vector<RunResult> results;
+    (results.push_back([&]() {
+        ZipfStream stream(generator, num_threads);
+        return stream_source<Sketches>(memory_kb, stream, phi_1, config);
+    }()), ...);
+    return results;
+}
+
+
+int main(int argc, char **argv) {
+
+    ZipfConfig config;
+    unsigned num_threads = 0;
+    std::string output;
+    bool stream = false;
+    float memory_kb = 400;
+    float phi_1 = 0.0001;
+    float phi_2 = 0.1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--stream") {
+            stream = true;
+        } else if (!has_value) {
+            usage();
+            return 1;
+        } else if (arg == "--records") {
+            config.records = static_cast<uint64_t>(std::stod(argv[++i]));
+        } else if (arg == "--flow-alpha") {
+            config.flow_alpha = std::stod(argv[++i]);
+        } else if (arg == "--element-alpha") {
+            config.element_alpha = std::stod(argv[++i]);
+        } else if (arg == "--flows") {
+            config.max_flow = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--elements") {
+            config.max_element = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--tail") {
+            std::string tail = argv[++i];
+            if (tail != "clip" && tail != "truncate") {
+                usage();
+                return 1;
+            }
+            config.tail = tail == "clip" ? ZipfTail::Clip : ZipfTail::Truncate;
+        } else if (arg == "--seed") {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--threads") {
+            num_threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--output") {
+            output = argv[++i];
+        } else if (arg == "--memory") {
+            memory_kb = std::stof(argv[++i]);
+        } else if (arg == "--phi1") {
+            phi_1 = std::stof(argv[++i]);
+        } else if (arg == "--phi2") {
+            phi_2 = std::stof(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (output.empty() == !stream) {
+        usage();
+        return 1;
+    }
+
+    ZipfGenerator generator(config);
+    std::string error = generator.validate();
+    if (!error.empty()) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::cout << "Zipf stream: " << config.records << " records, flow alpha " << config.flow_alpha
+              << " (max " << config.max_flow << "), element alpha " << config.element_alpha
+              << " (max " << config.max_element << "), "
+              << (config.tail == ZipfTail::Clip ? "clipped" : "truncated") << " tail, seed " << config.seed
+              << std::endl;
+
+    if (stream) {
+        std::cout << "phi_1 = " << phi_1 << ", Quad element th (phi_2) = " << phi_2
+                  << ", memo_kb = " << memory_kb << std::endl;
+        RunConfig run_config{0, phi_2, 1024};
+        auto runs = stream_zipf<DualSketch, DUET, GlobalHH, TwoDMisraGries, CSSCHH>(
+                memory_kb, generator, num_threads, phi_1, run_config);
+        for (const auto &run: runs) {
+            report_stream_run(run);
+        }
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TraceWriter writer;
+    if (!writer.open(output, config.records)) {
+        std::cerr << "Failed to write trace: " << output << std::endl;
+        return 1;
+    }
+    ZipfStream blocks(generator, num_threads);
+    std::vector<Record> chunk;
+    while (blocks.next(chunk)) {
+        if (!writer.append(chunk.data(), chunk.size())) break;
+    }
+    if (!writer.close()) {
+        std::cerr << "Failed to write trace: " << output << std::endl;
+        return 1;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Wrote " << output << " in " << std::chrono::duration<double>(end - start).count() << " s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "header/DualSketch.h"
+#include "header/LiveCapture.h"
+
+
+// Feeds DualSketch from a live interface through a TPACKET_V3 ring.
+// With --threads N > 1 the traffic is split across N sockets (PACKET_FANOUT, hash mode),
+// each feeding its own sketch; their answers are summed at the end.
+//
+// usage: HH_LiveCapture <interface> [--threads N] [--seconds S] [--memory KB] [--key SPEC]
+//                       [--phi1 R] [--phi2 P] [--block-size BYTES] [--blocks N]
+
+static std::atomic<bool> stop_requested{false};
+
+static void on_signal(int) {
+    stop_requested = true;
+}
+
+static void usage() {
+    std::cerr << "usage: HH_LiveCapture <interface> [--threads N] [--seconds S] [--memory KB] [--key SPEC]\n"
+              << "                      [--phi1 R] [--phi2 P] [--block-size BYTES] [--blocks N]" << std::endl;
+}
+
+
+struct CaptureThread {
+    LiveCapture capture;
+    DualSketch sketch;
+    uint64_t records = 0;
+    uint64_t block_ns_total = 0;       // decode + sketch update, per block
+    uint64_t block_ns_max = 0;
+    std::vector<uint64_t> block_ns_log2 = std::vector<uint64_t>(64, 0);
+
+    explicit CaptureThread(float memory_kb) : sketch(memory_kb) {}
+
+    void run(const KeySpec &spec) {
+        std::vector<Record> batch;
+        while (!stop_requested) {
+            uint64_t decode_before = capture.stats().block_ns_total;
+            int packets = capture.next_block(spec, batch, 100);
+            if (packets < 0) {
+                std::cerr << "capture failed: " << std::strerror(errno) << std::endl;
+                stop_requested = true;
+                break;
+            }
+            if (packets == 0) continue;
+
+            auto start = std::chrono::steady_clock::now();
+            sketch.update_batch(batch.data(), batch.size());
+            auto update_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+
+            uint64_t block_ns = capture.stats().block_ns_total - decode_before + update_ns;
+            block_ns_total += block_ns;
+            block_ns_max = std::max(block_ns_max, block_ns);
+            block_ns_log2[63 - __builtin_clzll(block_ns | 1)]++;
+            records += batch.size();
+            batch.clear();
+        }
+    }
+};
+
+
+// Upper bound of the log2 bucket holding the q-quantile
+static uint64_t quantile_ns(const std::vector<uint64_t> &log2_counts, double q) {
+    uint64_t total = 0;
+    for (uint64_t c: log2_counts) total += c;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < log2_counts.size(); ++b) {
+        seen += log2_counts[b];
+        if (total > 0 && seen >= q * total) return (2ULL << b) - 1;
+    }
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    LiveCaptureConfig config;
+    config.interface = argv[1];
+    unsigned num_threads = 1;
+    double seconds = 10;
+    float memory_kb = 400;
+    float phi_1 = 0.0001f, phi_2 = 0.1f;
+    KeySpec spec = default_key_spec();
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) num_threads = std::max(1ul, std::stoul(argv[++i]));
+        else if (arg == "--seconds" && has_value) seconds = std::stod(argv[++i]);
+        else if (arg == "--memory" && has_value) memory_kb = std::stof(argv[++i]);
+        else if (arg == "--phi1" && has_value) phi_1 = std::stof(argv[++i]);
+        else if (arg == "--phi2" && has_value) phi_2 = std::stof(argv[++i]);
+        else if (arg == "--block-size" && has_value) config.block_size = std::stoul(argv[++i]);
+        else if (arg == "--blocks" && has_value) config.block_count = std::stoul(argv[++i]);
+        else if (arg == "--key" && has_value) {
+            std::string error;
+            if (!parse_key_spec(argv[++i], spec, &error)) {
+                std::cerr << "Invalid key spec: " << error << std::endl;
+                return 1;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (num_threads > 1) config.fanout_group = getpid() & 0xffff;
+
+    std::vector<std::unique_ptr<CaptureThread>> workers;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        workers.push_back(std::make_unique<CaptureThread>(memory_kb));
+        std::string error;
+        if (!workers.back()->capture.open(config, &error)) {
+            std::cerr << config.interface << ": " << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cout << "Capturing on " << config.interface << " with " << num_threads << " thread(s) for "
+              << seconds << " s (Ctrl-C to stop early)" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (auto &w: workers) {
+        threads.emplace_back([&w, &spec]() { w->run(spec); });
+    }
+
+    // once a second: packets and kernel drops so far
+    for (int tick = 1; !stop_requested; ++tick) {
+        auto deadline = start + std::chrono::milliseconds(static_cast<int64_t>(std::min<double>(tick, seconds) * 1000));
+        while (!stop_requested && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        uint64_t packets = 0, drops = 0;
+        for (auto &w: workers) {
+            w->capture.update_kernel_stats();
+            packets += w->capture.stats().packets;
+            drops += w->capture.stats().kernel_drops;
+        }
+        std::cout << "  " << std::min<double>(tick, seconds) << " s: " << packets << " packets, "
+                  << drops << " dropped" << std::endl;
+        if (tick >= seconds) stop_requested = true;
+    }
+    for (auto &t: threads) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // sum the per-thread estimates, then apply the thresholds to the sums
+    uint64_t total = 0;
+    HeavyHitterMap flows;
+    QuadElementMap elements;
+    for (auto &w: workers) {
+        const auto &s = w->capture.stats();
+        std::cout << "Thread: " << s.packets << " packets (" << s.decoded << " IP), " << w->records << " updates, "
+                  << s.blocks << " blocks, " << s.kernel_drops << " dropped, " << s.freeze_count << " ring full"
+                  << std::endl;
+        if (s.blocks > 0) {
+            std::cout << " - Block processing: mean " << w->block_ns_total / s.blocks / 1e3 << " us, p99 <= "
+                      << std::min(quantile_ns(w->block_ns_log2, 0.99), w->block_ns_max) / 1e3 << " us, max " << w->block_ns_max / 1e3 << " us"
+                      << std::endl;
+        }
+        total += w->records;
+        auto [hh, quad] = w->sketch.query(1, 0.0f);
+        for (const auto &[flow, size]: hh) flows[flow] += size;
+        for (const auto &[flow, eles]: quad) {
+            for (const auto &[ele, size]: eles) elements[flow][ele] += size;
+        }
+    }
+
+    auto heavy_hitter_th = static_cast<uint32_t>(phi_1 * total);
+    size_t num_hh = 0, num_quad = 0;
+    for (const auto &[flow, size]: flows) {
+        if (size < heavy_hitter_th || size == 0) continue;
+        num_hh++;
+        for (const auto &[ele, ele_size]: elements[flow]) {
+            if (ele_size >= phi_2 * size) num_quad++;
+        }
+    }
+
+    std::cout << "Total: " << total << " updates in " << elapsed << " s ("
+              << total / elapsed / 1e6 << " M updates/s); heavy hitters (>= " << heavy_hitter_th << "): " << num_hh
+              << ", hot quadratic elements: " << num_quad << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "header/Loaders.h"
+
+
+// Compares the ways of reading text traces: mmap (the loaders' default), io_uring,
+// pread, and the original std::ifstream + std::getline. Every backend parses the same
+// files into records; throughput and a checksum of the records are printed per run.
+//
+// usage: HH_ReadBench <caida|mawi|fimi|synthetic> [--backends mmap,uring,pread,ifstream]
+//                     [--repeat N] [--cold] file ...
+//
+// --cold evicts the files from the page cache (POSIX_FADV_DONTNEED) before every run.
+
+static void usage() {
+    std::cerr << "usage: HH_ReadBench <caida|mawi|fimi|synthetic> [--backends mmap,uring,pread,ifstream]\n"
+              << "                    [--repeat N] [--cold] file ..." << std::endl;
+}
+
+
+// The loaders before they moved to mmap: one std::string per line
+static bool parse_ifstream(const std::vector<std::string> &file_paths, TraceFormat format,
+                           std::vector<Record> &records, uint64_t &skipped_lines) {
+    LineParser parse_line = line_parser(format);
+    for (const auto &file_path: file_paths) {
+        std::ifstream file(file_path);
+        if (!file.is_open()) return false;
+
+        std::string line;
+        uint64_t offset = 0;
+        if (has_header_line(format) && std::getline(file, line)) offset += line.size() + 1;
+        while (std::getline(file, line)) {
+            if (!parse_line(line.data(), line.data() + line.size(), offset, records)) skipped_lines++;
+            offset += line.size() + 1;
+        }
+    }
+    return true;
+}
+
+
+static void evict(const std::vector<std::string> &file_paths) {
+    for (const auto &file_path: file_paths) {
+        int fd = open(file_path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+
+int main(int argc, char **argv) {
+
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    TraceFormat format;
+    if (!parse_trace_format(argv[1], format) || format == TraceFormat::Pcap || format == TraceFormat::Binary) {
+        usage();
+        return 1;
+    }
+
+    std::vector<std::string> backends = {"mmap", "uring", "pread", "ifstream"};
+    int repeat = 3;
+    bool cold = false;
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--backends") == 0 && i + 1 < argc) {
+            backends.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string name; std::getline(list, name, ',');) backends.push_back(name);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--cold") == 0) {
+            cold = true;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    uint64_t total_bytes = 0;
+    for (const auto &file_path: files) {
+        std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+        if (file.is_open()) total_bytes += static_cast<uint64_t>(file.tellg());
+    }
+
+    for (const auto &backend_name: backends) {
+        IoBackend backend = IoBackend::Mmap;
+        if (backend_name != "ifstream" && !parse_io_backend(backend_name, backend)) {
+            std::cerr << "unknown backend: " << backend_name << std::endl;
+            return 1;
+        }
+
+        for (int run = 0; run < repeat; ++run) {
+            if (cold) evict(files);
+
+            std::vector<Record> records;
+            uint64_t skipped_lines = 0;
+            auto start = std::chrono::steady_clock::now();
+            bool ok = backend_name == "ifstream"
+                      ? parse_ifstream(files, format, records, skipped_lines)
+                      : parse_trace_files(files, format, backend, records, skipped_lines);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            uint64_t checksum = 0;
+            for (const auto &[x, y]: records) checksum = checksum * 1000003 + ((uint64_t(x) << 32) | y);
+
+            std::cout << backend_name << (ok ? "" : " (read failed)")
+                      << ": " << seconds * 1e3 << " ms, " << total_bytes / seconds / 1e6 << " MB/s, "
+                      << records.size() / seconds / 1e6 << " M records/s, records " << records.size()
+                      << ", skipped " << skipped_lines << ", checksum " << std::hex << checksum << std::dec
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "header/Algorithms.h"
+#include "header/ResultLog.h"
+#include "header/SketchKernels.h"
+#include "header/Workloads.h"
+#include "header/ZipfGenerator.h"
+
+
+// Throughput regression check of the update paths. Runs every algorithm on a fixed set of
+// generated workloads (a Zipf stream and the adversarial inputs of header/Workloads.h, all
+// seeded), writes the throughput samples as a result log, and compares them with a stored
+// baseline log: a configuration regressed if Welch's t-test finds its mean throughput
+// different at level --alpha and it is slower by more than --min-change.
+//
+// usage: HH_Regress [--baseline FILE] [--json FILE] [--csv FILE] [--algorithms LIST] [--memory KB]
+//                   [--records N] [--batch N] [--repeat N] [--alpha A] [--min-change F] [--isa LEVEL]
+//        HH_Regress --compare BASELINE.json CURRENT.json [--alpha A] [--min-change F]
+//
+// --compare takes any two result logs, e.g. of HH_QuadraticEle --json. The exit status is
+// 2 if a configuration regressed, 1 on errors.
+//
+// --isa runs the suite on one level of the sketch kernels (header/SketchKernels.h); comparing
+// such a log with one of a -DHH_MARCH=native build shows what the portable binary costs.
+// tools/compare_builds.sh does so for every level.
+
+static void usage() {
+    std::cerr << "usage: HH_Regress [--baseline FILE] [--json FILE] [--csv FILE] [--algorithms LIST] [--memory KB]\n"
+              << "                  [--records N] [--batch N] [--repeat N] [--alpha A] [--min-change F] [--isa LEVEL]\n"
+              << "       HH_Regress --compare BASELINE.json CURRENT.json [--alpha A] [--min-change F]" << std::endl;
+}
+
+
+struct RegressConfig {
+    std::vector<const Algorithm*> algorithms;  // default: DualSketch, DUET, 2D-MG
+    float memory_kb = 400;
+    uint64_t records = 1 << 20;
+    size_t batch_size = 1024;
+    unsigned repeat = 10;
+    uint64_t seed = 1;
+    double alpha = 0.01;
+    double min_change = 0.02;
+};
+
+
+// The suite. Repeats are interleaved across algorithms so that slow drift of the machine
+// (frequency, other load) spreads over all of them instead of biasing one.
+static ResultLog run_suite(const RegressConfig& config) {
+    ResultLog log;
+    RunConfig run_config{static_cast<uint32_t>(0.0001 * config.records), 0.1f, config.batch_size, 0};
+
+    std::vector<std::pair<std::string, std::vector<Record>>> workloads;
+    ZipfConfig zipf;
+    zipf.records = config.records;
+    zipf.seed = config.seed;
+    workloads.emplace_back("zipf", ZipfGenerator(zipf).generate());
+
+    WorkloadConfig adversarial;
+    adversarial.records = config.records;
+    adversarial.memory_kb = config.memory_kb;
+    adversarial.seed = config.seed;
+    for (Workload workload: all_workloads()) {
+        workloads.emplace_back(workload_name(workload), make_workload(workload, adversarial));
+    }
+
+    for (const auto& [name, records]: workloads) {
+        std::cout << name << ": " << std::flush;
+        std::vector<std::vector<RunResult>> runs(config.algorithms.size());
+        for (const Algorithm* algorithm: config.algorithms) algorithm->run(config.memory_kb, records, run_config);  // warm-up
+        for (unsigned r = 0; r < config.repeat; ++r) {
+            for (size_t a = 0; a < config.algorithms.size(); ++a) {
+                runs[a].push_back(config.algorithms[a]->run(config.memory_kb, records, run_config));
+            }
+        }
+        for (const auto& algorithm_runs: runs) {
+            ResultRow row = result_row(algorithm_runs);
+            row.mode = name;
+            row.dataset = "generated: " + std::to_string(config.records) + " records, seed " + std::to_string(config.seed);
+            row.phi_1 = 0.0001f;
+            row.phi_2 = 0.1f;
+            row.batch_size = config.batch_size;
+            std::ostringstream median;
+            median << std::fixed << std::setprecision(2) << summarize(row.throughput_mdps).median;
+            std::cout << row.algorithm << " " << median.str() << " Mdps  " << std::flush;
+            log.add(std::move(row));
+        }
+        std::cout << std::endl;
+    }
+    return log;
+}
+
+
+static void warn_if_different(const char* what, const std::string& baseline, const std::string& current) {
+    if (baseline != current) {
+        std::cout << "note: " << what << " differs: baseline \"" << baseline << "\", current \"" << current << "\"\n";
+    }
+}
+
+
+// Prints one line per configuration present in both logs; returns the number that regressed.
+static int compare_logs(const ResultLog& baseline, const ResultLog& current, double alpha, double min_change) {
+    const RunEnvironment& b = baseline.environment;
+    const RunEnvironment& c = current.environment;
+    warn_if_different("host", b.host, c.host);
+    warn_if_different("CPU", b.cpu_model, c.cpu_model);
+    warn_if_different("compiler", b.compiler, c.compiler);
+    warn_if_different("build flags", b.build_flags, c.build_flags);
+    warn_if_different("sketch kernels", b.sketch_isa, c.sketch_isa);
+    if (b.dualsketch_stats != c.dualsketch_stats) std::cout << "note: one side was built with DUALSKETCH_STATS\n";
+
+    std::map<std::string, const ResultRow*> baseline_rows;
+    for (const ResultRow& row: baseline.rows()) baseline_rows[row.key()] = &row;
+
+    std::cout << "\n" << std::left << std::setw(18) << "workload" << std::setw(12) << "algorithm" << std::right
+              << std::setw(8) << "KB" << std::setw(8) << "phi_1" << std::setw(7) << "batch"
+              << std::setw(20) << "baseline Mdps" << std::setw(20) << "current Mdps"
+              << std::setw(9) << "change" << std::setw(10) << "p" << "  verdict" << std::endl;
+
+    int regressions = 0;
+    size_t unmatched = 0;
+    for (const ResultRow& row: current.rows()) {
+        auto it = baseline_rows.find(row.key());
+        if (it == baseline_rows.end()) {
+            unmatched++;
+            continue;
+        }
+        const ResultRow& base = *it->second;
+        SampleSummary before = summarize(base.throughput_mdps);
+        SampleSummary after = summarize(row.throughput_mdps);
+        WelchTest test = welch_t_test(base.throughput_mdps, row.throughput_mdps);
+        double change = before.mean > 0 ? after.mean / before.mean - 1 : 0;
+
+        bool significant = test.p_value < alpha;
+        const char* verdict = "";
+        if (before.count < 2 || after.count < 2) {
+            verdict = "n/a (needs --repeat >= 2)";
+        } else if (significant && change < -min_change) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (significant && change > min_change) {
+            verdict = "faster";
+        }
+
+        auto mean_ci = [](const SampleSummary& s) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(2) << s.mean << " +- " << (s.ci95_high - s.mean);
+            return text.str();
+        };
+        std::ostringstream change_text, p_text;
+        change_text << std::fixed << std::setprecision(1) << 100 * change << "%";
+        p_text << std::scientific << std::setprecision(1) << test.p_value;
+        std::cout << std::left << std::setw(18) << row.mode << std::setw(12) << row.algorithm << std::right
+                  << std::setw(8) << row.memory_kb << std::setw(8) << row.phi_1 << std::setw(7) << row.batch_size
+                  << std::setw(20) << mean_ci(before) << std::setw(20) << mean_ci(after)
+                  << std::setw(9) << change_text.str() << std::setw(10) << p_text.str() << "  " << verdict << std::endl;
+    }
+
+    if (unmatched > 0) std::cout << "\n" << unmatched << " configuration(s) have no baseline" << std::endl;
+    std::cout << "\n" << regressions << " significant regression(s) at alpha = " << alpha
+              << ", min change = " << 100 * min_change << "%" << std::endl;
+    return regressions;
+}
+
+
+int main(int argc, char** argv) {
+
+    RegressConfig config;
+    std::string baseline_path, json_path, csv_path;
+    std::vector<std::string> compare_paths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (arg == "--compare") {
+            if (i + 2 >= argc) {
+                usage();
+                return 1;
+            }
+            compare_paths = {argv[i + 1], argv[i + 2]};
+            i += 2;
+        } else if (arg == "--baseline") {
+            baseline_path = argv[++i];
+        } else if (arg == "--json") {
+            json_path = argv[++i];
+        } else if (arg == "--csv") {
+            csv_path = argv[++i];
+        } else if (arg == "--algorithms") {
+            std::stringstream list(argv[++i]);
+            for (std::string name; std::getline(list, name, ',');) {
+                const Algorithm* algorithm = find_algorithm(name);
+                if (algorithm == nullptr) {
+                    std::cerr << "unknown algorithm: " << name << std::endl;
+                    return 1;
+                }
+                config.algorithms.push_back(algorithm);
+            }
+        } else if (arg == "--memory") {
+            config.memory_kb = std::stof(argv[++i]);
+        } else if (arg == "--records") {
+            config.records = static_cast<uint64_t>(std::stod(argv[++i]));
+        } else if (arg == "--batch") {
+            config.batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--repeat") {
+            config.repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--alpha") {
+            config.alpha = std::stod(argv[++i]);
+        } else if (arg == "--min-change") {
+            config.min_change = std::stod(argv[++i]);
+        } else if (arg == "--isa") {
+            Isa isa;
+            if (!parse_isa(argv[++i], isa) || !set_sketch_isa(isa)) {
+                std::cerr << "unknown or unsupported ISA level: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    ResultLog baseline, current;
+    std::string error;
+
+    if (!compare_paths.empty()) {
+        if (!read_result_log(compare_paths[0], baseline, error) || !read_result_log(compare_paths[1], current, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        return compare_logs(baseline, current, config.alpha, config.min_change) > 0 ? 2 : 0;
+    }
+
+    // GlobalHH and CSSCHH update at ~0.05 Mdps on the adversarial workloads, so they are opt-in
+    if (config.algorithms.empty()) {
+        for (const char* name: {"DualSketch", "DUET", "2D-MG"}) config.algorithms.push_back(find_algorithm(name));
+    }
+    if (!baseline_path.empty() && !read_result_log(baseline_path, baseline, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    print_sketch_dispatch(std::cout);
+    std::cout << "records = " << config.records << ", memo_kb = " << config.memory_kb << ", batch = "
+              << config.batch_size << ", repeat = " << config.repeat << std::endl;
+    current = run_suite(config);
+    current.environment = current_environment(argc, argv);
+
+    int status = 0;
+    if (!json_path.empty() && !current.write_json(json_path)) status = 1;
+    if (!csv_path.empty() && !current.write_csv(csv_path)) status = 1;
+    if (!baseline_path.empty() && compare_logs(baseline, current, config.alpha, config.min_change) > 0) status = 2;
+    return status;
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "header/Loaders.h"
+#include "header/PcapReader.h"
+#include "header/TraceFile.h"
+
+
+// Converts a text trace into the binary trace format, or prints the header of a binary trace.
+//
+// usage: HH_TraceConvert <caida|mawi|fimi|synthetic|pcap> <source> [output]
+//        HH_TraceConvert info <trace.bin>
+//
+// The default output is "<source>.bin", the cache the loaders pick up automatically.
+// Captures are converted with their packet timestamps and IP lengths as extra columns.
+
+static void usage() {
+    std::cerr << "usage: HH_TraceConvert <caida|mawi|fimi|synthetic|pcap> <source> [output]\n"
+              << "       HH_TraceConvert info <trace.bin>" << std::endl;
+}
+
+
+static const char *source_format_name(uint16_t id) {
+    for (TraceFormat format: {TraceFormat::CAIDA, TraceFormat::MAWI, TraceFormat::FIMI,
+                              TraceFormat::Synthetic, TraceFormat::Pcap}) {
+        if (trace_format_id(format) == id) return trace_format_name(format);
+    }
+    return "none";
+}
+
+
+static int print_info(const std::string &path) {
+    TraceHeader header{};
+    if (!read_trace_header(path, header)) {
+        std::cerr << "Not a valid trace: " << path << std::endl;
+        return 1;
+    }
+    std::cout << path << ":\n"
+              << "  records: " << header.record_count << "\n"
+              << "  key widths: " << int(header.key_width_x) << " + " << int(header.key_width_y) << " bytes\n"
+              << "  timestamps: " << ((header.columns & TRACE_COL_TIMESTAMP) ? "yes" : "no") << "\n"
+              << "  weights: " << ((header.columns & TRACE_COL_WEIGHT) ? "yes" : "no") << "\n"
+              << "  source size: " << header.source_size << " bytes\n"
+              << "  source format: " << source_format_name(header.source_format)
+              << " (parser version " << header.parser_version << ")\n"
+              << "  source checksum: " << std::hex << header.source_checksum << std::dec << std::endl;
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    std::string source = argv[2];
+    if (mode == "info") return print_info(source);
+
+    TraceFormat format;
+    if (!parse_trace_format(mode, format) || format == TraceFormat::Binary) {
+        usage();
+        return 1;
+    }
+    std::string output = argc > 3 ? argv[3] : trace_cache_path(source);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Record> records;
+    TraceExtras extras;
+    uint64_t skipped_lines = 0;
+    if (format == TraceFormat::Pcap) {
+        PcapReader capture;
+        std::string error;
+        if (!capture.open(source, &error)) {
+            std::cerr << source << ": " << error << std::endl;
+            return 1;
+        }
+        const KeySpec spec = default_key_spec();
+        while (capture.read_batch(spec, records, SIZE_MAX, &extras) > 0) {}
+        skipped_lines = capture.stats().non_ip;
+    } else if (!parse_trace_file(source, format, records, skipped_lines)) {
+        std::cerr << "Failed to open file: " << source << std::endl;
+        return 1;
+    }
+
+    TraceHeader header{};
+    header.source_format = trace_format_id(format);
+    header.parser_version = trace_parser_version(format);
+    if (!describe_source(source, header, true)) {
+        std::cerr << "Failed to read file: " << source << std::endl;
+        return 1;
+    }
+    if (!write_trace(output, records, &header, &extras)) {
+        std::cerr << "Failed to write trace: " << output << std::endl;
+        return 1;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Converted " << records.size() << " records (" << skipped_lines << " skipped) to "
+              << output << " in " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    return 0;
+}
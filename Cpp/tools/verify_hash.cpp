@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "header/MurmurHash3.h"
+#include "header/SketchKernels.h"
+
+
+// Exhaustive check of MurmurHash3_x86_32_keys against the scalar MurmurHash3_x86_32: every
+// 32-bit key, for each seed and each kernel level this CPU runs. It also checks every batch
+// length up to 64 at several offsets, for the tails, and that nothing past the batch is
+// written. Prints the throughput of the scalar hash and of each level.
+// The exit status is 1 on a mismatch.
+//
+// usage: HH_VerifyHash [--seeds LIST] [--isa LEVEL]
+//
+// The default seeds are 0 (CountMin row 0) and DualSketch's 171273612.
+
+static void usage() {
+    std::cerr << "usage: HH_VerifyHash [--seeds LIST] [--isa baseline|avx2|avx512]" << std::endl;
+}
+
+
+// Every length in [0, 64] at offsets 0..15, with random keys; false on the first difference
+static bool check_tails(const std::vector<Isa>& levels, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<uint32_t> keys(80), expected(80), out(80);
+    for (Isa isa: levels) {
+        set_sketch_isa(isa);
+        for (size_t offset = 0; offset < 16; ++offset) {
+            for (size_t n = 0; n <= 64; ++n) {
+                for (uint32_t& key: keys) key = gen();
+                for (size_t i = 0; i < n; ++i) MurmurHash3_x86_32(&keys[offset + i], 4, seed, &expected[i]);
+                std::fill(out.begin(), out.end(), 0xDEADBEEF);
+                MurmurHash3_x86_32_keys(keys.data() + offset, n, seed, out.data() + offset);
+                bool past_untouched = out[offset + n] == 0xDEADBEEF && (offset == 0 || out[offset - 1] == 0xDEADBEEF);
+                if (!past_untouched || std::memcmp(out.data() + offset, expected.data(), 4 * n) != 0) {
+                    std::cout << isa_name(isa) << ": mismatch for " << n << " keys at offset " << offset
+                              << ", seed " << seed << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+
+    std::vector<uint32_t> seeds = {0, 171273612};
+    std::vector<Isa> levels;
+    for (Isa isa: {Isa::Baseline, Isa::Avx2, Isa::Avx512}) {
+        if (isa_supported(isa)) levels.push_back(isa);
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if (arg == "--seeds") {
+            seeds.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string seed; std::getline(list, seed, ',');) seeds.push_back(static_cast<uint32_t>(std::stoul(seed)));
+        } else if (arg == "--isa") {
+            Isa isa;
+            if (!parse_isa(argv[++i], isa) || !isa_supported(isa)) {
+                std::cerr << "unknown or unsupported ISA level: " << argv[i] << std::endl;
+                return 1;
+            }
+            levels = {isa};
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::cout << "levels:";
+    for (Isa isa: levels) std::cout << " " << isa_name(isa);
+    std::cout << " (detected " << isa_name(detected_isa()) << ")" << std::endl;
+
+    constexpr size_t block = 1 << 16;
+    std::vector<uint32_t> keys(block), expected(block), out(block);
+    using clock = std::chrono::steady_clock;
+
+    for (uint32_t seed: seeds) {
+        if (!check_tails(levels, seed)) return 1;
+
+        clock::duration scalar_time{};
+        std::vector<clock::duration> level_time(levels.size());
+        for (uint64_t base = 0; base < (1ull << 32); base += block) {
+            for (size_t i = 0; i < block; ++i) keys[i] = static_cast<uint32_t>(base + i);
+
+            auto start = clock::now();
+            for (size_t i = 0; i < block; ++i) MurmurHash3_x86_32(&keys[i], 4, seed, &expected[i]);
+            scalar_time += clock::now() - start;
+
+            for (size_t l = 0; l < levels.size(); ++l) {
+                set_sketch_isa(levels[l]);
+                start = clock::now();
+                MurmurHash3_x86_32_keys(keys.data(), block, seed, out.data());
+                level_time[l] += clock::now() - start;
+                if (out != expected) {
+                    for (size_t i = 0; i < block; ++i) {
+                        if (out[i] != expected[i]) {
+                            std::cout << isa_name(levels[l]) << ": key " << keys[i] << ", seed " << seed << ": 0x"
+                                      << std::hex << out[i] << " instead of 0x" << expected[i] << std::dec << std::endl;
+                            break;
+                        }
+                    }
+                    return 1;
+                }
+            }
+        }
+
+        auto rate = [](clock::duration time) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(2) << (1ull << 32) / std::chrono::duration<double>(time).count() / 1e9;
+            return text.str();
+        };
+        std::cout << "seed " << seed << ": all 2^32 keys match; Gkeys/s scalar " << rate(scalar_time);
+        for (size_t l = 0; l < levels.size(); ++l) std::cout << ", " << isa_name(levels[l]) << " " << rate(level_time[l]);
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "header/CSSCHH.h"
+#include "header/DUET.h"
+#include "header/DualSketch.h"
+#include "header/GlobalHH.h"
+#include "header/ResultLog.h"
+#include "header/SketchDriver.h"
+#include "header/SketchKernels.h"
+#include "header/TwoDMisraGries.h"
+#include "header/Workloads.h"
+
+
+// Runs every algorithm on the adversarial workloads of header/Workloads.h and reports
+// batched throughput and the per-update latency distribution.
+//
+// usage: HH_Workloads [--records N] [--memory KB] [--seed S] [--flows N] [--json FILE] [--csv FILE]
+//                     [--workloads distinct,bucket-collision,window-collision,single-flow,churn]
+//
+// Throughput comes from a run_sketch() pass with update_batch(). Latency comes from a
+// second pass over a fresh sketch that times every update() with the time-stamp counter
+// (header/LatencyRecorder.h); DualSketch updates are also broken down by how they ended.
+
+static void usage() {
+    std::cerr << "usage: HH_Workloads [--records N] [--memory KB] [--seed S] [--flows N] [--json FILE] [--csv FILE]\n"
+              << "                    [--workloads distinct,bucket-collision,window-collision,single-flow,churn]"
+              << std::endl;
+}
+
+
+static void print_row(const std::string& name, double mdps, const LatencyStats& latency) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2);
+    if (mdps > 0) std::cout << std::setw(10) << mdps;
+    else std::cout << std::setw(10) << "";
+    std::cout << std::setprecision(0)
+              << std::setw(10) << latency.p50_ns
+              << std::setw(10) << latency.p99_ns
+              << std::setw(10) << latency.p999_ns
+              << std::setw(12) << latency.max_ns
+              << std::setw(12) << latency.samples << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+
+template <typename Sketch>
+static void run_workload(float memory_kb, const std::vector<Record>& records, const std::string& workload,
+                         const WorkloadConfig& workload_config, ResultLog& log) {
+    RunConfig config{static_cast<uint32_t>(0.0001 * records.size()), 0.1f, 1024, 1};
+    RunResult run = run_sketch<Sketch>(memory_kb, records, config);
+
+    print_row(run.name, run.update_throughput_Mdps, run.update_latency);
+    for (const auto& [name, latency]: run.update_latency_by_case) {
+        print_row(std::string("  ") + name, 0, latency);
+    }
+
+    ResultRow row = result_row({run});
+    row.mode = workload;
+    row.dataset = "generated: " + std::to_string(workload_config.records) + " records, seed "
+                  + std::to_string(workload_config.seed);
+    row.phi_1 = 0.0001f;
+    row.phi_2 = config.phi;
+    row.batch_size = config.batch_size;
+    log.add(std::move(row));
+}
+
+
+template <typename... Sketches>
+static void run_all_workload(float memory_kb, const std::vector<Record>& records, const std::string& workload,
+                             const WorkloadConfig& workload_config, ResultLog& log) {
+    (run_workload<Sketches>(memory_kb, records, workload, workload_config, log), ...);
+}
+
+
+int main(int argc, char **argv) {
+
+    WorkloadConfig config;
+    std::vector<Workload> workloads = all_workloads();
+    std::string json_path, csv_path;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string arg = argv[i];
+        if (arg == "--records") {
+            config.records = static_cast<uint64_t>(std::stod(argv[++i]));
+        } else if (arg == "--memory") {
+            config.memory_kb = std::stof(argv[++i]);
+        } else if (arg == "--seed") {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--flows") {
+            config.colliding_flows = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--json") {
+            json_path = argv[++i];
+        } else if (arg == "--csv") {
+            csv_path = argv[++i];
+        } else if (arg == "--workloads") {
+            workloads.clear();
+            std::stringstream list(argv[++i]);
+            for (std::string name; std::getline(list, name, ',');) {
+                Workload workload;
+                if (!parse_workload(name, workload)) {
+                    std::cerr << "unknown workload: " << name << std::endl;
+                    return 1;
+                }
+                workloads.push_back(workload);
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    ResultLog log;
+    log.environment = current_environment(argc, argv);
+
+    print_sketch_dispatch(std::cout);
+    std::cout << "records = " << config.records << ", memo_kb = " << config.memory_kb
+              << ", timer overhead = " << latency_tick_overhead() / latency_ticks_per_ns()
+              << " ns (subtracted)" << std::endl;
+
+    for (Workload workload: workloads) {
+        std::vector<Record> records = make_workload(workload, config);
+
+        std::cout << "\n" << workload_name(workload) << ":\n"
+                  << "  " << std::left << std::setw(24) << "algorithm" << std::right
+                  << std::setw(10) << "Mdps" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+                  << std::setw(10) << "p99.9 ns" << std::setw(12) << "max ns" << std::setw(12) << "updates"
+                  << std::endl;
+        run_all_workload<DualSketch, DUET, GlobalHH, TwoDMisraGries, CSSCHH>(config.memory_kb, records,
+                                                                             workload_name(workload), config, log);
+    }
+
+    if (!json_path.empty() && !log.write_json(json_path)) return 1;
+    if (!csv_path.empty() && !log.write_csv(csv_path)) return 1;
+    return 0;
+}